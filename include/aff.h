@@ -4,12 +4,28 @@
  * Monitors sync timing delta to detect frequency drift and applies
  * small corrections to keep the receiver locked to the carrier.
  * 
- * Algorithm:
+ * Algorithm (AFF_MODE_STEP, default):
  * - Collects delta_ms samples from SYNC telemetry
  * - Computes rolling average drift in Hz
  * - After settling interval, if |drift| >= threshold:
  *   - Applies ±1 Hz adjustment (never more)
  *   - Resets interval timer
+ *
+ * Algorithm (AFF_MODE_KALMAN):
+ * - Two-state Kalman filter of frequency offset (Hz) and drift rate (Hz/s)
+ * - Fuses SYNC delta_ms and CARR offset, each weighted by a noise model
+ *   scaled from its SNR
+ * - After settling interval, applies a proportional correction of the
+ *   estimated offset, bounded by AFF_KF_MAX_SLEW_HZ
+ *
+ * Algorithm (AFF_MODE_FAST):
+ * - Keeps a short window of per-second CARR offsets
+ * - Rejects outliers against the window median/MAD, averages the rest
+ * - Corrects within seconds when CARR is significant; falls back to SYNC
+ *   delta_ms (±1 Hz per interval) when it is not valid
+ * - After each correction, drops the CARR window and CARR offsets for
+ *   AFF_FAST_SETTLE_MS (they measured the old tuning); the SYNC window is
+ *   kept, shifted by the correction
  */
 
 #ifndef AFF_H
@@ -17,6 +33,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "aff_model.h"
 
 /*============================================================================
  * Constants
@@ -35,12 +52,74 @@
 #define AFF_MAX_ADJUST_HZ   1       /* Maximum adjustment per cycle (Hz) */
 #define AFF_SAMPLE_COUNT    10      /* Rolling window size */
 
+/* Kalman estimator parameters */
+#define AFF_KF_GAIN             0.8f    /* Fraction of estimated offset corrected */
+#define AFF_KF_MAX_SLEW_HZ      20      /* Maximum adjustment per cycle (Hz) */
+#define AFF_KF_MIN_UPDATES      3       /* Measurements needed before correcting */
+#define AFF_KF_REF_SNR_DB       10.0f   /* SNR at which the base sigmas apply */
+#define AFF_KF_SYNC_SIGMA_MS    1.0f    /* SYNC delta_ms noise */
+#define AFF_KF_CARR_SIGMA_HZ    0.5f    /* CARR offset noise */
+#define AFF_KF_Q_OFFSET         0.005f  /* Offset random walk (Hz^2/s) */
+#define AFF_KF_Q_DRIFT          1e-7f   /* Drift random walk ((Hz/s)^2/s) */
+#define AFF_KF_INIT_DRIFT_SD    0.01f   /* Initial drift uncertainty (Hz/s) */
+#define AFF_KF_GATE_SIGMA       5.0f    /* Innovation gate */
+#define AFF_KF_MAX_REJECTS      5       /* Consecutive rejects before re-init */
+#define AFF_KF_SETTLE_MS        2000    /* Ignore CARR after a correction */
+
+/* Fast (per-second) path parameters */
+#define AFF_FAST_WINDOW         16      /* Samples kept per source */
+#define AFF_FAST_MIN_SAMPLES    5       /* Fresh samples needed for an estimate */
+#define AFF_FAST_MAX_AGE_MS     10000   /* CARR samples older than this are stale */
+#define AFF_FAST_SYNC_AGE_MS    600000  /* SYNC fallback window (10 minutes) */
+#define AFF_FAST_SYNC_MIN       3       /* SYNC samples needed for fallback */
+#define AFF_FAST_MAD_GATE       3.5f    /* Outlier gate in robust sigmas */
+#define AFF_FAST_SIGNIFICANCE   3.0f    /* Correction must gain N x the std error */
+#define AFF_FAST_MIN_GAIN_HZ    0.25f   /* ... and at least this much (dead band) */
+#define AFF_FAST_EVAL_MS        1000    /* Estimate cadence */
+#define AFF_FAST_SETTLE_MS      3000    /* Ignore CARR after a fast correction */
+#define AFF_FAST_HOLDOFF_MS     5000    /* Minimum time between fast corrections */
+#define AFF_FAST_MAX_ADJUST_HZ  5       /* Maximum fast adjustment (Hz) */
+
+/* Drift history */
+#define AFF_HISTORY_SIZE        1440    /* Entries kept (24 h at one per period) */
+#define AFF_HISTORY_PERIOD_MS   60000   /* History sample period */
+#define AFF_HISTORY_CSV_FILENAME "phoenix_sdr_aff_history.csv"
+
 /*============================================================================
  * Types
  *============================================================================*/
 
 typedef struct aff_state aff_state_t;
 
+/* One history sample (one per AFF_HISTORY_PERIOD_MS while enabled) */
+typedef struct {
+    uint32_t time_ms;           /* AFF clock at sample */
+    int64_t unix_time;          /* Wall clock (seconds) for export */
+    float drift_hz;             /* Measured drift / estimated offset */
+    int correction_hz;          /* Corrections applied since previous sample */
+    int total_correction_hz;    /* Corrections applied since create */
+    bool locked;                /* SYNC locked */
+    uint8_t mode;               /* aff_mode_t */
+} aff_history_entry_t;
+
+/* Millisecond clock source (see aff_set_clock) */
+typedef uint32_t (*aff_clock_fn)(void* userdata);
+
+/* Estimator mode */
+typedef enum {
+    AFF_MODE_STEP = 0,      /* Rolling mean of SYNC delta, ±1 Hz steps */
+    AFF_MODE_KALMAN,        /* Kalman fusion, proportional corrections */
+    AFF_MODE_FAST,          /* Robust per-second CARR tracking */
+    AFF_MODE_COUNT
+} aff_mode_t;
+
+/* Offset measurement source (for aff_update_offset) */
+typedef enum {
+    AFF_SOURCE_SYNC = 0,    /* value = SYNC delta_ms over 60 s (whole offset) */
+    AFF_SOURCE_CARRIER,     /* value = CARR offset_hz (left after corrections) */
+    AFF_SOURCE_COUNT
+} aff_source_t;
+
 /*============================================================================
  * API Functions
  *============================================================================*/
@@ -56,6 +135,23 @@ aff_state_t* aff_create(void);
  */
 void aff_destroy(aff_state_t* aff);
 
+/**
+ * Replace the monotonic clock AFF uses for intervals and sample ages
+ * (e.g. simulated time in tools/aff_sim.c); NULL restores the system clock
+ */
+void aff_set_clock(aff_state_t* aff, aff_clock_fn clock, void* userdata);
+
+/**
+ * Attach a learned oscillator model (NULL to detach; not owned)
+ * 
+ * AFF then learns the settled offset of the selected receiver, and after
+ * every reset (and on attach) pre-applies the model's predicted offset
+ * as one adjustment, minus any correction the receiver is known to carry.
+ * The adjustment is limited to the mode's normal maximum step, and skipped
+ * when the samples scatter about the fit by more than AFF_MODEL_MAX_FIT_HZ.
+ */
+void aff_set_model(aff_state_t* aff, aff_model_t* model);
+
 /**
  * Enable/disable AFF
  */
@@ -86,10 +182,29 @@ int aff_interval_seconds(int interval_index);
  */
 const char* aff_interval_string(int interval_index);
 
+/**
+ * Set estimator mode (AFF_MODE_xxx); resets estimator state
+ */
+void aff_set_mode(aff_state_t* aff, aff_mode_t mode);
+
+/**
+ * Get current estimator mode
+ */
+aff_mode_t aff_get_mode(aff_state_t* aff);
+
+/**
+ * Get mode as display string
+ */
+const char* aff_mode_string(aff_mode_t mode);
+
 /**
  * Update AFF with new sync data
  * Call this when SYNC telemetry arrives
  * 
+ * In AFF_MODE_KALMAN and AFF_MODE_FAST delta_ms is not used here (feed
+ * it once per SYNC packet through aff_update_offset); this call still
+ * tracks the carrier frequency and runs the adjustment checks.
+ * 
  * @param aff           AFF state
  * @param delta_ms      Timing delta from SYNC packet
  * @param carrier_hz    Current carrier frequency
@@ -97,24 +212,61 @@ const char* aff_interval_string(int interval_index);
  */
 void aff_update(aff_state_t* aff, float delta_ms, int64_t carrier_hz, bool is_locked);
 
+/**
+ * Feed one offset measurement to the Kalman or fast estimator
+ * Call once per new telemetry packet (ignored in AFF_MODE_STEP)
+ * 
+ * CARR is measured after the LO, so it shows only the offset the current
+ * tuning leaves. SYNC timing runs on the sample clock, which a retune does
+ * not move: it shows the whole oscillator offset, and the corrections
+ * already in the tuning are subtracted. Tone offsets are not used; a retune
+ * does not move them either, and scaled from 500/600 Hz to the carrier
+ * their noise is thousands of times CARR's.
+ * 
+ * @param aff           AFF state
+ * @param source        Measurement source
+ * @param value         delta_ms for SYNC, offset_hz otherwise
+ * @param snr_db        SNR of the source (weights the measurement)
+ */
+void aff_update_offset(aff_state_t* aff, aff_source_t source, float value, float snr_db);
+
 /**
  * Check if an adjustment is ready
  * Call periodically (e.g., in main loop)
  * 
  * @param aff           AFF state
- * @param adjustment_hz Output: Hz to add to frequency (+1, -1, or 0)
+ * @param adjustment_hz Output: Hz to add to frequency (±1 in STEP mode,
+ *                      up to ±AFF_KF_MAX_SLEW_HZ in KALMAN mode,
+ *                      up to ±AFF_FAST_MAX_ADJUST_HZ in FAST mode)
  * @return              true if adjustment should be applied
  */
 bool aff_get_adjustment(aff_state_t* aff, int* adjustment_hz);
 
 /**
  * Get current measured drift in Hz (for display)
- * This is the rolling average, updated continuously
+ * This is the rolling average (STEP) or estimated offset (KALMAN, FAST)
  */
 float aff_get_drift_hz(aff_state_t* aff);
 
+/**
+ * Copy drift history, oldest first
+ * 
+ * @param aff           AFF state
+ * @param out           Output entries
+ * @param max_entries   Capacity of out (newest entries kept if smaller)
+ * @return              Number of entries copied
+ */
+int aff_get_history(aff_state_t* aff, aff_history_entry_t* out, int max_entries);
+
+/**
+ * Write drift history as CSV (overwrites filename)
+ * @return true on success
+ */
+bool aff_export_history_csv(aff_state_t* aff, const char* filename);
+
 /**
  * Reset AFF state (call when user manually changes frequency)
+ * Drift history is kept.
  */
 void aff_reset(aff_state_t* aff);
 
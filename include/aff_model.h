@@ -0,0 +1,121 @@
+/*
+ * aff_model.h - Learned receiver oscillator model for AFF
+ *
+ * Keeps, per receiver, a decaying least-squares fit of the frequency
+ * offset AFF settles on (in ppm, so it carries across bands) against
+ * wall-clock time, i.e. offset plus aging. The fit is persisted to a
+ * small binary file (AFF_MODEL_FILENAME, next to the presets INI) so a
+ * restart can pre-apply the learned correction instead of re-learning it.
+ *
+ * The file also remembers the frequency AFF last left the receiver on and
+ * the correction included in it, so a server that kept our corrected
+ * tuning is not corrected twice.
+ *
+ * No temperature input exists in the telemetry; the model is time-only.
+ */
+
+#ifndef AFF_MODEL_H
+#define AFF_MODEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*============================================================================
+ * Constants
+ *============================================================================*/
+
+#define AFF_MODEL_MAX_RECEIVERS     8       /* Oldest receiver evicted when full */
+#define AFF_MODEL_KEY_MAX           64
+#define AFF_MODEL_MIN_SAMPLES       3       /* Samples before predicting */
+#define AFF_MODEL_SAMPLE_MS         600000  /* One learning sample per 10 minutes */
+#define AFF_MODEL_DECAY             0.999   /* Per-sample weight decay (~1 week) */
+#define AFF_MODEL_MIN_SPAN_DAYS     0.5     /* Time spread (sd) before fitting aging */
+#define AFF_MODEL_MAX_AGING_PPM     1.0     /* Clamp on aging (ppm/day) */
+#define AFF_MODEL_MAX_PPM           50.0    /* Reject samples/predictions beyond */
+#define AFF_MODEL_MAX_RESIDUAL_HZ   1.0f    /* Learn only when AFF has settled */
+#define AFF_MODEL_SETTLE_MS         10000   /* ... and not this soon after a correction */
+#define AFF_MODEL_MAX_FIT_HZ        2.0     /* Pre-apply only if the fit scatters less */
+
+/*============================================================================
+ * Types
+ *============================================================================*/
+
+typedef struct aff_model aff_model_t;
+
+/* Model summary for the selected receiver */
+typedef struct {
+    char key[AFF_MODEL_KEY_MAX];
+    uint32_t samples;
+    bool valid;                 /* Enough samples to predict */
+    double ppm;                 /* Predicted offset now (+ = tune higher) */
+    double aging_ppm_per_day;
+    double residual_ppm;        /* Scatter of the samples about the fit */
+} aff_model_info_t;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Create empty model store
+ * @return Allocated store or NULL on failure
+ */
+aff_model_t* aff_model_create(void);
+
+/**
+ * Destroy model store (does not save)
+ */
+void aff_model_destroy(aff_model_t* model);
+
+/**
+ * Load model store from file (missing file is not an error)
+ * @return true if a valid file was loaded
+ */
+bool aff_model_load(aff_model_t* model, const char* filename);
+
+/**
+ * Save model store to file (only if something was learned since load)
+ * @return true on success or nothing to save
+ */
+bool aff_model_save(aff_model_t* model, const char* filename);
+
+/**
+ * Select the receiver subsequent calls refer to (created if unknown)
+ * @param key           Receiver identity, e.g. "device#serial" or "host:port"
+ * @return              true if the selection changed
+ */
+bool aff_model_select(aff_model_t* model, const char* key);
+
+/**
+ * Add a learned offset sample for the selected receiver
+ *
+ * @param unix_time     Wall clock (seconds)
+ * @param ppm           Offset AFF settled on (+ = tune higher)
+ */
+void aff_model_add_sample(aff_model_t* model, int64_t unix_time, double ppm);
+
+/**
+ * Predict the selected receiver's offset
+ * @param residual_out  Scatter of the samples about the fit in ppm (optional)
+ * @return false if the model has too few samples
+ */
+bool aff_model_predict(aff_model_t* model, int64_t unix_time, double* ppm_out,
+                       double* residual_out);
+
+/**
+ * Remember the frequency AFF left the receiver on and the correction in it
+ */
+void aff_model_set_tuning(aff_model_t* model, int64_t tuned_hz, int correction_hz);
+
+/**
+ * Get the last remembered tuning
+ * @return false if none recorded for the selected receiver
+ */
+bool aff_model_get_tuning(aff_model_t* model, int64_t* tuned_hz, int* correction_hz);
+
+/**
+ * Get summary for the selected receiver
+ */
+void aff_model_get_info(aff_model_t* model, aff_model_info_t* info);
+
+#endif /* AFF_MODEL_H */
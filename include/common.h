@@ -75,6 +75,9 @@
 #define NUM_PRESETS 5
 #define PRESET_NAME_MAX 32
 #define PRESETS_FILENAME "phoenix_sdr_presets.ini"
+#define AFF_MODEL_FILENAME "phoenix_sdr_aff_model.bin"
+#define LATENCY_FILENAME "phoenix_sdr_latency.txt"
+#define CAPS_CACHE_FILENAME "phoenix_sdr_caps.txt"
 
 /* Sync state */
 typedef enum {
@@ -158,51 +161,31 @@ typedef enum {
 #define CLAMP(x, min, max) ((x) < (min) ? (min) : ((x) > (max) ? (max) : (x)))
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
 
-/* File-based logging for GUI app */
+/* Logging: queued to a background writer (log_writer.c), see log_writer.h */
 #include <stdio.h>
 #include <stdarg.h>
 #include <time.h>
+#include "log_writer.h"
+
+/* Offline tools that link app modules (tools/aff_sim.c) build with
+ * PHOENIX_NO_LOG to keep their reports free of module log lines */
+#ifdef PHOENIX_NO_LOG
+#define LOG_INFO(fmt, ...)  do { if (0) printf(fmt, ##__VA_ARGS__); } while(0)
+#define LOG_WARN(fmt, ...)  do { if (0) printf(fmt, ##__VA_ARGS__); } while(0)
+#define LOG_ERROR(fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); } while(0)
+#define LOG_DEBUG(fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); } while(0)
+#else
 
-static inline FILE* get_log_file(void) {
-    static FILE* logfile = NULL;
-    static int tried = 0;
-    if (!tried) {
-        tried = 1;
-        logfile = fopen("phoenix_sdr_debug.log", "a");
-        if (logfile) {
-            fprintf(logfile, "\n=== Session started ===\n");
-            fflush(logfile);
-        }
-    }
-    return logfile;
-}
-
-#define LOG_INFO(fmt, ...) do { \
-    FILE* lf = get_log_file(); \
-    if (lf) { fprintf(lf, "[INFO] " fmt "\n", ##__VA_ARGS__); fflush(lf); } \
-    printf("[INFO] " fmt "\n", ##__VA_ARGS__); \
-} while(0)
-
-#define LOG_WARN(fmt, ...) do { \
-    FILE* lf = get_log_file(); \
-    if (lf) { fprintf(lf, "[WARN] " fmt "\n", ##__VA_ARGS__); fflush(lf); } \
-    printf("[WARN] " fmt "\n", ##__VA_ARGS__); \
-} while(0)
-
-#define LOG_ERROR(fmt, ...) do { \
-    FILE* lf = get_log_file(); \
-    if (lf) { fprintf(lf, "[ERROR] " fmt "\n", ##__VA_ARGS__); fflush(lf); } \
-    fprintf(stderr, "[ERROR] " fmt "\n", ##__VA_ARGS__); \
-} while(0)
+#define LOG_INFO(fmt, ...)  log_write(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  log_write(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) log_write(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
 
 #ifdef _DEBUG
-    #define LOG_DEBUG(fmt, ...) do { \
-        FILE* lf = get_log_file(); \
-        if (lf) { fprintf(lf, "[DEBUG] " fmt "\n", ##__VA_ARGS__); fflush(lf); } \
-        printf("[DEBUG] " fmt "\n", ##__VA_ARGS__); \
-    } while(0)
+    #define LOG_DEBUG(fmt, ...) log_write(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
 #else
     #define LOG_DEBUG(fmt, ...)
 #endif
 
+#endif /* PHOENIX_NO_LOG */
+
 #endif /* COMMON_H */
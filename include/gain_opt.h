@@ -0,0 +1,142 @@
+/*
+ * gain_opt.h - Controller-side gain optimizer for Phoenix SDR Controller
+ *
+ * Walks IF gain reduction (and the LNA state at its end stops) toward the
+ * setting with the best CHAN SNR that does not overload the ADC:
+ *
+ *   - Overload: back off immediately, and for a while do not return to
+ *     the setting that overloaded.
+ *   - Otherwise hill-climb: measure SNR, try one step, keep it if SNR
+ *     improved (more gain) or did not get worse (less gain, for headroom),
+ *     else revert and wait before probing again.
+ *
+ * Settings go out coalesced: only the latest target is sent, and no more
+ * often than GAIN_OPT_CMD_INTERVAL_MS. Manual slider changes use the same
+ * path, so a drag does not send one command per frame.
+ *
+ * The caller owns the connection; this only decides what to send when.
+ */
+
+#ifndef GAIN_OPT_H
+#define GAIN_OPT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "udp_telemetry.h"
+
+/*============================================================================
+ * Constants
+ *============================================================================*/
+
+#define GAIN_OPT_STEP_DB            3       /* Hill-climb step */
+#define GAIN_OPT_OVERLOAD_STEP_DB   6       /* Back-off per overload step */
+#define GAIN_OPT_SETTLE_MS          1500    /* Ignore CHAN after a change */
+#define GAIN_OPT_SAMPLES            5       /* CHAN samples per measurement */
+#define GAIN_OPT_IMPROVE_DB         0.5f    /* SNR gain that justifies more gain */
+#define GAIN_OPT_HOLD_MS            60000   /* Wait after a rejected step */
+#define GAIN_OPT_NOISE_HOLD_MS      300000  /* Wait when externally noise limited */
+#define GAIN_OPT_OVERLOAD_STEP_MS   500     /* Min time between overload steps */
+#define GAIN_OPT_OVERLOAD_HOLD_MS   300000  /* Keep below an overload point */
+#define GAIN_OPT_CEILING_MAX_MS     3600000 /* ...doubling per recurring overload episode */
+#define GAIN_OPT_CMD_INTERVAL_MS    250     /* Coalescing window for commands */
+
+/*============================================================================
+ * Types
+ *============================================================================*/
+
+/**
+ * Optimizer state
+ */
+typedef struct {
+    bool enabled;
+    
+    /* Setting as last commanded, and limits for the current antenna */
+    int gain;
+    int lna;
+    int gain_min;
+    int gain_max;
+    int lna_max;
+    
+    /* Measurement window */
+    uint32_t settle_until_ms;
+    double snr_sum;
+    double noise_sum;
+    int samples;
+    uint32_t last_chan_update;
+    
+    /* Hill climb */
+    bool probing;               /* A trial step is being measured */
+    int direction;              /* -1 = more gain, +1 = less gain */
+    float base_snr_db;          /* SNR before the trial step */
+    float base_noise_db;
+    int prev_gain;              /* Setting to revert to */
+    int prev_lna;
+    uint32_t hold_until_ms;
+    
+    /* Overload ceiling */
+    bool overload;
+    uint32_t last_overload_step_ms;
+    int ceil_gain;              /* Setting that overloaded */
+    int ceil_lna;
+    uint32_t ceil_until_ms;
+    uint32_t ceil_hold_ms;      /* Current ceiling duration */
+    
+    /* Command coalescing */
+    bool pending;               /* gain/lna not sent yet */
+    uint32_t last_cmd_ms;
+    
+    uint32_t adjustments;       /* Settings sent by the optimizer */
+    uint32_t overload_steps;
+} gain_opt_t;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Initialize (disabled) with the radio's current setting
+ */
+void gain_opt_init(gain_opt_t *go, int gain, int lna);
+
+/**
+ * Enable or disable the optimizer (manual coalescing works either way)
+ */
+void gain_opt_enable(gain_opt_t *go, bool enable, uint32_t now_ms);
+
+/**
+ * Set gain reduction / LNA limits for the current antenna
+ */
+void gain_opt_set_limits(gain_opt_t *go, int gain_min, int gain_max, int lna_max);
+
+/**
+ * Operator moved gain or LNA: send it (coalesced) and climb from there
+ */
+void gain_opt_request(gain_opt_t *go, int gain, int lna, uint32_t now_ms);
+
+/**
+ * Radio setting changed outside the optimizer (AGC, reconnect, rejected
+ * command): adopt it without sending anything
+ */
+void gain_opt_sync(gain_opt_t *go, int gain, int lna, uint32_t now_ms);
+
+/**
+ * Feed a CHAN telemetry update
+ */
+void gain_opt_add_channel(gain_opt_t *go, const telem_channel_t *chan, uint32_t now_ms);
+
+/**
+ * Report the ADC overload state
+ */
+void gain_opt_set_overload(gain_opt_t *go, bool overload, uint32_t now_ms);
+
+/**
+ * Advance the optimizer
+ *
+ * @param running       Optimizing allowed now (streaming, hardware AGC off)
+ * @param gain_out      Gain reduction to send
+ * @param lna_out       LNA state to send
+ * @return true if a setting should be sent now
+ */
+bool gain_opt_update(gain_opt_t *go, uint32_t now_ms, bool running, int *gain_out, int *lna_out);
+
+#endif /* GAIN_OPT_H */
@@ -0,0 +1,49 @@
+/**
+ * Phoenix SDR Controller - Latency Histogram
+ * 
+ * Fixed-memory, log-bucketed histogram of durations in microseconds, in the
+ * style of HdrHistogram: each power of two is split into
+ * 2^LATENCY_HIST_SUB_BITS linear sub-buckets, so any recorded value is
+ * reported within ~12.5%. Recording is a single atomic increment and may
+ * happen on any thread; readers see a consistent-enough snapshot.
+ */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL.h>
+
+/* Bucket layout */
+#define LATENCY_HIST_SUB_BITS   3                           /* 8 sub-buckets per octave */
+#define LATENCY_HIST_MAX_BITS   27                          /* Up to 2^27 us (~134 s) */
+#define LATENCY_HIST_BUCKETS    ((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS)
+
+/* Histogram (zero-initialize or latency_hist_reset before use) */
+typedef struct {
+    SDL_atomic_t counts[LATENCY_HIST_BUCKETS];
+    SDL_atomic_t total;
+    SDL_atomic_t errors;        /* Failed/timed out, not in counts */
+    SDL_atomic_t max_us;
+} latency_hist_t;
+
+/* Clear all counts */
+void latency_hist_reset(latency_hist_t* hist);
+
+/* Record one duration */
+void latency_hist_record(latency_hist_t* hist, uint32_t us);
+
+/* Record one failure */
+void latency_hist_record_error(latency_hist_t* hist);
+
+/* Number of recorded durations */
+uint32_t latency_hist_count(const latency_hist_t* hist);
+
+/* Value at percentile (0-100), upper edge of its bucket; 0 if empty */
+uint32_t latency_hist_percentile(const latency_hist_t* hist, double percentile);
+
+/* Largest recorded value (exact) */
+uint32_t latency_hist_max(const latency_hist_t* hist);
+
+#endif /* LATENCY_HIST_H */
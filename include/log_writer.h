@@ -0,0 +1,54 @@
+/**
+ * Phoenix SDR Controller - Asynchronous Log Writer
+ *
+ * LOG_* calls format into a fixed ring of preallocated records and return;
+ * a background thread writes them to phoenix_sdr_debug.log and the console
+ * in batches, flushing once per batch. Any thread may log (multi-producer,
+ * lock-free). When the ring is full the message is dropped and counted
+ * rather than stalling the caller (errors are written through instead);
+ * the writer reports drops in the log.
+ *
+ * Before log_writer_start() and after log_writer_stop(), messages are
+ * written synchronously as before.
+ */
+
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LOG_FILENAME            "phoenix_sdr_debug.log"
+#define LOG_QUEUE_RECORDS       1024    /* Ring size (power of two) */
+#define LOG_RECORD_LEN          256     /* Longer messages are truncated */
+#define LOG_FLUSH_INTERVAL_MS   100     /* Writer batch period */
+
+typedef enum {
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR
+} log_level_t;
+
+/* Start the background writer */
+bool log_writer_start(void);
+
+/* Write out everything queued and stop the writer */
+void log_writer_stop(void);
+
+/* Keep compiler checking of LOG_* format strings */
+#if defined(__MINGW_PRINTF_FORMAT)
+    #define LOG_PRINTF_FORMAT(f, a) __attribute__((format(__MINGW_PRINTF_FORMAT, f, a)))
+#elif defined(__GNUC__) || defined(__clang__)
+    #define LOG_PRINTF_FORMAT(f, a) __attribute__((format(printf, f, a)))
+#else
+    #define LOG_PRINTF_FORMAT(f, a)
+#endif
+
+/* Queue one message (printf format, no trailing newline) */
+void log_write(log_level_t level, const char* fmt, ...) LOG_PRINTF_FORMAT(2, 3);
+
+/* Messages dropped because the queue was full */
+uint32_t log_writer_dropped(void);
+
+#endif /* LOG_WRITER_H */
@@ -0,0 +1,75 @@
+/*
+ * reconnect.h - Automatic reconnection policy for Phoenix SDR Controller
+ * 
+ * Schedules reconnect attempts after the server link drops, with
+ * exponential backoff and "equal jitter" (half the delay fixed, half
+ * random) so several controllers behind one relay do not retry in step.
+ * The caller owns the connection; this only decides when to try.
+ */
+
+#ifndef RECONNECT_H
+#define RECONNECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*============================================================================
+ * Constants
+ *============================================================================*/
+
+#define RECONNECT_BASE_MS       1000    /* First retry within 0.5-1 s */
+#define RECONNECT_MAX_MS        30000   /* Backoff ceiling */
+
+/*============================================================================
+ * Types
+ *============================================================================*/
+
+/**
+ * Reconnection state
+ */
+typedef struct {
+    bool active;                /* Link lost, retrying until success/cancel */
+    int attempts;               /* Attempts since the link was lost */
+    uint32_t next_attempt_ms;   /* Due time of next attempt */
+    uint32_t lost_ms;           /* When the link was lost */
+    uint32_t rng;               /* Jitter PRNG state */
+} reconnect_t;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Initialize (inactive)
+ */
+void reconnect_init(reconnect_t *rc, uint32_t seed);
+
+/**
+ * Link lost: start retrying
+ * @return Delay until first attempt (ms)
+ */
+uint32_t reconnect_arm(reconnect_t *rc, uint32_t now_ms);
+
+/**
+ * Check if an attempt is due (marks it as started)
+ */
+bool reconnect_due(reconnect_t *rc, uint32_t now_ms);
+
+/**
+ * Attempt failed: schedule the next one
+ * @return Delay until next attempt (ms)
+ */
+uint32_t reconnect_failed(reconnect_t *rc, uint32_t now_ms);
+
+/**
+ * Attempt succeeded: stop retrying
+ * @return Outage duration (ms)
+ */
+uint32_t reconnect_succeeded(reconnect_t *rc, uint32_t now_ms);
+
+/**
+ * Operator disconnect: stop retrying
+ */
+void reconnect_cancel(reconnect_t *rc);
+
+#endif /* RECONNECT_H */
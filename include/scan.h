@@ -0,0 +1,200 @@
+/*
+ * scan.h - WWV band scan for Phoenix SDR Controller
+ *
+ * Steps through a list of frequencies (default: the WWV bands), dwelling
+ * on each while CHAN telemetry is averaged. The retune for the next band
+ * is issued one command lead time before the dwell ends, so it lands on
+ * the dwell boundary instead of one round trip late.
+ *
+ * Each dwell is kept in a per-band history; bands are ranked by the
+ * age-weighted mean SNR of their recent dwells (propagation changes over
+ * hours, so older dwells count less). After the last band the scan ends
+ * on the best one.
+ *
+ * Auto-band mode keeps the receiver on a home band and every few minutes
+ * probes one alternate band for a short window. When an alternate beats
+ * the home band by a hysteresis margin on consecutive probes (and its
+ * subcarriers follow the WWV schedule, so it is really WWV), it becomes
+ * the new home band.
+ *
+ * The caller owns the radio: scan_poll() says when and where to tune.
+ */
+
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "udp_telemetry.h"
+
+/*============================================================================
+ * Constants
+ *============================================================================*/
+
+#define SCAN_MAX_FREQS          8
+#define SCAN_HISTORY_DWELLS     8       /* Dwells kept per band */
+#define SCAN_DWELL_DEFAULT_MS   15000
+#define SCAN_DWELL_MIN_MS       3000
+#define SCAN_SETTLE_MS          2000    /* Ignore telemetry after a retune */
+#define SCAN_MIN_SAMPLES        3       /* CHAN samples for a valid dwell */
+#define SCAN_HALF_LIFE_MS       1800000 /* Dwell weight halves every 30 min */
+
+#define SCAN_PROBE_INTERVAL_MS  300000  /* Auto: probe an alternate every 5 min */
+#define SCAN_PROBE_DWELL_MS     8000    /* Auto: time spent on the alternate */
+#define SCAN_HYSTERESIS_DB      3.0f    /* Auto: margin an alternate must win by */
+#define SCAN_SWITCH_CONFIRM     2       /* Auto: consecutive wins to switch */
+#define SCAN_MIN_MATCH_RATIO    0.5f    /* Auto: subcarrier schedule matches */
+#define SCAN_TRACK_TOLERANCE_HZ 5000    /* Larger retune = user moved the radio */
+
+/*============================================================================
+ * Types
+ *============================================================================*/
+
+typedef struct scan scan_t;
+
+/* What the caller should do after scan_poll() */
+typedef enum {
+    SCAN_IDLE = 0,              /* Nothing (not scanning, or mid-dwell) */
+    SCAN_TUNE,                  /* Tune to *freq_out now */
+    SCAN_DONE,                  /* Scan finished: tune to best band *freq_out */
+    SCAN_SWITCH                 /* Auto: home moved to *freq_out (already tuned) */
+} scan_action_t;
+
+/* One band's standing */
+typedef struct {
+    int64_t freq_hz;
+    float score_db;             /* Age-weighted mean SNR of valid dwells */
+    float last_snr_db;          /* Most recent valid dwell */
+    float last_noise_db;
+    float last_match_ratio;     /* Subcarrier match in last dwell, <0 if none */
+    int dwells;                 /* Valid dwells in history */
+    uint32_t last_ms;           /* Tick of most recent valid dwell */
+} scan_result_t;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Create scanner (WWV 2.5-25 MHz, default dwell)
+ * @return Allocated scanner or NULL on failure
+ */
+scan_t* scan_create(void);
+
+/**
+ * Destroy scanner
+ */
+void scan_destroy(scan_t* scan);
+
+/**
+ * Replace the frequency list (stops a scan in progress, clears history)
+ */
+void scan_set_frequencies(scan_t* scan, const int64_t* freqs_hz, int count);
+
+/**
+ * Set dwell time per band (clamped to SCAN_DWELL_MIN_MS)
+ */
+void scan_set_dwell(scan_t* scan, uint32_t dwell_ms);
+
+/**
+ * Load [Scan] options from INI file
+ * Keys: dwell_ms, auto_band, probe_interval_s, hysteresis_db
+ * @return true if the file was read
+ */
+bool scan_load_config(scan_t* scan, const char* filename);
+
+/**
+ * Save [Scan] options to INI file (other sections are kept)
+ */
+bool scan_save_config(const scan_t* scan, const char* filename);
+
+/**
+ * Check if the config asked for auto-band mode at startup
+ */
+bool scan_config_auto(const scan_t* scan);
+
+/**
+ * Start one pass over the list
+ */
+void scan_start(scan_t* scan);
+
+/**
+ * Stop scanning (history is kept)
+ */
+void scan_stop(scan_t* scan);
+
+/**
+ * Check if a scan is in progress
+ */
+bool scan_is_active(const scan_t* scan);
+
+/**
+ * Start auto-band mode (stops a sweep)
+ * @param home_hz       Frequency the radio is on now
+ */
+void scan_auto_start(scan_t* scan, int64_t home_hz, uint32_t now_ms);
+
+/**
+ * Stop auto-band mode
+ * @return Home frequency to return to (0 if none needed)
+ */
+int64_t scan_auto_stop(scan_t* scan);
+
+/**
+ * Check if auto-band mode is on
+ */
+bool scan_auto_is_enabled(const scan_t* scan);
+
+/**
+ * Check if auto-band mode is away on a probe
+ */
+bool scan_is_probing(const scan_t* scan);
+
+/**
+ * Report the radio's current frequency in auto-band mode
+ *
+ * Small moves (AFF corrections) are followed; a move larger than
+ * SCAN_TRACK_TOLERANCE_HZ means the user retuned, which becomes the
+ * new home band.
+ */
+void scan_auto_track(scan_t* scan, int64_t freq_hz, uint32_t now_ms);
+
+/**
+ * The retune scan_poll() asked for failed: a probe is abandoned (radio is
+ * still home), otherwise the current dwell collects nothing
+ */
+void scan_tune_failed(scan_t* scan, uint32_t now_ms);
+
+/**
+ * Feed a CHAN telemetry update (ignored while settling or idle)
+ */
+void scan_add_channel(scan_t* scan, const telem_channel_t* chan, uint32_t now_ms);
+
+/**
+ * Feed a SUBC telemetry update (schedule match counts toward the dwell)
+ */
+void scan_add_subcarrier(scan_t* scan, const telem_subcarrier_t* subc, uint32_t now_ms);
+
+/**
+ * Advance the schedule
+ *
+ * @param now_ms        Current tick
+ * @param lead_ms       Expected time for a SET_FREQ to take effect
+ * @param freq_out      Frequency to tune (SCAN_TUNE / SCAN_DONE / SCAN_SWITCH)
+ * @return              Action for the caller
+ */
+scan_action_t scan_poll(scan_t* scan, uint32_t now_ms, uint32_t lead_ms, int64_t* freq_out);
+
+/**
+ * Get current position in the pass
+ * @return false if not scanning
+ */
+bool scan_get_progress(const scan_t* scan, int* index, int* count, int64_t* freq_hz);
+
+/**
+ * Rank bands, best first (bands without valid dwells last)
+ * @return Number of results written
+ */
+int scan_get_ranking(const scan_t* scan, uint32_t now_ms, scan_result_t* out, int max_results);
+
+#endif /* SCAN_H */
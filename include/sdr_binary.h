@@ -0,0 +1,97 @@
+/*
+ * sdr_binary.h - Compact binary framing for the Phoenix SDR control channel
+ *
+ * Negotiated with "BINARY 1" after VER; frames then share the socket with
+ * text lines. Every frame starts with SDR_BIN_MAGIC, which no text line
+ * starts with, so either side tells them apart by the first byte. Only
+ * the high-rate commands (set/start/stop/status/ping) have binary forms;
+ * everything else, and all "!" notifications, stay text.
+ *
+ * Fixed layouts, little-endian, no padding:
+ *
+ *   Request   magic:u8 op:u8 seq:u16 arg:i64                    (12 bytes)
+ *   Response  magic:u8 op:u8 seq:u16 status:u8 len:u8 payload   (6 + len)
+ *
+ * status is 0 for OK or an error_code_t. The STATUS payload is
+ * following layout (SDR_BIN_STATUS_SIZE bytes):
+ *
+ *   freq:i64 srate:u32 bw:u16 gain:u8 lna:u8 agc:u8 antenna:u8 flags:u8 rsvd:u8
+ *   flags: bit0 streaming, bit1 overload, bit2 bias-T, bit3 notch
+ */
+
+#ifndef SDR_BINARY_H
+#define SDR_BINARY_H
+
+#include "sdr_protocol.h"
+
+/*============================================================================
+ * Constants
+ *============================================================================*/
+
+#define SDR_BIN_MAGIC           0xB5
+#define SDR_BIN_VERSION         1
+#define SDR_BIN_REQUEST_SIZE    12
+#define SDR_BIN_HEADER_SIZE     6
+#define SDR_BIN_MAX_PAYLOAD     255
+#define SDR_BIN_STATUS_SIZE     20
+
+#define SDR_BIN_FLAG_STREAMING  0x01
+#define SDR_BIN_FLAG_OVERLOAD   0x02
+#define SDR_BIN_FLAG_BIAS_T     0x04
+#define SDR_BIN_FLAG_NOTCH      0x08
+
+/*============================================================================
+ * Types
+ *============================================================================*/
+
+/* Opcodes (0 = no binary form) */
+typedef enum {
+    SDR_BIN_OP_NONE = 0,
+    SDR_BIN_OP_PING,
+    SDR_BIN_OP_STATUS,
+    SDR_BIN_OP_SET_FREQ,
+    SDR_BIN_OP_SET_GAIN,
+    SDR_BIN_OP_SET_LNA,
+    SDR_BIN_OP_SET_AGC,         /* arg: agc_mode_t */
+    SDR_BIN_OP_SET_SRATE,
+    SDR_BIN_OP_SET_BW,
+    SDR_BIN_OP_SET_ANTENNA,     /* arg: antenna_port_t */
+    SDR_BIN_OP_SET_BIAST,       /* arg: 0/1 (1 = confirmed enable) */
+    SDR_BIN_OP_SET_NOTCH,       /* arg: 0/1 */
+    SDR_BIN_OP_START,
+    SDR_BIN_OP_STOP
+} sdr_bin_op_t;
+
+/* Decoded response header */
+typedef struct {
+    uint8_t op;
+    uint16_t seq;
+    uint8_t status;             /* 0 = OK, else error_code_t */
+    uint8_t len;                /* Payload bytes that follow */
+} sdr_bin_header_t;
+
+/*============================================================================
+ * API Functions
+ *============================================================================*/
+
+/**
+ * Encode a request frame
+ * @param out           SDR_BIN_REQUEST_SIZE bytes
+ */
+void sdr_bin_encode_request(uint8_t* out, sdr_bin_op_t op, uint16_t seq, int64_t arg);
+
+/**
+ * Decode a response header
+ * @param in            SDR_BIN_HEADER_SIZE bytes
+ * @return false if the magic is wrong
+ */
+bool sdr_bin_decode_header(const uint8_t* in, sdr_bin_header_t* hdr);
+
+/**
+ * Decode a STATUS payload into status (fields it carries only)
+ * @return false if the payload is too short or holds an unknown AGC mode
+ *         or antenna (status is then unchanged)
+ */
+bool sdr_bin_decode_status(const uint8_t* in, size_t len, sdr_status_t* status);
+
+#endif /* SDR_BINARY_H */
@@ -9,8 +9,49 @@
 
 #include "common.h"
 #include "tcp_client.h"
-
-/* SDR Capabilities structure */
+#include "latency_hist.h"
+
+/* Protocol verbs with their own round-trip histogram */
+typedef enum {
+    SDR_VERB_PING = 0,
+    SDR_VERB_VER,
+    SDR_VERB_CAPS,
+    SDR_VERB_STATUS,
+    SDR_VERB_SET_FREQ,
+    SDR_VERB_GET_FREQ,
+    SDR_VERB_SET_GAIN,
+    SDR_VERB_GET_GAIN,
+    SDR_VERB_SET_LNA,
+    SDR_VERB_GET_LNA,
+    SDR_VERB_SET_AGC,
+    SDR_VERB_GET_AGC,
+    SDR_VERB_SET_SRATE,
+    SDR_VERB_GET_SRATE,
+    SDR_VERB_SET_BW,
+    SDR_VERB_GET_BW,
+    SDR_VERB_SET_ANTENNA,
+    SDR_VERB_GET_ANTENNA,
+    SDR_VERB_SET_BIAST,
+    SDR_VERB_SET_NOTCH,
+    SDR_VERB_START,
+    SDR_VERB_STOP,
+    SDR_VERB_QUIT,
+    SDR_VERB_SUBSCRIBE,
+    SDR_VERB_BINARY,
+    SDR_VERB_OTHER,
+    SDR_VERB_COUNT
+} sdr_verb_t;
+
+/* Status update policy */
+#define STATUS_POLL_MIN_MS          500     /* Adaptive polling, after any change */
+#define STATUS_POLL_MAX_MS          8000    /* ... doubling up to this while idle */
+#define STATUS_SUBSCRIBED_POLL_MS   30000   /* Reconcile poll when pushes are on */
+
+/* Capabilities */
+#define CAPS_MAX_LINES      64      /* CAPS response lines before END */
+#define CAPS_ANTENNA_PORTS  3       /* ANTENNA_A .. ANTENNA_HIZ */
+
+/* SDR Capabilities structure (sdr_caps_defaults = RSP2) */
 typedef struct {
     int64_t freq_min;
     int64_t freq_max;
@@ -19,12 +60,19 @@ typedef struct {
     int lna_states;
     int srate_min;
     int srate_max;
+    int srates[16];             /* Offered rates within srate_min..max */
+    int srate_count;
     int bandwidths[16];
     int bandwidth_count;
     char antennas[8][8];
     int antenna_count;
     char agc_modes[8][16];
     int agc_mode_count;
+    
+    /* Per antenna port; 0 = use the global value */
+    int antenna_gain_min[CAPS_ANTENNA_PORTS];
+    int antenna_gain_max[CAPS_ANTENNA_PORTS];
+    int antenna_lna_states[CAPS_ANTENNA_PORTS];
 } sdr_capabilities_t;
 
 /* SDR Status structure */
@@ -47,6 +95,8 @@ typedef struct {
     char phoenix_version[32];
     char protocol_version[16];
     char api_version[16];
+    char device[32];            /* Optional VER DEVICE=, "" if not sent */
+    char serial[32];            /* Optional VER SERIAL=, "" if not sent */
 } sdr_version_t;
 
 /* Protocol handler context */
@@ -57,8 +107,20 @@ typedef struct {
     sdr_version_t version;
     error_code_t last_error;
     char last_error_msg[256];
-    bool caps_loaded;
+    bool caps_loaded;           /* caps came from the server (or its cache) */
     bool version_loaded;
+    latency_hist_t latency[SDR_VERB_COUNT];  /* Command round trips */
+    
+    /* Status updates (sdr_poll_status) */
+    bool status_subscribed;     /* Server pushes "! STATUS" changes */
+    uint32_t status_seq;        /* Bumped whenever status changes */
+    uint32_t poll_seq;          /* status_seq at last sdr_poll_status */
+    uint32_t poll_interval_ms;  /* Adaptive STATUS interval */
+    uint32_t last_poll_ms;
+    
+    /* Binary framing (sdr_negotiate_binary) */
+    bool binary;                /* Set/status commands sent as frames */
+    uint16_t binary_seq;        /* Sequence number of last frame sent */
 } sdr_protocol_t;
 
 /* Create protocol handler */
@@ -69,6 +131,8 @@ void sdr_protocol_destroy(sdr_protocol_t* proto);
 
 /* Connection commands */
 bool sdr_connect(sdr_protocol_t* proto, const char* host, int port);
+bool sdr_connect_start(sdr_protocol_t* proto, const char* host, int port);
+connection_state_t sdr_connect_poll(sdr_protocol_t* proto);
 void sdr_disconnect(sdr_protocol_t* proto);
 bool sdr_is_connected(sdr_protocol_t* proto);
 
@@ -76,6 +140,8 @@ bool sdr_is_connected(sdr_protocol_t* proto);
 bool sdr_ping(sdr_protocol_t* proto);
 bool sdr_get_version(sdr_protocol_t* proto);
 bool sdr_get_caps(sdr_protocol_t* proto);
+bool sdr_negotiate_binary(sdr_protocol_t* proto);
+bool sdr_load_caps(sdr_protocol_t* proto, const char* cache_filename);
 bool sdr_get_status(sdr_protocol_t* proto);
 bool sdr_quit(sdr_protocol_t* proto);
 
@@ -91,6 +157,9 @@ bool sdr_get_lna(sdr_protocol_t* proto, int* lna_state);
 bool sdr_set_agc(sdr_protocol_t* proto, agc_mode_t mode);
 bool sdr_get_agc(sdr_protocol_t* proto, agc_mode_t* mode);
 
+/* SET_GAIN + SET_LNA pipelined; unchanged values are skipped */
+bool sdr_set_gain_lna(sdr_protocol_t* proto, int gain_db, int lna_state);
+
 /* Sample rate and bandwidth */
 bool sdr_set_srate(sdr_protocol_t* proto, int srate_hz);
 bool sdr_get_srate(sdr_protocol_t* proto, int* srate_hz);
@@ -103,6 +172,10 @@ bool sdr_get_antenna(sdr_protocol_t* proto, antenna_port_t* port);
 bool sdr_set_biast(sdr_protocol_t* proto, bool enable);
 bool sdr_set_notch(sdr_protocol_t* proto, bool enable);
 
+/* Replay desired state (freq, gain, LNA, AGC, antenna, notch) as one
+   pipelined batch; true if every command was accepted */
+bool sdr_replay_state(sdr_protocol_t* proto, const sdr_status_t* desired);
+
 /* Streaming control */
 bool sdr_start(sdr_protocol_t* proto);
 bool sdr_stop(sdr_protocol_t* proto);
@@ -110,10 +183,28 @@ bool sdr_stop(sdr_protocol_t* proto);
 /* Process async notifications */
 bool sdr_process_async(sdr_protocol_t* proto);
 
+/* Status updates: subscribe to pushed changes (false = not supported),
+   then call sdr_poll_status every frame; it polls STATUS adaptively when
+   not subscribed and returns true when the status changed */
+bool sdr_subscribe_status(sdr_protocol_t* proto);
+bool sdr_poll_status(sdr_protocol_t* proto, uint32_t now_ms);
+
 /* Get last error */
 error_code_t sdr_get_error(sdr_protocol_t* proto);
 const char* sdr_get_error_msg(sdr_protocol_t* proto);
 
+/* Round-trip latency */
+const char* sdr_verb_name(sdr_verb_t verb);
+const latency_hist_t* sdr_get_latency(const sdr_protocol_t* proto, sdr_verb_t verb);
+bool sdr_dump_latency(const sdr_protocol_t* proto, const char* filename);
+
+/* Capabilities: caps always hold usable values (RSP2 defaults until
+   CAPS succeeds); sdr_load_caps uses the per-version cache when it can */
+void sdr_caps_defaults(sdr_capabilities_t* caps);
+void sdr_caps_gain_range(const sdr_capabilities_t* caps, antenna_port_t port,
+                         int* gain_min, int* gain_max);
+int sdr_caps_lna_max(const sdr_capabilities_t* caps, antenna_port_t port);
+
 /* Helper functions */
 const char* agc_mode_to_string(agc_mode_t mode);
 agc_mode_t string_to_agc_mode(const char* str);
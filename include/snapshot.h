@@ -0,0 +1,56 @@
+/**
+ * Phoenix SDR Controller - Snapshot Publishing
+ *
+ * Lets one producer thread publish a plain struct (app state, telemetry)
+ * that a reader thread copies out consistently, without locks and without
+ * either side ever waiting for the other.
+ *
+ * Double-buffered seqlock ("latch"): the producer keeps two copies and a
+ * sequence counter. While it rewrites one copy, the counter steers readers
+ * to the other, so a reader always has a finished version to copy. A
+ * reader retries only if the producer lapped it mid-copy. It copies into
+ * the slot's scratch copy first, so the caller's struct is only written
+ * with a whole version.
+ *
+ * Published types must be plain data (no pointers the reader follows).
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <SDL.h>
+
+/* Reader retries before giving up (producer lapping the reader this often
+ * means it is publishing in a tight loop) */
+#define SNAPSHOT_READ_RETRIES   64
+
+/* Snapshot slot (snapshot_init before use) */
+typedef struct {
+    SDL_atomic_t seq;           /* Publish count * 2, +1 while copy 0 is written */
+    size_t size;                /* Bytes per version */
+    uint8_t* copies;            /* Two versions and the reader's scratch, back to back */
+} snapshot_t;
+
+/* Allocate a slot for size-byte versions (nothing published yet) */
+bool snapshot_init(snapshot_t* snap, size_t size);
+
+/* Release the slot */
+void snapshot_free(snapshot_t* snap);
+
+/* Publish a new version (single producer) */
+void snapshot_publish(snapshot_t* snap, const void* src);
+
+/* Copy the latest version into dst (one reader per slot at a time).
+ * version (optional, in/out): the version dst already holds; when nothing
+ * newer was published the copy is skipped. Returns false if nothing was
+ * published yet or the retries ran out; dst and version are then left
+ * unchanged. */
+bool snapshot_read(const snapshot_t* snap, void* dst, uint32_t* version);
+
+/* Versions published so far */
+uint32_t snapshot_version(const snapshot_t* snap);
+
+#endif /* SNAPSHOT_H */
@@ -2,6 +2,12 @@
  * Phoenix SDR Controller - TCP Client
  * 
  * Handles TCP socket connection to the Phoenix SDR server.
+ * 
+ * Connecting is non-blocking: tcp_client_connect_start() resolves the host
+ * on a worker thread, then tcp_client_connect_poll() races the resolved
+ * addresses (IPv6/IPv4 interleaved, a new attempt every
+ * TCP_CONNECT_STAGGER_MS while earlier ones are pending, as in RFC 8305)
+ * and keeps the first that connects.
  */
 
 #ifndef TCP_CLIENT_H
@@ -9,6 +15,40 @@
 
 #include "common.h"
 
+/* Connect tuning */
+#define TCP_MAX_CANDIDATES      8                   /* Addresses raced per connect */
+#define TCP_CONNECT_STAGGER_MS  250                 /* Delay before next address */
+#define TCP_CONNECT_TIMEOUT_MS  SOCKET_TIMEOUT_MS   /* Whole attempt, incl. resolve */
+
+/* Socket options, from the [Network] section of the presets INI */
+typedef struct {
+    bool nodelay;               /* TCP_NODELAY (disable Nagle) */
+    bool keepalive;             /* SO_KEEPALIVE with the probes below */
+    int keepalive_idle_s;       /* Idle time before first probe */
+    int keepalive_interval_s;   /* Between probes */
+    int keepalive_count;        /* Unanswered probes before drop */
+    int user_timeout_ms;        /* Unacked data limit (TCP_USER_TIMEOUT/TCP_MAXRT), 0 = OS */
+    int rcvbuf;                 /* SO_RCVBUF bytes, 0 = OS default */
+    int sndbuf;                 /* SO_SNDBUF bytes, 0 = OS default */
+    bool measure_rtt;           /* Log every command round trip */
+    bool binary;                /* Offer binary framing after VER (sdr_binary.h) */
+} tcp_options_t;
+
+/* Round-trip statistics for the current connection (measure_rtt) */
+typedef struct {
+    uint32_t count;
+    double min_ms;
+    double max_ms;
+    double sum_ms;
+} tcp_rtt_stats_t;
+
+/* One address being tried */
+typedef struct {
+    struct sockaddr_storage addr;
+    int addr_len;
+    socket_t socket;            /* INVALID_SOCK when not in flight */
+} tcp_candidate_t;
+
 /* TCP Client context */
 typedef struct {
     socket_t socket;
@@ -18,6 +58,17 @@ typedef struct {
     char last_error[256];
     uint32_t last_activity_ms;
     bool has_pending_data;
+    tcp_options_t options;
+    tcp_rtt_stats_t rtt;
+    
+    /* Connect in progress (state == CONN_CONNECTING) */
+    void* resolve_job;          /* Pending resolver, NULL once resolved */
+    tcp_candidate_t candidates[TCP_MAX_CANDIDATES];
+    int candidate_count;
+    int next_candidate;         /* Next address to start */
+    int last_connect_error;
+    uint32_t connect_start_ms;
+    uint32_t next_attempt_ms;
 } tcp_client_t;
 
 /* Initialize TCP client (call once at startup) */
@@ -32,10 +83,22 @@ tcp_client_t* tcp_client_create(void);
 /* Destroy client context */
 void tcp_client_destroy(tcp_client_t* client);
 
-/* Connect to server */
+/* Load [Network] options from INI file (applied on next connect) */
+bool tcp_client_load_options(tcp_client_t* client, const char* filename);
+
+/* Save [Network] options to INI file (replaces that section only) */
+bool tcp_client_save_options(tcp_client_t* client, const char* filename);
+
+/* Connect to server (blocks until connect_poll settles) */
 bool tcp_client_connect(tcp_client_t* client, const char* host, int port);
 
-/* Disconnect from server */
+/* Start a non-blocking connect (state becomes CONN_CONNECTING) */
+bool tcp_client_connect_start(tcp_client_t* client, const char* host, int port);
+
+/* Advance a connect in progress without blocking; returns the new state */
+connection_state_t tcp_client_connect_poll(tcp_client_t* client);
+
+/* Disconnect from server (also cancels a connect in progress) */
 void tcp_client_disconnect(tcp_client_t* client);
 
 /* Check if connected */
@@ -44,9 +107,20 @@ bool tcp_client_is_connected(tcp_client_t* client);
 /* Send a command (adds newline automatically) */
 bool tcp_client_send(tcp_client_t* client, const char* command);
 
+/* Send several commands in one write (pipelined; read one response each) */
+bool tcp_client_send_lines(tcp_client_t* client, const char* const* commands, int count);
+
 /* Receive response (blocking with timeout) */
 bool tcp_client_receive(tcp_client_t* client, char* buffer, size_t buffer_size, int timeout_ms);
 
+/* Send / receive exactly len raw bytes (binary frames; blocking with timeout) */
+bool tcp_client_send_bytes(tcp_client_t* client, const void* data, size_t len);
+bool tcp_client_receive_bytes(tcp_client_t* client, void* data, size_t len, int timeout_ms);
+
+/* Record a round trip the caller timed from start (SDL performance counter),
+ * e.g. one reply of a pipelined batch; no-op unless measure_rtt is set */
+void tcp_client_record_rtt(tcp_client_t* client, const char* command, uint64_t start);
+
 /* Send command and receive response */
 bool tcp_client_send_receive(tcp_client_t* client, const char* command, 
                              char* response, size_t response_size, int timeout_ms);
@@ -129,6 +129,7 @@ typedef struct {
     int last_symbol_second;     /* Frame second (0-59) from modem */
     float last_symbol_width_ms;
     float last_symbol_confidence;  /* Symbol confidence 0.0-1.0 */
+    uint32_t last_symbol_update;   /* Time a new symbol (SYM/CORR) arrived */
     /* Decoded time (if valid) */
     bool time_valid;
     int hours;
@@ -71,6 +71,17 @@ typedef struct {
     widget_combo_t combo_bw;
     widget_combo_t combo_antenna;
     
+    /* Control ranges and combo contents from SDR capabilities */
+    sdr_capabilities_t caps;
+    const char* agc_items[8];
+    agc_mode_t agc_values[8];
+    const char* srate_items[16];
+    char srate_labels[16][16];
+    const char* bw_items[16];
+    char bw_labels[16][16];
+    const char* antenna_items[8];
+    antenna_port_t antenna_values[8];
+    
     /* Toggles */
     widget_toggle_t toggle_biast;
     widget_toggle_t toggle_notch;
@@ -80,6 +91,10 @@ typedef struct {
     widget_button_t btn_aff_interval_dec;
     widget_button_t btn_aff_interval_inc;
     int aff_interval_value;  /* Current interval index (for display) */
+    widget_button_t btn_aff_mode;   /* AFF estimator mode (cycles on click) */
+    int aff_mode_value;      /* Current aff_mode_t (for display) */
+    SDL_Rect aff_plot;              /* AFF drift history plot */
+    widget_button_t btn_aff_export; /* Export AFF history as CSV */
     
     /* DC offset indicator (clickable dot next to freq display) */
     SDL_Rect offset_dot;
@@ -195,6 +210,8 @@ typedef struct {
     bool new_aff;           /* New AFF state */
     bool aff_interval_dec;  /* AFF interval - button clicked */
     bool aff_interval_inc;  /* AFF interval + button clicked */
+    bool aff_mode_cycle;    /* AFF estimator mode button clicked */
+    bool aff_export;        /* AFF history CSV export clicked */
 } ui_actions_t;
 
 /* Create layout */
@@ -206,6 +223,9 @@ void ui_layout_destroy(ui_layout_t* layout);
 /* Recalculate layout (call on window resize) */
 void ui_layout_recalculate(ui_layout_t* layout);
 
+/* Set slider ranges and combo items from SDR capabilities */
+void ui_layout_apply_caps(ui_layout_t* layout, const sdr_capabilities_t* caps);
+
 /* Update layout from app state */
 void ui_layout_sync_state(ui_layout_t* layout, const app_state_t* state);
 
@@ -245,12 +265,16 @@ void ui_layout_draw_sync_panel(ui_layout_t* layout, const udp_telemetry_t* telem
 /* Draw Minute Marker panel (MARK packets) */
 void ui_layout_draw_mark_panel(ui_layout_t* layout, const udp_telemetry_t* telem);
 
+/* Draw AFF drift history plot (beside the AFF toggle) */
+void ui_layout_draw_aff_panel(ui_layout_t* layout, aff_state_t* aff);
+
 /* Draw Telemetry panel (bottom left with tabs) */
 void ui_layout_draw_telemetry_panel(ui_layout_t* layout);
 
 /* Debug mode (F1 to toggle) */
 void ui_layout_toggle_debug(ui_layout_t* layout);
 void ui_layout_draw_debug(ui_layout_t* layout);
+void ui_layout_draw_latency(ui_layout_t* layout, const sdr_protocol_t* proto);
 void ui_layout_debug_click(ui_layout_t* layout, int x, int y);
 
 /* Edit mode (F2 to toggle, F3 to dump positions) */
@@ -2,6 +2,9 @@
  * aff.c - Automatic Frequency Following Implementation
  * 
  * Monitors sync timing delta and applies conservative frequency corrections.
+ * In Kalman mode, also fuses CARR offsets into a two-state
+ * (offset, drift rate) estimate and corrects proportionally. In fast mode,
+ * tracks robust per-second CARR offsets with SYNC as fallback.
  */
 
 #include "aff.h"
@@ -9,11 +12,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 
 /*============================================================================
  * Internal Types
  *============================================================================*/
 
+/* Timestamped offset samples of one source (fast mode) */
+typedef struct {
+    float hz[AFF_FAST_WINDOW];          /* Offset left by the current tuning (Hz) */
+    uint32_t time_ms[AFF_FAST_WINDOW];
+    int head;
+    int count;
+} aff_window_t;
+
 struct aff_state {
     bool enabled;
     int interval_index;
@@ -27,6 +39,8 @@ struct aff_state {
     int64_t carrier_hz;
     
     /* Timing */
+    aff_clock_fn clock;         /* NULL = get_time_ms() */
+    void* clock_userdata;
     uint32_t last_update_ms;
     uint32_t interval_start_ms;
     bool interval_elapsed;
@@ -38,6 +52,41 @@ struct aff_state {
     /* Pending adjustment */
     bool adjustment_ready;
     int adjustment_hz;
+    
+    /* Estimator mode */
+    aff_mode_t mode;
+    
+    /* Kalman estimator: x = [offset Hz, drift Hz/s], covariance p */
+    bool kf_init;
+    double kf_x[2];
+    double kf_p[2][2];
+    uint32_t kf_time_ms;        /* Time the state refers to */
+    int kf_updates;             /* Accepted measurements since last correction */
+    int kf_rejects;             /* Consecutive gated measurements */
+    bool corrected;             /* A correction has been applied */
+    uint32_t correction_ms;     /* Time of last applied correction */
+    
+    /* Fast path: per-source sample windows */
+    aff_window_t windows[AFF_SOURCE_COUNT];
+    uint32_t fast_eval_ms;      /* Time of last estimate */
+    
+    /* Drift history ring */
+    aff_history_entry_t history[AFF_HISTORY_SIZE];
+    int history_head;           /* Next slot to write */
+    int history_count;
+    uint32_t history_last_ms;
+    int history_correction_hz;  /* Applied since last sample */
+    int total_correction_hz;
+    bool locked;                /* Last lock state from aff_update */
+    
+    /* Learned oscillator model */
+    aff_model_t* model;         /* Not owned */
+    bool model_pending;         /* Pre-apply on next update */
+    bool model_sampled;
+    uint32_t model_sample_ms;   /* Time of last learning sample */
+    int session_correction_hz;  /* Corrections in the current tuning */
+    bool estimate_valid;        /* Estimator has a settled estimate */
+    uint32_t estimate_ms;       /* ... as of this time */
 };
 
 /* Interval values in seconds */
@@ -50,6 +99,16 @@ static const char* interval_strings[AFF_INTERVAL_COUNT] = {
     "30s", "45s", "60s", "90s", "120s"
 };
 
+/* Mode display strings */
+static const char* mode_strings[AFF_MODE_COUNT] = {
+    "Step", "Kalman", "Fast"
+};
+
+/* Source names for log messages */
+static const char* source_strings[AFF_SOURCE_COUNT] = {
+    "SYNC", "CARR"
+};
+
 /*============================================================================
  * Helpers
  *============================================================================*/
@@ -65,6 +124,18 @@ static uint32_t get_time_ms(void)
 #endif
 }
 
+static uint32_t aff_now(const aff_state_t* aff)
+{
+    return aff->clock ? aff->clock(aff->clock_userdata) : get_time_ms();
+}
+
+/* Estimator has a settled drift estimate as of now (model learning) */
+static void mark_estimate(aff_state_t* aff, uint32_t now)
+{
+    aff->estimate_valid = true;
+    aff->estimate_ms = now;
+}
+
 static float calculate_mean(const float* samples, int count)
 {
     if (count == 0) return 0.0f;
@@ -86,6 +157,350 @@ static float delta_ms_to_hz(float delta_ms, int64_t carrier_hz)
     return (float)carrier_hz * (delta_ms / 60000.0f);
 }
 
+/*============================================================================
+ * Kalman Estimator
+ *============================================================================*/
+
+/* Measurement sigma multiplier: 1.0 at AFF_KF_REF_SNR_DB, x2 per 6 dB less */
+static float snr_scale(float snr_db)
+{
+    if (!isfinite(snr_db)) return 1.0f;
+    
+    float scale = powf(10.0f, (AFF_KF_REF_SNR_DB - snr_db) / 20.0f);
+    return CLAMP(scale, 0.25f, 10.0f);
+}
+
+/* Advance state to 'now' (constant drift model) */
+static void kf_predict(aff_state_t* aff, uint32_t now)
+{
+    double dt = (double)(uint32_t)(now - aff->kf_time_ms) / 1000.0;
+    aff->kf_time_ms = now;
+    if (dt <= 0.0) return;
+    
+    double (*p)[2] = aff->kf_p;
+    double p00 = p[0][0] + dt * (p[0][1] + p[1][0]) + dt * dt * p[1][1];
+    double p01 = p[0][1] + dt * p[1][1];
+    
+    aff->kf_x[0] += aff->kf_x[1] * dt;
+    
+    p[0][0] = p00 + AFF_KF_Q_OFFSET * dt + AFF_KF_Q_DRIFT * dt * dt * dt / 3.0;
+    p[0][1] = p01 + AFF_KF_Q_DRIFT * dt * dt / 2.0;
+    p[1][0] = p[0][1];
+    p[1][1] += AFF_KF_Q_DRIFT * dt;
+}
+
+/* Start the filter from a single offset measurement */
+static void kf_start(aff_state_t* aff, double z, double r, uint32_t now)
+{
+    aff->kf_x[0] = z;
+    aff->kf_x[1] = 0.0;
+    aff->kf_p[0][0] = r;
+    aff->kf_p[0][1] = 0.0;
+    aff->kf_p[1][0] = 0.0;
+    aff->kf_p[1][1] = AFF_KF_INIT_DRIFT_SD * AFF_KF_INIT_DRIFT_SD;
+    aff->kf_time_ms = now;
+    aff->kf_init = true;
+    aff->kf_rejects = 0;
+}
+
+/* Fuse one offset measurement z (Hz) with variance r */
+static void kf_measure(aff_state_t* aff, double z, double r, uint32_t now)
+{
+    if (!aff->kf_init) {
+        kf_start(aff, z, r, now);
+        aff->kf_updates++;
+        return;
+    }
+    
+    kf_predict(aff, now);
+    
+    double (*p)[2] = aff->kf_p;
+    double innov = z - aff->kf_x[0];
+    double s = p[0][0] + r;
+    
+    /* Gate outliers; a run of them means the offset really moved */
+    if (innov * innov > AFF_KF_GATE_SIGMA * AFF_KF_GATE_SIGMA * s) {
+        if (++aff->kf_rejects < AFF_KF_MAX_REJECTS) return;
+        LOG_INFO("AFF: estimate %.2f Hz inconsistent with %d measurements, restarting at %.2f Hz",
+                 aff->kf_x[0], aff->kf_rejects, z);
+        kf_start(aff, z, r, now);
+        aff->kf_updates = 1;
+        return;
+    }
+    aff->kf_rejects = 0;
+    
+    double k0 = p[0][0] / s;
+    double k1 = p[1][0] / s;
+    aff->kf_x[0] += k0 * innov;
+    aff->kf_x[1] += k1 * innov;
+    
+    double p00 = p[0][0], p01 = p[0][1];
+    p[0][0] = (1.0 - k0) * p00;
+    p[0][1] = (1.0 - k0) * p01;
+    p[1][1] -= k1 * p01;
+    p[1][0] = p[0][1];
+    
+    aff->kf_updates++;
+}
+
+/* Interval check for Kalman mode: proportional, slew-limited correction */
+static void kf_check_interval(aff_state_t* aff, uint32_t now)
+{
+    int interval_ms = interval_values[aff->interval_index] * 1000;
+    uint32_t elapsed = now - aff->interval_start_ms;
+    
+    if (elapsed < (uint32_t)interval_ms || aff->interval_elapsed) return;
+    if (!aff->kf_init || aff->kf_updates < AFF_KF_MIN_UPDATES) return;
+    
+    kf_predict(aff, now);
+    double offset = aff->kf_x[0];
+    double sd = sqrt(aff->kf_p[0][0]);
+    aff->drift_hz = (float)offset;
+    
+    /* Below threshold or not yet significant: wait another interval */
+    if (fabs(offset) < AFF_THRESHOLD_HZ || fabs(offset) < 2.0 * sd) {
+        LOG_DEBUG("AFF: offset=%.2f Hz sd=%.2f Hz (no correction)", offset, sd);
+        aff->interval_start_ms = now;
+        return;
+    }
+    
+    int adjust = (int)lround(AFF_KF_GAIN * offset);
+    if (adjust == 0) adjust = (offset > 0) ? 1 : -1;
+    adjust = CLAMP(adjust, -AFF_KF_MAX_SLEW_HZ, AFF_KF_MAX_SLEW_HZ);
+    
+    aff->interval_elapsed = true;
+    aff->adjustment_hz = adjust;
+    aff->adjustment_ready = true;
+    
+    LOG_INFO("AFF: offset=%.2f Hz sd=%.2f Hz drift=%+.4f Hz/s, adjustment=%+d Hz",
+             offset, sd, aff->kf_x[1], adjust);
+}
+
+/*============================================================================
+ * Fast Estimator
+ *============================================================================*/
+
+static void window_push(aff_window_t* win, float hz, uint32_t now)
+{
+    win->hz[win->head] = hz;
+    win->time_ms[win->head] = now;
+    win->head = (win->head + 1) % AFF_FAST_WINDOW;
+    if (win->count < AFF_FAST_WINDOW) {
+        win->count++;
+    }
+}
+
+static float median_sorted(float* v, int n)
+{
+    /* Insertion sort: n <= AFF_FAST_WINDOW */
+    for (int i = 1; i < n; i++) {
+        float x = v[i];
+        int j = i - 1;
+        while (j >= 0 && v[j] > x) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = x;
+    }
+    return (n & 1) ? v[n / 2] : 0.5f * (v[n / 2 - 1] + v[n / 2]);
+}
+
+/**
+ * Robust window estimate: samples beyond AFF_FAST_MAD_GATE robust sigmas
+ * of the median are dropped, the rest averaged.
+ * Returns false if fewer than min_samples fresh samples remain.
+ */
+static bool window_estimate(const aff_window_t* win, uint32_t now, uint32_t max_age_ms,
+                            int min_samples, float* est_hz, float* stderr_hz)
+{
+    float fresh[AFF_FAST_WINDOW];
+    float dev[AFF_FAST_WINDOW];
+    int n = 0;
+    
+    for (int i = 0; i < win->count; i++) {
+        if (now - win->time_ms[i] <= max_age_ms) {
+            fresh[n++] = win->hz[i];
+        }
+    }
+    if (n < min_samples) return false;
+    
+    float med = median_sorted(fresh, n);
+    for (int i = 0; i < n; i++) {
+        dev[i] = fabsf(fresh[i] - med);
+    }
+    float sigma = 1.4826f * median_sorted(dev, n);
+    
+    float sum = 0.0f, sum_sq = 0.0f;
+    int used = 0;
+    for (int i = 0; i < n; i++) {
+        if (sigma > 0.0f && fabsf(fresh[i] - med) > AFF_FAST_MAD_GATE * sigma) continue;
+        sum += fresh[i];
+        sum_sq += fresh[i] * fresh[i];
+        used++;
+    }
+    if (used < min_samples) return false;
+    
+    /* Small windows understate the spread; take the larger of the
+     * sample and robust (MAD) sigmas */
+    float mean = sum / used;
+    float var = sum_sq / used - mean * mean;
+    float sd = sqrtf(var > 0.0f ? var : 0.0f);
+    if (sigma > sd) sd = sigma;
+    *est_hz = mean;
+    *stderr_hz = sd / sqrtf((float)used);
+    return true;
+}
+
+/**
+ * Queue a whole-Hz correction of est if it reduces the offset by more than
+ * the estimate's uncertainty (avoids dithering around half a hertz)
+ */
+static void fast_try_adjustment(aff_state_t* aff, aff_source_t source, float est,
+                                float err, int max_adjust)
+{
+    if (fabsf(est) < AFF_THRESHOLD_HZ) return;
+    
+    int adjust = (int)lroundf(est);
+    if (adjust == 0) adjust = (est > 0) ? 1 : -1;
+    adjust = CLAMP(adjust, -max_adjust, max_adjust);
+    
+    /* Estimates are re-tested every second, so demand a real improvement,
+     * not just a significant one */
+    float gain = fabsf(est) - fabsf(est - adjust);
+    if (gain <= AFF_FAST_SIGNIFICANCE * err || gain < AFF_FAST_MIN_GAIN_HZ) return;
+    
+    aff->adjustment_hz = adjust;
+    aff->adjustment_ready = true;
+    
+    LOG_INFO("AFF: %s offset=%.2f Hz (±%.2f), adjustment=%+d Hz",
+             source_strings[source], est, err, adjust);
+}
+
+/* Fast mode check: per-second CARR, else SYNC at the interval */
+static void fast_check(aff_state_t* aff, uint32_t now)
+{
+    if (now - aff->fast_eval_ms < AFF_FAST_EVAL_MS) return;
+    aff->fast_eval_ms = now;
+    if (aff->adjustment_ready) return;
+    
+    float est, err;
+    if (window_estimate(&aff->windows[AFF_SOURCE_CARRIER], now, AFF_FAST_MAX_AGE_MS,
+                        AFF_FAST_MIN_SAMPLES, &est, &err)) {
+        aff->drift_hz = est;
+        mark_estimate(aff, now);
+        if (aff->corrected && now - aff->correction_ms < AFF_FAST_HOLDOFF_MS) return;
+        fast_try_adjustment(aff, AFF_SOURCE_CARRIER, est, err, AFF_FAST_MAX_ADJUST_HZ);
+        return;
+    }
+    
+    /* Fallback: SYNC delta, conservative step once per interval */
+    int interval_ms = interval_values[aff->interval_index] * 1000;
+    if (now - aff->interval_start_ms < (uint32_t)interval_ms) return;
+    aff->interval_start_ms = now;
+    
+    if (!window_estimate(&aff->windows[AFF_SOURCE_SYNC], now, AFF_FAST_SYNC_AGE_MS,
+                         AFF_FAST_SYNC_MIN, &est, &err)) return;
+    aff->drift_hz = est;
+    fast_try_adjustment(aff, AFF_SOURCE_SYNC, est, err, AFF_MAX_ADJUST_HZ);
+}
+
+/*============================================================================
+ * Learned Model
+ *============================================================================*/
+
+/* Largest single correction the current mode makes */
+static int mode_max_adjust_hz(const aff_state_t* aff)
+{
+    switch (aff->mode) {
+        case AFF_MODE_KALMAN: return AFF_KF_MAX_SLEW_HZ;
+        case AFF_MODE_FAST:   return AFF_FAST_MAX_ADJUST_HZ;
+        default:              return AFF_MAX_ADJUST_HZ;
+    }
+}
+
+/* Queue the model's predicted offset for the current tuning, no larger
+ * than a normal correction; the loop finds the rest */
+static void model_preapply(aff_state_t* aff)
+{
+    aff->model_pending = false;
+    if (!aff->model) return;
+    
+    /* Server still on the frequency we left it: that correction is in place */
+    int64_t tuned_hz;
+    int correction_hz;
+    if (aff->session_correction_hz == 0 &&
+        aff_model_get_tuning(aff->model, &tuned_hz, &correction_hz) &&
+        tuned_hz == aff->carrier_hz) {
+        aff->session_correction_hz = correction_hz;
+    }
+    aff_model_set_tuning(aff->model, aff->carrier_hz, aff->session_correction_hz);
+    
+    double ppm, residual;
+    if (!aff_model_predict(aff->model, (int64_t)time(NULL), &ppm, &residual)) return;
+    
+    double nominal_hz = (double)(aff->carrier_hz - aff->session_correction_hz);
+    double residual_hz = residual * nominal_hz / 1e6;
+    if (residual_hz > AFF_MODEL_MAX_FIT_HZ) {
+        LOG_INFO("AFF: learned offset %.3f ppm not applied, fit scatter %.2f Hz",
+                 ppm, residual_hz);
+        return;
+    }
+    
+    int predicted = (int)lround(ppm * nominal_hz / 1e6) - aff->session_correction_hz;
+    int max_adjust = mode_max_adjust_hz(aff);
+    int adjust = CLAMP(predicted, -max_adjust, max_adjust);
+    if (adjust == 0) return;
+    
+    aff->adjustment_hz = adjust;
+    aff->adjustment_ready = true;
+    LOG_INFO("AFF: pre-applying learned offset %.3f ppm (%+d of %+d Hz, scatter %.2f Hz)",
+             ppm, adjust, predicted, residual_hz);
+}
+
+/* Feed the settled offset of the current tuning to the model */
+static void model_learn(aff_state_t* aff, uint32_t now)
+{
+    if (!aff->model || !aff->estimate_valid || aff->carrier_hz <= 0) return;
+    if (now - aff->estimate_ms > AFF_FAST_MAX_AGE_MS) return;
+    if (aff->corrected && now - aff->correction_ms < AFF_MODEL_SETTLE_MS) return;
+    if (aff->model_sampled && now - aff->model_sample_ms < AFF_MODEL_SAMPLE_MS) return;
+    if (fabsf(aff->drift_hz) > AFF_MODEL_MAX_RESIDUAL_HZ) return;
+    
+    double nominal_hz = (double)(aff->carrier_hz - aff->session_correction_hz);
+    double ppm = (aff->session_correction_hz + aff->drift_hz) / nominal_hz * 1e6;
+    aff_model_add_sample(aff->model, (int64_t)time(NULL), ppm);
+    
+    aff->model_sampled = true;
+    aff->model_sample_ms = now;
+}
+
+/*============================================================================
+ * History
+ *============================================================================*/
+
+static void history_record(aff_state_t* aff, uint32_t now)
+{
+    if (aff->history_count > 0 && now - aff->history_last_ms < AFF_HISTORY_PERIOD_MS) {
+        return;
+    }
+    aff->history_last_ms = now;
+    
+    aff_history_entry_t* e = &aff->history[aff->history_head];
+    e->time_ms = now;
+    e->unix_time = (int64_t)time(NULL);
+    e->drift_hz = aff->drift_hz;
+    e->correction_hz = aff->history_correction_hz;
+    e->total_correction_hz = aff->total_correction_hz;
+    e->locked = aff->locked;
+    e->mode = (uint8_t)aff->mode;
+    
+    aff->history_correction_hz = 0;
+    aff->history_head = (aff->history_head + 1) % AFF_HISTORY_SIZE;
+    if (aff->history_count < AFF_HISTORY_SIZE) {
+        aff->history_count++;
+    }
+}
+
 /*============================================================================
  * Public API
  *============================================================================*/
@@ -102,9 +517,10 @@ aff_state_t* aff_create(void)
     aff->interval_index = AFF_INTERVAL_60S;  /* Default 60 seconds */
     aff->sample_head = 0;
     aff->sample_count = 0;
-    aff->interval_start_ms = get_time_ms();
+    aff->interval_start_ms = aff_now(aff);
     aff->interval_elapsed = false;
     aff->adjustment_ready = false;
+    aff->mode = AFF_MODE_STEP;
     
     LOG_INFO("AFF module created");
     return aff;
@@ -118,6 +534,23 @@ void aff_destroy(aff_state_t* aff)
     }
 }
 
+void aff_set_clock(aff_state_t* aff, aff_clock_fn clock, void* userdata)
+{
+    if (!aff) return;
+    
+    aff->clock = clock;
+    aff->clock_userdata = userdata;
+    aff_reset(aff);
+}
+
+void aff_set_model(aff_state_t* aff, aff_model_t* model)
+{
+    if (!aff) return;
+    
+    aff->model = model;
+    aff->model_pending = true;
+}
+
 void aff_set_enabled(aff_state_t* aff, bool enabled)
 {
     if (!aff) return;
@@ -148,7 +581,7 @@ void aff_set_interval(aff_state_t* aff, int interval_index)
     if (aff->interval_index != interval_index) {
         aff->interval_index = interval_index;
         /* Reset timing when interval changes */
-        aff->interval_start_ms = get_time_ms();
+        aff->interval_start_ms = aff_now(aff);
         aff->interval_elapsed = false;
         LOG_INFO("AFF interval set to %s", interval_strings[interval_index]);
     }
@@ -175,13 +608,54 @@ const char* aff_interval_string(int interval_index)
     return interval_strings[interval_index];
 }
 
+void aff_set_mode(aff_state_t* aff, aff_mode_t mode)
+{
+    if (!aff || mode < 0 || mode >= AFF_MODE_COUNT) return;
+    
+    if (aff->mode != mode) {
+        aff->mode = mode;
+        aff_reset(aff);
+        LOG_INFO("AFF mode set to %s", mode_strings[mode]);
+    }
+}
+
+aff_mode_t aff_get_mode(aff_state_t* aff)
+{
+    return aff ? aff->mode : AFF_MODE_STEP;
+}
+
+const char* aff_mode_string(aff_mode_t mode)
+{
+    if (mode < 0 || mode >= AFF_MODE_COUNT) {
+        return "?";
+    }
+    return mode_strings[mode];
+}
+
 void aff_update(aff_state_t* aff, float delta_ms, int64_t carrier_hz, bool is_locked)
 {
     if (!aff || !aff->enabled) return;
     
-    uint32_t now = get_time_ms();
+    uint32_t now = aff_now(aff);
     aff->last_update_ms = now;
     aff->carrier_hz = carrier_hz;
+    aff->locked = is_locked;
+    history_record(aff, now);
+    model_learn(aff, now);
+    
+    if (aff->model_pending && carrier_hz > 0 && !aff->adjustment_ready) {
+        model_preapply(aff);
+        if (aff->adjustment_ready) return;
+    }
+    
+    if (aff->mode == AFF_MODE_KALMAN) {
+        kf_check_interval(aff, now);
+        return;
+    }
+    if (aff->mode == AFF_MODE_FAST) {
+        fast_check(aff, now);
+        return;
+    }
     
     /* Only collect samples when locked */
     if (!is_locked) {
@@ -198,8 +672,12 @@ void aff_update(aff_state_t* aff, float delta_ms, int64_t carrier_hz, bool is_lo
     /* Calculate mean delta */
     aff->mean_delta_ms = calculate_mean(aff->samples, aff->sample_count);
     
-    /* Convert to Hz */
-    aff->drift_hz = delta_ms_to_hz(aff->mean_delta_ms, carrier_hz);
+    /* Convert to Hz; SYNC sees the whole offset, so less the corrections
+     * already in the tuning */
+    aff->drift_hz = delta_ms_to_hz(aff->mean_delta_ms, carrier_hz) - aff->session_correction_hz;
+    if (aff->sample_count == AFF_SAMPLE_COUNT) {
+        mark_estimate(aff, now);
+    }
     
     /* Check if interval has elapsed */
     int interval_ms = interval_values[aff->interval_index] * 1000;
@@ -226,6 +704,50 @@ void aff_update(aff_state_t* aff, float delta_ms, int64_t carrier_hz, bool is_lo
     }
 }
 
+void aff_update_offset(aff_state_t* aff, aff_source_t source, float value, float snr_db)
+{
+    if (!aff || !aff->enabled || aff->mode == AFF_MODE_STEP) return;
+    if (aff->carrier_hz <= 0 || !isfinite(value)) return;
+    
+    uint32_t now = aff_now(aff);
+    
+    /* Everything is estimated as the offset the current tuning leaves */
+    double z, sigma;
+    switch (source) {
+        case AFF_SOURCE_SYNC:
+            /* Sample clock: whole offset, whatever the tuning */
+            z = delta_ms_to_hz(value, aff->carrier_hz) - aff->session_correction_hz;
+            sigma = delta_ms_to_hz(AFF_KF_SYNC_SIGMA_MS, aff->carrier_hz);
+            break;
+        case AFF_SOURCE_CARRIER:
+            /* Measurements spanning the last retune would see part of the old offset */
+            if (aff->corrected) {
+                uint32_t settle = (aff->mode == AFF_MODE_FAST) ? AFF_FAST_SETTLE_MS : AFF_KF_SETTLE_MS;
+                if (now - aff->correction_ms < settle) return;
+            }
+            z = value;
+            sigma = AFF_KF_CARR_SIGMA_HZ;
+            break;
+        default:
+            return;
+    }
+    
+    if (aff->mode == AFF_MODE_FAST) {
+        window_push(&aff->windows[source], (float)z, now);
+        return;
+    }
+    
+    sigma *= snr_scale(snr_db);
+    kf_measure(aff, z, sigma * sigma, now);
+    if (aff->kf_init) {
+        aff->drift_hz = (float)aff->kf_x[0];
+        if (aff->kf_updates >= AFF_KF_MIN_UPDATES &&
+            sqrt(aff->kf_p[0][0]) < 0.5 * AFF_MODEL_MAX_RESIDUAL_HZ) {
+            mark_estimate(aff, now);
+        }
+    }
+}
+
 bool aff_get_adjustment(aff_state_t* aff, int* adjustment_hz)
 {
     if (!aff || !aff->enabled || !aff->adjustment_ready) {
@@ -239,13 +761,38 @@ bool aff_get_adjustment(aff_state_t* aff, int* adjustment_hz)
     
     /* Clear adjustment and reset for next interval */
     aff->adjustment_ready = false;
-    aff->interval_start_ms = get_time_ms();
+    aff->interval_start_ms = aff_now(aff);
     aff->interval_elapsed = false;
     
     /* Clear sample buffer to start fresh */
     aff->sample_count = 0;
     aff->sample_head = 0;
     
+    /* Fast: CARR measured the old tuning; SYNC offsets stay valid once
+     * the correction is taken off */
+    memset(&aff->windows[AFF_SOURCE_CARRIER], 0, sizeof(aff->windows[AFF_SOURCE_CARRIER]));
+    aff_window_t* sync = &aff->windows[AFF_SOURCE_SYNC];
+    for (int i = 0; i < sync->count; i++) {
+        sync->hz[i] -= (float)aff->adjustment_hz;
+    }
+    
+    /* Kalman: the retune removes the corrected part of the offset */
+    if (aff->mode == AFF_MODE_KALMAN && aff->kf_init) {
+        aff->kf_x[0] -= aff->adjustment_hz;
+        aff->drift_hz = (float)aff->kf_x[0];
+        aff->kf_updates = 0;
+    }
+    aff->corrected = true;
+    aff->correction_ms = aff->interval_start_ms;
+    aff->history_correction_hz += aff->adjustment_hz;
+    aff->total_correction_hz += aff->adjustment_hz;
+    aff->session_correction_hz += aff->adjustment_hz;
+    aff->estimate_valid = false;
+    if (aff->model) {
+        aff_model_set_tuning(aff->model, aff->carrier_hz + aff->adjustment_hz,
+                             aff->session_correction_hz);
+    }
+    
     return true;
 }
 
@@ -254,6 +801,51 @@ float aff_get_drift_hz(aff_state_t* aff)
     return aff ? aff->drift_hz : 0.0f;
 }
 
+int aff_get_history(aff_state_t* aff, aff_history_entry_t* out, int max_entries)
+{
+    if (!aff || !out || max_entries <= 0) return 0;
+    
+    int count = aff->history_count < max_entries ? aff->history_count : max_entries;
+    int start = aff->history_head - count;
+    if (start < 0) start += AFF_HISTORY_SIZE;
+    
+    for (int i = 0; i < count; i++) {
+        out[i] = aff->history[(start + i) % AFF_HISTORY_SIZE];
+    }
+    return count;
+}
+
+bool aff_export_history_csv(aff_state_t* aff, const char* filename)
+{
+    if (!aff || !filename) return false;
+    
+    FILE* f = fopen(filename, "w");
+    if (!f) {
+        LOG_ERROR("AFF: cannot write history to %s", filename);
+        return false;
+    }
+    
+    fprintf(f, "unix_time,elapsed_s,mode,locked,drift_hz,correction_hz,total_correction_hz\n");
+    
+    int start = aff->history_head - aff->history_count;
+    if (start < 0) start += AFF_HISTORY_SIZE;
+    uint32_t t0 = aff->history[start].time_ms;
+    
+    for (int i = 0; i < aff->history_count; i++) {
+        const aff_history_entry_t* e = &aff->history[(start + i) % AFF_HISTORY_SIZE];
+        fprintf(f, "%lld,%.1f,%s,%d,%.3f,%d,%d\n",
+                (long long)e->unix_time, (uint32_t)(e->time_ms - t0) / 1000.0,
+                aff_mode_string((aff_mode_t)e->mode), e->locked ? 1 : 0,
+                e->drift_hz, e->correction_hz, e->total_correction_hz);
+    }
+    
+    bool ok = (fclose(f) == 0);
+    if (ok) {
+        LOG_INFO("AFF: wrote %d history entries to %s", aff->history_count, filename);
+    }
+    return ok;
+}
+
 void aff_reset(aff_state_t* aff)
 {
     if (!aff) return;
@@ -262,10 +854,18 @@ void aff_reset(aff_state_t* aff)
     aff->sample_count = 0;
     aff->mean_delta_ms = 0.0f;
     aff->drift_hz = 0.0f;
-    aff->interval_start_ms = get_time_ms();
+    aff->interval_start_ms = aff_now(aff);
     aff->interval_elapsed = false;
     aff->adjustment_ready = false;
     aff->adjustment_hz = 0;
+    aff->kf_init = false;
+    aff->kf_updates = 0;
+    aff->kf_rejects = 0;
+    aff->corrected = false;
+    memset(aff->windows, 0, sizeof(aff->windows));
+    aff->session_correction_hz = 0;
+    aff->estimate_valid = false;
+    aff->model_pending = true;
     
     LOG_DEBUG("AFF state reset");
 }
@@ -0,0 +1,276 @@
+/*
+ * aff_model.c - Learned receiver oscillator model implementation
+ *
+ * Each receiver record holds exponentially decayed sums for a weighted
+ * linear fit of ppm against time in days. Records are written as-is to a
+ * versioned binary file; a size or magic mismatch discards the file.
+ */
+
+#include "aff_model.h"
+#include "common.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+/*============================================================================
+ * Internal Types
+ *============================================================================*/
+
+#define AFF_MODEL_MAGIC     0x4D464641u     /* "AFFM" little-endian */
+#define AFF_MODEL_VERSION   2u
+
+/* On-disk record (fixed size, 8-byte fields first) */
+typedef struct {
+    int64_t ref_time;           /* Unix time of t = 0 */
+    int64_t last_time;          /* Unix time of newest sample (eviction order) */
+    int64_t tuned_hz;           /* Frequency AFF last left the receiver on */
+    double w, wt, wtt, wy, wty, wyy; /* Decayed fit sums (t in days) */
+    uint32_t samples;
+    int32_t correction_hz;      /* Correction included in tuned_hz */
+    char key[AFF_MODEL_KEY_MAX];
+} aff_model_record_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t count;
+} aff_model_header_t;
+
+struct aff_model {
+    aff_model_record_t records[AFF_MODEL_MAX_RECEIVERS];
+    int count;
+    int selected;               /* Index into records, -1 = none */
+    bool dirty;
+};
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+static aff_model_record_t* selected_record(aff_model_t* model)
+{
+    if (!model || model->selected < 0 || model->selected >= model->count) return NULL;
+    return &model->records[model->selected];
+}
+
+/* Fit mean, aging slope and residual scatter (ppm) from the decayed sums */
+static bool record_fit(const aff_model_record_t* r, double* t_mean, double* y_mean,
+                       double* slope, double* residual)
+{
+    if (r->samples < AFF_MODEL_MIN_SAMPLES || r->w <= 0.0) return false;
+    
+    *t_mean = r->wt / r->w;
+    *y_mean = r->wy / r->w;
+    double var_t = r->wtt / r->w - (*t_mean) * (*t_mean);
+    
+    double cov = r->wty / r->w - (*t_mean) * (*y_mean);
+    double var_y = r->wyy / r->w - (*y_mean) * (*y_mean);
+    
+    *slope = 0.0;
+    if (var_t > AFF_MODEL_MIN_SPAN_DAYS * AFF_MODEL_MIN_SPAN_DAYS) {
+        *slope = CLAMP(cov / var_t, -AFF_MODEL_MAX_AGING_PPM, AFF_MODEL_MAX_AGING_PPM);
+    }
+    
+    double var_r = var_y - 2.0 * (*slope) * cov + (*slope) * (*slope) * var_t;
+    *residual = sqrt(var_r > 0.0 ? var_r : 0.0);
+    return true;
+}
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+aff_model_t* aff_model_create(void)
+{
+    aff_model_t* model = (aff_model_t*)calloc(1, sizeof(aff_model_t));
+    if (!model) {
+        LOG_ERROR("Failed to allocate aff_model_t");
+        return NULL;
+    }
+    model->selected = -1;
+    return model;
+}
+
+void aff_model_destroy(aff_model_t* model)
+{
+    free(model);
+}
+
+bool aff_model_load(aff_model_t* model, const char* filename)
+{
+    if (!model || !filename) return false;
+    
+    FILE* f = fopen(filename, "rb");
+    if (!f) return false;
+    
+    aff_model_header_t hdr;
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+              hdr.magic == AFF_MODEL_MAGIC &&
+              hdr.version == AFF_MODEL_VERSION &&
+              hdr.record_size == sizeof(aff_model_record_t) &&
+              hdr.count <= AFF_MODEL_MAX_RECEIVERS;
+    if (ok && hdr.count > 0) {
+        ok = fread(model->records, sizeof(aff_model_record_t), hdr.count, f) == hdr.count;
+    }
+    fclose(f);
+    
+    if (!ok) {
+        LOG_WARN("AFF model: ignoring invalid file %s", filename);
+        memset(model->records, 0, sizeof(model->records));
+        model->count = 0;
+        return false;
+    }
+    
+    model->count = (int)hdr.count;
+    for (int i = 0; i < model->count; i++) {
+        model->records[i].key[AFF_MODEL_KEY_MAX - 1] = '\0';
+    }
+    model->selected = -1;
+    model->dirty = false;
+    LOG_INFO("AFF model: loaded %d receiver(s) from %s", model->count, filename);
+    return true;
+}
+
+bool aff_model_save(aff_model_t* model, const char* filename)
+{
+    if (!model || !filename) return false;
+    if (!model->dirty) return true;
+    
+    FILE* f = fopen(filename, "wb");
+    if (!f) {
+        LOG_ERROR("AFF model: cannot write %s", filename);
+        return false;
+    }
+    
+    aff_model_header_t hdr = {
+        AFF_MODEL_MAGIC, AFF_MODEL_VERSION,
+        (uint32_t)sizeof(aff_model_record_t), (uint32_t)model->count
+    };
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    if (ok && model->count > 0) {
+        ok = fwrite(model->records, sizeof(aff_model_record_t), (size_t)model->count, f) ==
+             (size_t)model->count;
+    }
+    if (fclose(f) != 0) ok = false;
+    
+    if (ok) {
+        model->dirty = false;
+        LOG_DEBUG("AFF model: saved %d receiver(s) to %s", model->count, filename);
+    } else {
+        LOG_ERROR("AFF model: write to %s failed", filename);
+    }
+    return ok;
+}
+
+bool aff_model_select(aff_model_t* model, const char* key)
+{
+    if (!model || !key || !key[0]) return false;
+    
+    for (int i = 0; i < model->count; i++) {
+        if (strcmp(model->records[i].key, key) == 0) {
+            bool changed = (model->selected != i);
+            model->selected = i;
+            return changed;
+        }
+    }
+    
+    /* New receiver: append, or replace the least recently learned one */
+    int slot = model->count;
+    if (slot >= AFF_MODEL_MAX_RECEIVERS) {
+        slot = 0;
+        for (int i = 1; i < model->count; i++) {
+            if (model->records[i].last_time < model->records[slot].last_time) slot = i;
+        }
+        LOG_INFO("AFF model: replacing receiver %s", model->records[slot].key);
+    } else {
+        model->count++;
+    }
+    
+    memset(&model->records[slot], 0, sizeof(aff_model_record_t));
+    strncpy(model->records[slot].key, key, AFF_MODEL_KEY_MAX - 1);
+    model->selected = slot;
+    model->dirty = true;
+    return true;
+}
+
+void aff_model_add_sample(aff_model_t* model, int64_t unix_time, double ppm)
+{
+    aff_model_record_t* r = selected_record(model);
+    if (!r || !isfinite(ppm) || fabs(ppm) > AFF_MODEL_MAX_PPM) return;
+    
+    if (r->samples == 0) {
+        r->ref_time = unix_time;
+    }
+    double t = (double)(unix_time - r->ref_time) / 86400.0;
+    
+    r->w = r->w * AFF_MODEL_DECAY + 1.0;
+    r->wt = r->wt * AFF_MODEL_DECAY + t;
+    r->wtt = r->wtt * AFF_MODEL_DECAY + t * t;
+    r->wy = r->wy * AFF_MODEL_DECAY + ppm;
+    r->wty = r->wty * AFF_MODEL_DECAY + t * ppm;
+    r->wyy = r->wyy * AFF_MODEL_DECAY + ppm * ppm;
+    r->samples++;
+    r->last_time = unix_time;
+    model->dirty = true;
+}
+
+bool aff_model_predict(aff_model_t* model, int64_t unix_time, double* ppm_out,
+                       double* residual_out)
+{
+    aff_model_record_t* r = selected_record(model);
+    if (!r || !ppm_out) return false;
+    
+    double t_mean, y_mean, slope, residual;
+    if (!record_fit(r, &t_mean, &y_mean, &slope, &residual)) return false;
+    
+    double t = (double)(unix_time - r->ref_time) / 86400.0;
+    double ppm = y_mean + slope * (t - t_mean);
+    if (!isfinite(ppm) || fabs(ppm) > AFF_MODEL_MAX_PPM) return false;
+    
+    *ppm_out = ppm;
+    if (residual_out) *residual_out = residual;
+    return true;
+}
+
+void aff_model_set_tuning(aff_model_t* model, int64_t tuned_hz, int correction_hz)
+{
+    aff_model_record_t* r = selected_record(model);
+    if (!r) return;
+    
+    if (r->tuned_hz != tuned_hz || r->correction_hz != correction_hz) {
+        r->tuned_hz = tuned_hz;
+        r->correction_hz = correction_hz;
+        model->dirty = true;
+    }
+}
+
+bool aff_model_get_tuning(aff_model_t* model, int64_t* tuned_hz, int* correction_hz)
+{
+    aff_model_record_t* r = selected_record(model);
+    if (!r || r->tuned_hz == 0) return false;
+    
+    if (tuned_hz) *tuned_hz = r->tuned_hz;
+    if (correction_hz) *correction_hz = r->correction_hz;
+    return true;
+}
+
+void aff_model_get_info(aff_model_t* model, aff_model_info_t* info)
+{
+    if (!info) return;
+    memset(info, 0, sizeof(*info));
+    
+    aff_model_record_t* r = selected_record(model);
+    if (!r) return;
+    
+    strncpy(info->key, r->key, AFF_MODEL_KEY_MAX - 1);
+    info->samples = r->samples;
+    
+    double t_mean, y_mean, slope, residual;
+    if (record_fit(r, &t_mean, &y_mean, &slope, &residual)) {
+        info->valid = aff_model_predict(model, (int64_t)time(NULL), &info->ppm, NULL);
+        info->aging_ppm_per_day = slope;
+        info->residual_ppm = residual;
+    }
+}
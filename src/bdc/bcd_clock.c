@@ -0,0 +1,407 @@
+/**
+ * @file bcd_clock.c
+ * @brief UTC Clock Disciplined by Decoded BCD Frames - Implementation
+ *
+ * Fixes are kept as (monotonic, UTC - monotonic) pairs. Wrong decodes are
+ * whole minutes off, so fixes further than BCD_CLOCK_OUTLIER_MS from the
+ * median offset are ignored; the rest are fitted with least squares for
+ * offset and drift.
+ */
+
+#include "bcd_clock.h"
+#include "../include/common.h"  /* For LOG_INFO etc */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
+/*============================================================================
+ * Internal Constants
+ *============================================================================*/
+
+#define NTP_SHM_BASE_KEY    0x4E545030  /* "NTP0" */
+#define LEAP_NOWARNING      0
+
+#if defined(_WIN32)
+#define SHM_BARRIER() MemoryBarrier()
+#else
+#define SHM_BARRIER() __sync_synchronize()
+#endif
+
+/* NTP SHM refclock segment (ntpd refclock_shm.c / chrony refclock_shm.c) */
+typedef struct {
+    int mode;                   /* 1 = use count to detect torn reads */
+    volatile int count;
+    time_t clock_sec;           /* Reference (UTC) time */
+    int clock_usec;
+    time_t receive_sec;         /* System clock at the same instant */
+    int receive_usec;
+    int leap;
+    int precision;
+    int nsamples;
+    volatile int valid;
+    unsigned clock_nsec;
+    unsigned receive_nsec;
+    int dummy[8];
+} ntp_shm_t;
+
+/* Fix: UTC at a monotonic instant */
+typedef struct {
+    uint64_t mono_ms;
+    int64_t offset_ms;          /* UTC - monotonic */
+} bcd_clock_fix_t;
+
+/*============================================================================
+ * Internal State Structure
+ *============================================================================*/
+
+struct bcd_clock {
+    /* Fix ring (newest at head) */
+    bcd_clock_fix_t fixes[BCD_CLOCK_MAX_FIXES];
+    int head;
+    int count;
+    int consecutive_rejects;
+    uint32_t fixes_rejected;
+    
+    /* Fit: utc = mono + ref_offset + slope * (mono - ref_mono) */
+    bool fitted;
+    uint64_t ref_mono_ms;
+    double ref_offset_ms;
+    double slope;
+    double residual_ms;
+    int fixes_used;
+    uint64_t last_fix_mono_ms;
+    
+    /* SHM refclock */
+    ntp_shm_t *shm;
+    int shm_unit;
+    uint64_t shm_last_ms;
+    uint32_t shm_samples;
+#ifdef _WIN32
+    HANDLE shm_mapping;
+#endif
+};
+
+/*============================================================================
+ * Internal Helpers
+ *============================================================================*/
+
+static int compare_int64(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a;
+    int64_t y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Refit offset and drift over the fixes consistent with the median
+ */
+static void refit(bcd_clock_t *clk) {
+    int64_t sorted[BCD_CLOCK_MAX_FIXES];
+    for (int i = 0; i < clk->count; i++) sorted[i] = clk->fixes[i].offset_ms;
+    qsort(sorted, clk->count, sizeof(int64_t), compare_int64);
+    int64_t median = sorted[clk->count / 2];
+    
+    const bcd_clock_fix_t *newest = &clk->fixes[clk->head];
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    double min_x = 0.0;
+    int n = 0;
+    for (int i = 0; i < clk->count; i++) {
+        const bcd_clock_fix_t *f = &clk->fixes[i];
+        if (llabs(f->offset_ms - median) > BCD_CLOCK_OUTLIER_MS) continue;
+        double x = (double)((int64_t)(f->mono_ms - newest->mono_ms));
+        double y = (double)(f->offset_ms - median);
+        sx += x; sy += y; sxx += x * x; sxy += x * y;
+        if (x < min_x) min_x = x;
+        n++;
+    }
+    
+    clk->fixes_used = n;
+    if (n < BCD_CLOCK_MIN_FIXES) {
+        clk->fitted = false;
+        return;
+    }
+    
+    /* Offset only until the window spans enough time to see drift */
+    double slope = 0.0;
+    double mean_x = sx / n, mean_y = sy / n;
+    double var_x = sxx / n - mean_x * mean_x;
+    if (-min_x >= BCD_CLOCK_MIN_SPAN_MS && var_x > 0.0) {
+        slope = (sxy / n - mean_x * mean_y) / var_x;
+        if (fabs(slope) * 1e6 > BCD_CLOCK_MAX_DRIFT_PPM) slope = 0.0;
+    }
+    double intercept = mean_y - slope * mean_x;
+    
+    double ss = 0.0;
+    for (int i = 0; i < clk->count; i++) {
+        const bcd_clock_fix_t *f = &clk->fixes[i];
+        if (llabs(f->offset_ms - median) > BCD_CLOCK_OUTLIER_MS) continue;
+        double x = (double)((int64_t)(f->mono_ms - newest->mono_ms));
+        double r = (double)(f->offset_ms - median) - (intercept + slope * x);
+        ss += r * r;
+    }
+    
+    clk->fitted = true;
+    clk->ref_mono_ms = newest->mono_ms;
+    clk->ref_offset_ms = (double)median + intercept;
+    clk->slope = slope;
+    clk->residual_ms = sqrt(ss / n);
+}
+
+static bool clock_valid(const bcd_clock_t *clk, uint64_t mono_ms) {
+    return clk->fitted &&
+           (int64_t)(mono_ms - clk->last_fix_mono_ms) <= BCD_CLOCK_HOLDOVER_MS;
+}
+
+/**
+ * System (realtime) clock in ns since 1970-01-01
+ */
+static int64_t system_time_ns(void) {
+#ifdef _WIN32
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    uint64_t t = ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return (int64_t)(t - 116444736000000000ULL) * 100;   /* 100 ns since 1601 */
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+/**
+ * Write one reference/receive sample pair (mode 1 protocol)
+ */
+static void shm_write_sample(bcd_clock_t *clk, uint64_t mono_ms) {
+    int64_t utc_ms;
+    if (!bcd_clock_get_utc(clk, mono_ms, &utc_ms)) return;
+    int64_t sys_ns = system_time_ns();
+    
+    ntp_shm_t *shm = clk->shm;
+    shm->valid = 0;
+    shm->count++;
+    SHM_BARRIER();
+    shm->mode = 1;
+    shm->clock_sec = (time_t)(utc_ms / 1000);
+    shm->clock_usec = (int)(utc_ms % 1000) * 1000;
+    shm->clock_nsec = (unsigned)(utc_ms % 1000) * 1000000u;
+    shm->receive_sec = (time_t)(sys_ns / 1000000000LL);
+    shm->receive_usec = (int)((sys_ns % 1000000000LL) / 1000);
+    shm->receive_nsec = (unsigned)(sys_ns % 1000000000LL);
+    shm->leap = LEAP_NOWARNING;
+    shm->precision = BCD_CLOCK_SHM_PRECISION;
+    shm->nsamples = 3;
+    SHM_BARRIER();
+    shm->count++;
+    shm->valid = 1;
+    
+    clk->shm_samples++;
+}
+
+static void shm_detach(bcd_clock_t *clk) {
+    if (!clk->shm) return;
+#ifdef _WIN32
+    UnmapViewOfFile(clk->shm);
+    CloseHandle(clk->shm_mapping);
+    clk->shm_mapping = NULL;
+#else
+    shmdt(clk->shm);
+#endif
+    clk->shm = NULL;
+    clk->shm_unit = -1;
+}
+
+/*============================================================================
+ * Public API Implementation
+ *============================================================================*/
+
+bcd_clock_t *bcd_clock_create(void) {
+    bcd_clock_t *clk = calloc(1, sizeof(bcd_clock_t));
+    if (!clk) return NULL;
+    
+    clk->shm_unit = -1;
+    return clk;
+}
+
+void bcd_clock_destroy(bcd_clock_t *clk) {
+    if (clk) {
+        shm_detach(clk);
+        free(clk);
+    }
+}
+
+void bcd_clock_reset(bcd_clock_t *clk) {
+    if (!clk) return;
+    clk->head = 0;
+    clk->count = 0;
+    clk->consecutive_rejects = 0;
+    clk->fitted = false;
+    clk->fixes_used = 0;
+}
+
+uint64_t bcd_clock_monotonic_ms(void) {
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+bool bcd_clock_add_fix(bcd_clock_t *clk, uint64_t mono_ms, int64_t utc_ms) {
+    if (!clk) return false;
+    
+    int64_t offset = utc_ms - (int64_t)mono_ms;
+    
+    /* Check against the current fit before it is influenced by this fix */
+    bool consistent = true;
+    double predicted = 0.0;
+    if (clk->fitted) {
+        predicted = clk->ref_offset_ms +
+                           clk->slope * (double)((int64_t)(mono_ms - clk->ref_mono_ms));
+        consistent = fabs((double)offset - predicted) <= BCD_CLOCK_OUTLIER_MS;
+    }
+    
+    clk->head = (clk->head + 1) % BCD_CLOCK_MAX_FIXES;
+    clk->fixes[clk->head].mono_ms = mono_ms;
+    clk->fixes[clk->head].offset_ms = offset;
+    if (clk->count < BCD_CLOCK_MAX_FIXES) clk->count++;
+    
+    if (consistent) {
+        clk->consecutive_rejects = 0;
+        clk->last_fix_mono_ms = mono_ms;
+    } else {
+        clk->fixes_rejected++;
+        clk->consecutive_rejects++;
+        LOG_WARN("[BCD] Clock fix %+.0f ms off the fit, ignored",
+                 (double)offset - predicted);
+    
+        /* Persistent disagreement: the old fixes are the wrong ones (e.g.
+         * host suspend stepped the monotonic clock). Keep only the recent. */
+        if (clk->consecutive_rejects > BCD_CLOCK_MIN_FIXES + 1) {
+            LOG_WARN("[BCD] Clock fit restarted after %d inconsistent fixes",
+                     clk->consecutive_rejects);
+            bcd_clock_fix_t recent[BCD_CLOCK_MAX_FIXES];
+            int keep = clk->consecutive_rejects;
+            for (int i = 0; i < keep; i++) {
+                recent[i] = clk->fixes[(clk->head - i + BCD_CLOCK_MAX_FIXES) % BCD_CLOCK_MAX_FIXES];
+            }
+            bcd_clock_reset(clk);
+            for (int i = keep - 1; i >= 0; i--) {
+                clk->head = (clk->head + 1) % BCD_CLOCK_MAX_FIXES;
+                clk->fixes[clk->head] = recent[i];
+                clk->count++;
+            }
+            clk->last_fix_mono_ms = mono_ms;
+        }
+    }
+    
+    bool was_fitted = clk->fitted;
+    refit(clk);
+    if (clk->fitted && !was_fitted) {
+        LOG_INFO("[BCD] Clock disciplined from %d fixes (rms %.1f ms)",
+                 clk->fixes_used, clk->residual_ms);
+    }
+    return consistent;
+}
+
+bool bcd_clock_get_utc(bcd_clock_t *clk, uint64_t mono_ms, int64_t *utc_ms_out) {
+    if (!clk || !utc_ms_out || !clock_valid(clk, mono_ms)) return false;
+    
+    double dt = (double)((int64_t)(mono_ms - clk->ref_mono_ms));
+    double offset = clk->ref_offset_ms + clk->slope * dt;
+    *utc_ms_out = (int64_t)mono_ms + (int64_t)floor(offset + 0.5);
+    return true;
+}
+
+bool bcd_clock_now_utc(bcd_clock_t *clk, int64_t *utc_ms_out) {
+    return bcd_clock_get_utc(clk, bcd_clock_monotonic_ms(), utc_ms_out);
+}
+
+bool bcd_clock_enable_shm(bcd_clock_t *clk, int unit) {
+    if (!clk || unit < 0 || unit > 255) return false;
+    shm_detach(clk);
+    
+#ifdef _WIN32
+    char name[32];
+    snprintf(name, sizeof(name), "Global\\NTP%d", unit);
+    clk->shm_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                          0, sizeof(ntp_shm_t), name);
+    if (!clk->shm_mapping) {
+        /* Global namespace needs privileges; fall back to session-local */
+        snprintf(name, sizeof(name), "NTP%d", unit);
+        clk->shm_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                              0, sizeof(ntp_shm_t), name);
+    }
+    if (!clk->shm_mapping) {
+        LOG_ERROR("[BCD] SHM refclock: CreateFileMapping(%s) failed: %lu",
+                  name, (unsigned long)GetLastError());
+        return false;
+    }
+    clk->shm = (ntp_shm_t *)MapViewOfFile(clk->shm_mapping, FILE_MAP_ALL_ACCESS,
+                                          0, 0, sizeof(ntp_shm_t));
+    if (!clk->shm) {
+        LOG_ERROR("[BCD] SHM refclock: MapViewOfFile failed: %lu",
+                  (unsigned long)GetLastError());
+        CloseHandle(clk->shm_mapping);
+        clk->shm_mapping = NULL;
+        return false;
+    }
+#else
+    int perm = (unit < 2) ? 0600 : 0666;
+    int id = shmget((key_t)(NTP_SHM_BASE_KEY + unit), sizeof(ntp_shm_t), IPC_CREAT | perm);
+    if (id < 0) {
+        LOG_ERROR("[BCD] SHM refclock: shmget(unit %d) failed", unit);
+        return false;
+    }
+    void *p = shmat(id, NULL, 0);
+    if (p == (void *)-1) {
+        LOG_ERROR("[BCD] SHM refclock: shmat(unit %d) failed", unit);
+        return false;
+    }
+    clk->shm = (ntp_shm_t *)p;
+#endif
+    
+    clk->shm_unit = unit;
+    clk->shm->valid = 0;
+    LOG_INFO("[BCD] Publishing time to NTP SHM unit %d", unit);
+    return true;
+}
+
+void bcd_clock_poll(bcd_clock_t *clk) {
+    if (!clk || !clk->shm) return;
+    
+    uint64_t now = bcd_clock_monotonic_ms();
+    if (now - clk->shm_last_ms < BCD_CLOCK_SHM_INTERVAL_MS) return;
+    clk->shm_last_ms = now;
+    
+    if (clock_valid(clk, now)) {
+        shm_write_sample(clk, now);
+    }
+}
+
+void bcd_clock_get_status(bcd_clock_t *clk, bcd_clock_status_t *status) {
+    if (!status) return;
+    memset(status, 0, sizeof(*status));
+    status->shm_unit = -1;
+    if (!clk) return;
+    
+    uint64_t now = bcd_clock_monotonic_ms();
+    status->valid = clock_valid(clk, now);
+    status->fixes = clk->count;
+    status->fixes_used = clk->fixes_used;
+    status->fixes_rejected = clk->fixes_rejected;
+    status->drift_ppm = -clk->slope * 1e6;
+    status->residual_ms = clk->residual_ms;
+    status->last_fix_age_ms = clk->count > 0 ? now - clk->last_fix_mono_ms : 0;
+    status->shm_unit = clk->shm_unit;
+    status->shm_samples = clk->shm_samples;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file bcd_clock.h
+ * @brief UTC Clock Disciplined by Decoded BCD Frames
+ *
+ * Each decoded frame gives a fix: the monotonic time of its second 0 and
+ * the UTC minute it carries. A drift-corrected linear fit over recent
+ * fixes maps the local monotonic clock to UTC, so time can be served at
+ * sub-frame resolution between (and for a while without) decodes.
+ *
+ * Optionally publishes samples to an NTP/chrony SHM refclock segment
+ * (ntpd driver 28 layout, key 0x4E545030 + unit).
+ */
+
+#ifndef BCD_CLOCK_H
+#define BCD_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#define BCD_CLOCK_MAX_FIXES         60      /* Fixes in fit window (~1 hour) */
+#define BCD_CLOCK_MIN_FIXES         3       /* Consistent fixes before serving time */
+#define BCD_CLOCK_OUTLIER_MS        500     /* Max deviation from median offset */
+#define BCD_CLOCK_MIN_SPAN_MS       600000  /* Fit drift only over >= 10 minutes */
+#define BCD_CLOCK_MAX_DRIFT_PPM     500.0   /* Larger fitted drift is rejected */
+#define BCD_CLOCK_HOLDOVER_MS       7200000 /* Serve time up to 2 h after last fix */
+#define BCD_CLOCK_SHM_INTERVAL_MS   1000    /* SHM sample period */
+#define BCD_CLOCK_SHM_PRECISION     -7      /* log2 seconds (~8 ms) */
+
+/*============================================================================
+ * Types
+ *============================================================================*/
+
+/** Clock discipline status */
+typedef struct {
+    bool valid;                 /* Fit usable and within holdover */
+    int fixes;                  /* Fixes in window */
+    int fixes_used;             /* Consistent fixes in fit */
+    uint32_t fixes_rejected;    /* Fixes off the fit since create */
+    double drift_ppm;           /* Local clock rate error (+ = local fast) */
+    double residual_ms;         /* RMS residual of the fit */
+    uint64_t last_fix_age_ms;   /* Time since newest fix */
+    int shm_unit;               /* SHM unit, or -1 if not publishing */
+    uint32_t shm_samples;       /* Samples written to SHM */
+} bcd_clock_status_t;
+
+/** Opaque clock state */
+typedef struct bcd_clock bcd_clock_t;
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+/**
+ * Create disciplined clock
+ */
+bcd_clock_t *bcd_clock_create(void);
+
+/**
+ * Destroy disciplined clock (detaches SHM segment)
+ */
+void bcd_clock_destroy(bcd_clock_t *clk);
+
+/**
+ * Discard all fixes
+ */
+void bcd_clock_reset(bcd_clock_t *clk);
+
+/**
+ * Monotonic milliseconds used for all fixes and queries
+ */
+uint64_t bcd_clock_monotonic_ms(void);
+
+/**
+ * Add a fix: UTC at a monotonic instant
+ *
+ * @param clk               Clock instance
+ * @param mono_ms           Monotonic ms (bcd_clock_monotonic_ms domain)
+ * @param utc_ms            UTC ms since 1970-01-01
+ * @return true if consistent with the fit (false = rejected as outlier)
+ */
+bool bcd_clock_add_fix(bcd_clock_t *clk, uint64_t mono_ms, int64_t utc_ms);
+
+/**
+ * Map a monotonic instant to UTC
+ *
+ * @return false if the clock is not disciplined (or holdover expired)
+ */
+bool bcd_clock_get_utc(bcd_clock_t *clk, uint64_t mono_ms, int64_t *utc_ms_out);
+
+/**
+ * Current UTC
+ *
+ * @return false if the clock is not disciplined (or holdover expired)
+ */
+bool bcd_clock_now_utc(bcd_clock_t *clk, int64_t *utc_ms_out);
+
+/**
+ * Publish to an NTP/chrony SHM refclock segment
+ *
+ * Units 0-1 are created owner-only (ntpd running as root); 2+ are world
+ * writable, as chrony and ntpd expect. Call bcd_clock_poll() regularly.
+ *
+ * @param unit              SHM unit (0-255)
+ * @return true if the segment is attached
+ */
+bool bcd_clock_enable_shm(bcd_clock_t *clk, int unit);
+
+/**
+ * Periodic task: write a SHM sample every BCD_CLOCK_SHM_INTERVAL_MS
+ * while the clock is valid
+ */
+void bcd_clock_poll(bcd_clock_t *clk);
+
+/**
+ * Get discipline status
+ */
+void bcd_clock_get_status(bcd_clock_t *clk, bcd_clock_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BCD_CLOCK_H */
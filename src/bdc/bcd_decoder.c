@@ -13,15 +13,87 @@
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
+#include <time.h>
 
 /*============================================================================
  * Internal Constants
  *============================================================================*/
 
-/* Position marker seconds within frame */
-static const int P_MARKER_POSITIONS[] = {0, 9, 19, 29, 39, 49, 59};
+/* Position marker seconds within frame: 0, 9, 19, 29, 39, 49, 59 */
 #define NUM_P_MARKERS 7
 
+/* Frame bitmasks: bit N = frame second N */
+#define FRAME_BIT(pos) (1ULL << (pos))
+
+#define P_MARKER_MASK   (FRAME_BIT(0) | FRAME_BIT(9) | FRAME_BIT(19) | FRAME_BIT(29) | \
+                         FRAME_BIT(39) | FRAME_BIT(49) | FRAME_BIT(59))
+#define MINUTES_MASK    (0xFFULL << 1)                          /* Seconds 1-8 */
+#define HOURS_MASK      (0x7FULL << 12)                         /* Seconds 12-18 */
+#define DOY_MASK        ((0x7FULL << 22) | (0xFULL << 30))      /* Seconds 22-28, 30-33 */
+#define YEAR_MASK       (0xFFULL << 51)                         /* Seconds 51-58 */
+#define TIME_FIELDS_MASK (MINUTES_MASK | HOURS_MASK | DOY_MASK)
+
+/* Number of symbol classes with a likelihood (ZERO, ONE, MARKER) */
+#define NUM_SYMBOL_CLASSES 3
+
+/* BCD time code fields: frame positions and bit weights (0 = unused bit) */
+typedef struct {
+    const char *name;
+    const int *positions;
+    const int *weights;
+    int count;
+    int min_value;
+    int max_value;
+    uint64_t mask;
+} bcd_field_t;
+
+static const int MIN_POSITIONS[] = {1, 2, 3, 4, 5, 6, 7, 8};
+static const int MIN_WEIGHTS[]   = {40, 20, 10, 0, 8, 4, 2, 1};
+static const int HOUR_POSITIONS[] = {12, 13, 14, 15, 16, 17, 18};
+static const int HOUR_WEIGHTS[]   = {20, 10, 0, 8, 4, 2, 1};
+static const int DOY_POSITIONS[] = {22, 23, 24, 25, 26, 27, 28, 30, 31, 32, 33};
+static const int DOY_WEIGHTS[]   = {200, 100, 0, 80, 40, 20, 10, 8, 4, 2, 1};
+static const int YEAR_POSITIONS[] = {51, 52, 53, 54, 55, 56, 57, 58};
+static const int YEAR_WEIGHTS[]   = {80, 40, 20, 10, 8, 4, 2, 1};
+
+static const bcd_field_t FIELD_MINUTES = {"minutes", MIN_POSITIONS, MIN_WEIGHTS, 8, 0, 59, MINUTES_MASK};
+static const bcd_field_t FIELD_HOURS = {"hours", HOUR_POSITIONS, HOUR_WEIGHTS, 7, 0, 23, HOURS_MASK};
+static const bcd_field_t FIELD_DOY = {"day", DOY_POSITIONS, DOY_WEIGHTS, 11, 1, 366, DOY_MASK};
+static const bcd_field_t FIELD_YEAR = {"year", YEAR_POSITIONS, YEAR_WEIGHTS, 8, 0, 99, YEAR_MASK};
+
+#define MINUTES_PER_DAY 1440
+
+/* Phase search shift registers: bit N = symbol N seconds ago */
+#define PHASE_WORDS 2
+
+/*
+ * Frame as bitmasks of the most likely symbol per second, plus the soft
+ * ONE-vs-ZERO log-likelihood ratio per second for soft/multi-frame decoding
+ */
+typedef struct {
+    uint64_t ones;                  /* ONE most likely */
+    uint64_t markers;               /* P most likely */
+    uint64_t filled;                /* Symbol received */
+    uint64_t strong;                /* |llr| >= BCD_STRONG_LLR */
+    float llr[BCD_FRAME_LENGTH];    /* log P(ONE)/P(ZERO), 0 = no info */
+} bcd_frame_bits_t;
+
+/* Integration history entry */
+typedef struct {
+    bool valid;                     /* Frame passed marker check */
+    uint64_t epoch_ms;              /* Monotonic time of second 0, 0 = untimed */
+    int minute;                     /* Minutes since the history started */
+    bcd_frame_bits_t bits;
+} bcd_history_entry_t;
+
+/* Per-frame field log-likelihood tables (integration workspace) */
+typedef struct {
+    float minutes[60];
+    float hours[24];
+    float doy[366];                 /* Index = day_of_year - 1 */
+    float year[100];
+} bcd_frame_scores_t;
+
 /*============================================================================
  * Internal State Structure
  *============================================================================*/
@@ -33,21 +105,51 @@ struct bcd_decoder {
     int last_frame_position;        /* Previous position for wrap detection */
     
     /* Frame buffer */
-    bcd_symbol_t frame[BCD_FRAME_LENGTH];
-    int symbols_in_frame;
-    int p_markers_in_frame;
+    bcd_frame_bits_t frame;
+    float width_var;                /* Pulse width variance, estimated at P markers */
     
     /* Last symbol info */
     bcd_symbol_t last_symbol;
     float last_symbol_width_ms;
     float last_symbol_confidence;
     
+    /* Multi-frame integration (newest at history_head) */
+    bcd_history_entry_t history[BCD_INTEGRATION_MAX_FRAMES];
+    bcd_frame_scores_t scores[BCD_INTEGRATION_MAX_FRAMES];
+    int history_head;
+    int history_count;
+    int integration_frames;
+    uint64_t prior_epoch_ms;        /* Second 0 of the last integrated decode, 0 = none */
+    int prior_minute;               /* Its minute of the year, (day - 1) * 1440 + minute */
+    
     /* Sync tracking */
     sync_state_t last_sync_state;
     
+    /* Phase search (newest symbol at bit 0) */
+    bool phase_search;
+    bool phase_locked;
+    uint64_t phase_markers[PHASE_WORDS];
+    uint64_t phase_filled[PHASE_WORDS];
+    uint64_t phase_templates[BCD_FRAME_LENGTH][PHASE_WORDS];
+    uint64_t phase_last_start_ms;   /* Second boundary of newest symbol */
+    bool phase_have_last;
+    int phase_second;               /* Frame second of newest symbol, or -1 */
+    int phase_score;
+    int phase_offset;               /* phase_second - modem second */
+    
     /* Decoded time */
     bcd_time_t last_time;
     
+    /* Modem symbol quality against decoded frames */
+    bcd_stats_t *stats;
+    
+    /* Frame timing: monotonic time of second 0, averaged over symbols */
+    uint64_t frame_epoch_ref;       /* First estimate this frame */
+    double frame_epoch_sum;         /* Sum of deviations from ref */
+    int frame_epoch_count;
+    int last_full_year;             /* Last unambiguous year (e.g. 2026), 0 = none */
+    bcd_clock_t *clock;             /* Local-to-UTC discipline */
+    
     /* Statistics */
     uint32_t frames_decoded;
     uint32_t frames_failed;
@@ -70,151 +172,546 @@ static bcd_symbol_t char_to_symbol(char c) {
     }
 }
 
+/**
+ * Count set bits in a 64-bit mask
+ */
+static inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
 /**
  * Check if a position is a P marker location
  */
-static bool is_p_marker_position(int pos) {
-    for (int i = 0; i < NUM_P_MARKERS; i++) {
-        if (P_MARKER_POSITIONS[i] == pos) return true;
+static inline bool is_p_marker_position(int pos) {
+    return (P_MARKER_MASK & FRAME_BIT(pos)) != 0;
+}
+
+/**
+ * Convert symbol, width and confidence to normalised log-likelihoods
+ * for ZERO/ONE/MARKER at one frame position
+ */
+static void symbol_likelihoods(bcd_symbol_t symbol, float width_ms, float confidence,
+                               float width_var, float ll_out[NUM_SYMBOL_CLASSES]) {
+    static const float nominal[NUM_SYMBOL_CLASSES] = {
+        BCD_WIDTH_ZERO_MS, BCD_WIDTH_ONE_MS, BCD_WIDTH_MARKER_MS
+    };
+    
+    /* Modem's hard decision is right with probability ~confidence. The
+     * modem derives its label from the same pulse width, so when the width
+     * is known it only contributes a weak prior (avoids double counting). */
+    float conf = confidence;
+    if (conf < 0.34f) conf = 0.34f;
+    if (conf > 0.99f) conf = 0.99f;
+    float label_weight = (width_ms > 0.0f) ? BCD_SOFT_LABEL_WEIGHT : 1.0f;
+    
+    float max_ll = -1e30f;
+    for (int k = 0; k < NUM_SYMBOL_CLASSES; k++) {
+        float ll = label_weight * logf(k == (int)symbol ? conf : (1.0f - conf) * 0.5f);
+        
+        /* Measured pulse width, when present */
+        if (width_ms > 0.0f) {
+            float d = width_ms - nominal[k];
+            ll -= 0.5f * d * d / width_var;
+        }
+        ll_out[k] = ll;
+        if (ll > max_ll) max_ll = ll;
+    }
+    
+    /* Normalise (log-sum-exp) so positions are comparable */
+    float sum = 0.0f;
+    for (int k = 0; k < NUM_SYMBOL_CLASSES; k++) {
+        sum += expf(ll_out[k] - max_ll);
+    }
+    float norm = max_ll + logf(sum);
+    for (int k = 0; k < NUM_SYMBOL_CLASSES; k++) {
+        ll_out[k] -= norm;
     }
-    return false;
 }
 
 /**
- * Decode BCD value from symbol array
+ * Log-likelihood of a field holding a given value
+ *
+ * Relative to all field bits being ZERO, which is the same offset for
+ * every candidate value and so does not change the ranking or odds.
  */
-static int decode_bcd_field(bcd_symbol_t *symbols, const int *weights, int count) {
-    int value = 0;
-    for (int i = 0; i < count; i++) {
-        if (symbols[i] == BCD_SYMBOL_ONE) {
-            value += weights[i];
-        } else if (symbols[i] != BCD_SYMBOL_ZERO) {
-            return -1;  /* Invalid symbol in data position */
+static float score_field_value(const float *llr, const bcd_field_t *field, int value) {
+    float score = 0.0f;
+    for (int i = 0; i < field->count; i++) {
+        int w = field->weights[i];
+        if (w != 0 && value >= w) {
+            score += llr[field->positions[i]];
+            value -= w;
         }
     }
-    return value;
+    /* Value not representable in this field's BCD digits */
+    if (value != 0) return -1e30f;
+    return score;
 }
 
 /**
- * Decode a complete frame into time values
+ * Pick the most likely valid value of a field
+ *
+ * Only values within the field's range (which implies valid BCD digits)
+ * are considered. Returns the best value and its log-odds against all
+ * other valid values combined.
  */
-static bool decode_frame(bcd_decoder_t *dec, bcd_time_t *time_out,
-                         bcd_frame_quality_t *quality_out) {
-    bcd_symbol_t *f = dec->frame;
+static int decode_field_soft(const float *llr, const bcd_field_t *field, float *margin_out) {
+    float scores[400];              /* Largest range: day of year 1-366 */
+    int n = field->max_value - field->min_value + 1;
+    int best_value = -1;
+    float best = -1e30f;
     
-    /* Count position markers */
-    int markers_found = 0;
-    int markers_correct = 0;
-    for (int i = 0; i < NUM_P_MARKERS; i++) {
-        int pos = P_MARKER_POSITIONS[i];
-        if (f[pos] == BCD_SYMBOL_MARKER) {
-            markers_found++;
-            markers_correct++;
+    for (int i = 0; i < n; i++) {
+        scores[i] = score_field_value(llr, field, field->min_value + i);
+        if (scores[i] > best) {
+            best = scores[i];
+            best_value = field->min_value + i;
         }
     }
     
-    /* Also count P markers at wrong positions */
+    /* log(sum of exp(others - best)) */
+    float others = 0.0f;
+    for (int i = 0; i < n; i++) {
+        if (field->min_value + i != best_value) {
+            others += expf(scores[i] - best);
+        }
+    }
+    
+    if (margin_out) *margin_out = (others > 0.0f) ? -logf(others) : 99.0f;
+    return best_value;
+}
+
+/**
+ * Extract a field from the ONE mask; -1 if the bits are not valid BCD
+ * digits for this field (re-encoding must give back the same bits)
+ */
+static int decode_field_hard(uint64_t ones, const bcd_field_t *field) {
+    int value = 0;
+    for (int i = 0; i < field->count; i++) {
+        if (ones & FRAME_BIT(field->positions[i])) value += field->weights[i];
+    }
+    if (value < field->min_value || value > field->max_value) return -1;
+    
+    uint64_t encoded = 0;
+    int rest = value;
+    for (int i = 0; i < field->count; i++) {
+        int w = field->weights[i];
+        if (w != 0 && rest >= w) {
+            encoded |= FRAME_BIT(field->positions[i]);
+            rest -= w;
+        }
+    }
+    return (encoded == (ones & field->mask)) ? value : -1;
+}
+
+/**
+ * Approximate log-odds of a hard-decoded field: every single-bit
+ * alternative weighed by its soft likelihood ratio
+ */
+static float hard_field_log_odds(const bcd_frame_bits_t *f, uint64_t mask) {
+    float others = 0.0f;
+    for (int pos = 0; pos < BCD_FRAME_LENGTH; pos++) {
+        if (mask & FRAME_BIT(pos)) others += expf(-fabsf(f->llr[pos]));
+    }
+    return (others > 0.0f) ? -logf(others) : 99.0f;
+}
+
+/**
+ * Fast path: decode the time fields straight from the masks when every
+ * time bit was received, unambiguous and valid BCD; false otherwise
+ */
+static bool decode_time_hard(const bcd_frame_bits_t *f, int *minutes, int *hours,
+                             int *day_of_year, float *m_min, float *m_hour, float *m_doy) {
+    uint64_t clean = f->filled & f->strong & ~f->markers;
+    if ((clean & TIME_FIELDS_MASK) != TIME_FIELDS_MASK) return false;
+    
+    *minutes = decode_field_hard(f->ones, &FIELD_MINUTES);
+    *hours = decode_field_hard(f->ones, &FIELD_HOURS);
+    *day_of_year = decode_field_hard(f->ones, &FIELD_DOY);
+    if (*minutes < 0 || *hours < 0 || *day_of_year < 0) return false;
+    
+    *m_min = hard_field_log_odds(f, MINUTES_MASK);
+    *m_hour = hard_field_log_odds(f, HOURS_MASK);
+    *m_doy = hard_field_log_odds(f, DOY_MASK);
+    return true;
+}
+
+/**
+ * Dump the hard-decision frame for diagnosis
+ */
+static void log_frame(const bcd_decoder_t *dec) {
+    const bcd_frame_bits_t *f = &dec->frame;
+    char frame_str[180];
+    char* p = frame_str;
     for (int i = 0; i < BCD_FRAME_LENGTH; i++) {
-        if (f[i] == BCD_SYMBOL_MARKER && !is_p_marker_position(i)) {
-            markers_found++;
+        uint64_t bit = FRAME_BIT(i);
+        if (i > 0 && i % 10 == 0) *p++ = ' ';
+        if (!(f->filled & bit))      *p++ = '.';
+        else if (f->markers & bit)   *p++ = 'P';
+        else if (f->ones & bit)      *p++ = '1';
+        else                         *p++ = '0';
+    }
+    *p = '\0';
+    LOG_INFO("[BCD] Frame: %s", frame_str);
+}
+
+/**
+ * Monotonic time of this frame's second 0, or 0 if no symbol was timed
+ */
+static uint64_t frame_epoch_ms(const bcd_decoder_t *dec) {
+    if (dec->frame_epoch_count == 0) return 0;
+    double mean = dec->frame_epoch_sum / dec->frame_epoch_count;
+    return dec->frame_epoch_ref + (int64_t)floor(mean + 0.5);
+}
+
+static void clear_frame_history(bcd_decoder_t *dec) {
+    dec->history_head = 0;
+    dec->history_count = 0;
+}
+
+/**
+ * Push the current frame into the integration history
+ *
+ * Frames are placed by their timing: missed minutes leave a gap in the
+ * minute count, and a gap the history cannot span (or a repeated minute)
+ * starts the history over. Untimed frames are taken as the next minute.
+ */
+static void push_frame_history(bcd_decoder_t *dec, bool valid) {
+    uint64_t epoch = frame_epoch_ms(dec);
+    int minute = 0;
+    
+    if (dec->history_count > 0) {
+        const bcd_history_entry_t *prev = &dec->history[dec->history_head];
+        int step = 1;
+        if (epoch != 0 && prev->epoch_ms != 0) {
+            int64_t dt = (int64_t)(epoch - prev->epoch_ms);
+            step = (int)((dt + (dt >= 0 ? 30000 : -30000)) / 60000);
+        }
+        if (step < 1 || step >= BCD_INTEGRATION_MAX_FRAMES) {
+            LOG_INFO("[BCD] %d min since last frame, restarting integration", step);
+            clear_frame_history(dec);
+        } else {
+            minute = prev->minute + step;
         }
     }
     
-    if (quality_out) {
-        quality_out->symbols_received = dec->symbols_in_frame;
-        quality_out->markers_found = markers_found;
-        quality_out->markers_correct = markers_correct;
-        quality_out->frame_coverage = (float)dec->symbols_in_frame / BCD_FRAME_LENGTH * 100.0f;
+    dec->history_head = (dec->history_head + 1) % BCD_INTEGRATION_MAX_FRAMES;
+    if (dec->history_count < BCD_INTEGRATION_MAX_FRAMES) dec->history_count++;
+    
+    bcd_history_entry_t *h = &dec->history[dec->history_head];
+    h->valid = valid;  /* Invalid frames keep the minute progression only */
+    h->epoch_ms = epoch;
+    h->minute = minute;
+    h->bits = dec->frame;
+}
+
+/**
+ * Score every value of every field for one history frame
+ */
+static void score_frame(const bcd_frame_bits_t *f, bcd_frame_scores_t *out) {
+    for (int v = 0; v < 60; v++) out->minutes[v] = score_field_value(f->llr, &FIELD_MINUTES, v);
+    for (int v = 0; v < 24; v++) out->hours[v] = score_field_value(f->llr, &FIELD_HOURS, v);
+    for (int v = 0; v < 366; v++) out->doy[v] = score_field_value(f->llr, &FIELD_DOY, v + 1);
+    for (int v = 0; v < 100; v++) out->year[v] = score_field_value(f->llr, &FIELD_YEAR, v);
+}
+
+/* Running best and log-sum-exp over candidate times */
+typedef struct {
+    float best;
+    float sum;                      /* Sum of exp(score - best) */
+    int mod;
+    int doy;
+} bcd_search_t;
+
+/**
+ * Log-likelihood of the newest frame starting at minute mod of day doy
+ */
+static float score_candidate(const bcd_frame_scores_t **frames, const int *offsets,
+                             int n, int doy, int mod) {
+    float score = 0.0f;
+    for (int i = 0; i < n; i++) {
+        int m = mod - offsets[i];
+        int d = doy;
+        if (m < 0) {
+            m += MINUTES_PER_DAY;
+            d = (doy > 1) ? doy - 1 : 365;
+        }
+        score += frames[i]->minutes[m % 60] + frames[i]->hours[m / 60] +
+                 frames[i]->doy[d - 1];
     }
+    return score;
+}
+
+/* Add one candidate time */
+static void search_add(bcd_search_t *s, float score, int doy, int mod) {
+    if (score > s->best) {
+        s->sum = s->sum * expf(s->best - score) + 1.0f;
+        s->best = score;
+        s->mod = mod;
+        s->doy = doy;
+    } else {
+        s->sum += expf(score - s->best);
+    }
+}
+
+static float search_log_odds(const bcd_search_t *s) {
+    float others = s->sum - 1.0f;
+    return (others > 0.0f) ? -logf(others) : 99.0f;
+}
+
+/**
+ * Find the most likely time of the newest frame given the last N minutes
+ *
+ * A frame k minutes back is scored at candidate - k minutes. Candidates
+ * are the minutes near the time the last decode implies, or every minute
+ * of the year without one (or when that is ambiguous). Returns false if
+ * no frame in the window had evidence. Day rollover before day 1 assumes
+ * a 365-day previous year.
+ */
+static bool decode_integrated(bcd_decoder_t *dec, int *minute_of_day_out,
+                              int *doy_out, int *year_out, float *log_odds_out,
+                              int *frames_out) {
+    const bcd_frame_scores_t *frames[BCD_INTEGRATION_MAX_FRAMES];
+    int offsets[BCD_INTEGRATION_MAX_FRAMES];
+    int n = 0;
     
-    /* Need at least 5 of 7 P markers at correct positions */
-    if (markers_correct < 5) {
-        LOG_WARN("[BCD] Frame decode failed: only %d/%d P markers correct (found %d total)",
-               markers_correct, NUM_P_MARKERS, markers_found);
-        
-        /* Dump frame for diagnosis */
-        char frame_str[180];
-        char* p = frame_str;
-        for (int i = 0; i < BCD_FRAME_LENGTH; i++) {
-            if (i > 0 && i % 10 == 0) *p++ = ' ';
-            switch (f[i]) {
-                case BCD_SYMBOL_ZERO:   *p++ = '0'; break;
-                case BCD_SYMBOL_ONE:    *p++ = '1'; break;
-                case BCD_SYMBOL_MARKER: *p++ = 'P'; break;
-                default:                *p++ = '.'; break;
+    const bcd_history_entry_t *newest = &dec->history[dec->history_head];
+    for (int k = 0; k < dec->history_count; k++) {
+        int idx = (dec->history_head - k + BCD_INTEGRATION_MAX_FRAMES) % BCD_INTEGRATION_MAX_FRAMES;
+        int offset = newest->minute - dec->history[idx].minute;
+        if (offset >= dec->integration_frames) break;
+        if (dec->history[idx].valid) {
+            score_frame(&dec->history[idx].bits, &dec->scores[n]);
+            frames[n] = &dec->scores[n];
+            offsets[n] = offset;
+            n++;
+        }
+    }
+    if (n == 0) return false;
+    
+    bcd_search_t search = {-1e30f, 0.0f, 0, 1};
+    float log_odds = 0.0f;
+    bool searched = false;
+    
+    /* Tracking: the last decode plus elapsed minutes, give or take a few */
+    if (dec->prior_epoch_ms != 0 && newest->epoch_ms != 0) {
+        int64_t dt = (int64_t)(newest->epoch_ms - dec->prior_epoch_ms);
+        if (dt >= 0 && dt <= BCD_INTEGRATION_PRIOR_MAX_MS) {
+            int expected = dec->prior_minute + (int)((dt + 30000) / 60000);
+            for (int delta = -BCD_INTEGRATION_SEARCH_MINUTES;
+                 delta <= BCD_INTEGRATION_SEARCH_MINUTES; delta++) {
+                int c = expected + delta;
+                if (c < 0) c += 365 * MINUTES_PER_DAY;
+                c %= 366 * MINUTES_PER_DAY;
+                int doy = c / MINUTES_PER_DAY + 1;
+                int mod = c % MINUTES_PER_DAY;
+                search_add(&search, score_candidate(frames, offsets, n, doy, mod), doy, mod);
+            }
+            log_odds = search_log_odds(&search);
+            searched = log_odds >= BCD_INTEGRATION_MIN_LOG_ODDS;
+            if (!searched) {
+                LOG_DEBUG("[BCD] Ambiguous near expected time (%.1f), searching the year",
+                          log_odds);
+                search = (bcd_search_t){-1e30f, 0.0f, 0, 1};
             }
         }
-        *p = '\0';
-        LOG_INFO("[BCD] Frame: %s", frame_str);
-        LOG_INFO("[BCD] Expect P at: 0,9,19,29,39,49,59");
-        
-        /* Show where P markers actually are */
-        char p_pos_str[64] = "P found at:";
-        for (int i = 0; i < BCD_FRAME_LENGTH; i++) {
-            if (f[i] == BCD_SYMBOL_MARKER) {
-                char tmp[8];
-                snprintf(tmp, sizeof(tmp), " %d", i);
-                strcat(p_pos_str, tmp);
+    }
+    
+    /* Acquisition: every minute of the year */
+    if (!searched) {
+        for (int doy = 1; doy <= 366; doy++) {
+            for (int mod = 0; mod < MINUTES_PER_DAY; mod++) {
+                search_add(&search, score_candidate(frames, offsets, n, doy, mod), doy, mod);
             }
         }
-        LOG_INFO("[BCD] %s", p_pos_str);
-        
-        return false;
+        log_odds = search_log_odds(&search);
     }
     
-    /* Decode minutes: seconds 1-8 */
-    static const int min_weights[] = {40, 20, 10, 0, 8, 4, 2, 1};
-    int minutes = decode_bcd_field(&f[1], min_weights, 8);
-    if (minutes < 0 || minutes > 59) {
-        LOG_WARN("[BCD] Invalid minutes: %d (fields 1-8: %d%d%d%d %d%d%d%d)",
-                minutes, f[1], f[2], f[3], f[4], f[5], f[6], f[7], f[8]);
-        return false;
+    *log_odds_out = log_odds;
+    *minute_of_day_out = search.mod;
+    *doy_out = search.doy;
+    *frames_out = n;
+    
+    /* Year changes at most once in the window; combine as constant */
+    int best_year = -1;
+    float year_best = -1e30f;
+    float year_sum = 0.0f;
+    for (int y = 0; y < 100; y++) {
+        float score = 0.0f;
+        for (int i = 0; i < n; i++) score += frames[i]->year[y];
+        if (score > year_best) {
+            year_sum = year_sum * expf(year_best - score) + 1.0f;
+            year_best = score;
+            best_year = y;
+        } else {
+            year_sum += expf(score - year_best);
+        }
     }
+    float year_others = year_sum - 1.0f;
+    float year_odds = (year_others > 0.0f) ? -logf(year_others) : 99.0f;
+    *year_out = (year_odds >= BCD_SOFT_MIN_MARGIN) ? best_year : -1;
     
-    /* Decode hours: seconds 12-18 */
-    static const int hour_weights[] = {20, 10, 0, 8, 4, 2, 1};
-    int hours = decode_bcd_field(&f[12], hour_weights, 7);
-    if (hours < 0 || hours > 23) {
-        LOG_WARN("[BCD] Invalid hours: %d (fields 12-18: %d%d%d %d%d%d%d)",
-                hours, f[12], f[13], f[14], f[15], f[16], f[17], f[18]);
-        return false;
+    return true;
+}
+
+/**
+ * UTC ms since 1970 at the start of a decoded minute
+ *
+ * The 2-digit year is used when unambiguous, else the last one seen,
+ * else the host's year.
+ */
+static bool time_to_utc_ms(bcd_decoder_t *dec, const bcd_time_t *t, int64_t *utc_ms_out) {
+    int year;
+    if (t->year >= 0) {
+        year = 2000 + t->year;
+        dec->last_full_year = year;
+    } else if (dec->last_full_year > 0) {
+        year = dec->last_full_year;
+    } else {
+        time_t now = time(NULL);
+        struct tm *utc = gmtime(&now);
+        if (!utc) return false;
+        year = 1900 + utc->tm_year;
     }
     
-    /* Decode day of year: seconds 22-28 (hundreds/tens), 30-33 (units) */
-    static const int doy_ht_weights[] = {200, 100, 0, 80, 40, 20, 10};
-    int doy_ht = decode_bcd_field(&f[22], doy_ht_weights, 7);
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (t->day_of_year > (leap ? 366 : 365)) return false;
+    
+    /* Days from 1970-01-01 to January 1 of year (477 leap days before 1970) */
+    int64_t y = year - 1;
+    int64_t days = 365 * (int64_t)(year - 1970) + (y / 4 - y / 100 + y / 400) - 477;
+    days += t->day_of_year - 1;
     
-    static const int doy_u_weights[] = {8, 4, 2, 1};
-    int doy_u = decode_bcd_field(&f[30], doy_u_weights, 4);
+    *utc_ms_out = ((days * 24 + t->hours) * 60 + t->minutes) * 60000LL;
+    return true;
+}
+
+/**
+ * Decode a complete frame into time values (soft decision)
+ */
+static bool decode_frame(bcd_decoder_t *dec, bcd_time_t *time_out,
+                         bcd_frame_quality_t *quality_out) {
+    const bcd_frame_bits_t *f = &dec->frame;
     
-    int day_of_year = (doy_ht >= 0 && doy_u >= 0) ? doy_ht + doy_u : -1;
-    if (day_of_year < 1 || day_of_year > 366) {
-        LOG_WARN("[BCD] Invalid DOY: %d (ht=%d, u=%d)", day_of_year, doy_ht, doy_u);
+    /* Position markers: total, and at the correct positions */
+    int symbols_received = popcount64(f->filled);
+    int markers_found = popcount64(f->markers);
+    int markers_correct = popcount64(f->markers & P_MARKER_MASK);
+    
+    if (quality_out) {
+        quality_out->symbols_received = symbols_received;
+        quality_out->markers_found = markers_found;
+        quality_out->markers_correct = markers_correct;
+        quality_out->frame_coverage = (float)symbols_received / BCD_FRAME_LENGTH * 100.0f;
+        quality_out->min_margin = 0.0f;
+    }
+    
+    /* Frame alignment comes from the modem; only reject clearly misaligned frames */
+    if (markers_correct < BCD_SOFT_MIN_MARKERS) {
+        push_frame_history(dec, false);
+        LOG_WARN("[BCD] Frame decode failed: only %d/%d P markers correct (found %d total)",
+               markers_correct, NUM_P_MARKERS, markers_found);
+        log_frame(dec);
+        LOG_INFO("[BCD] Expect P at: 0,9,19,29,39,49,59");
         return false;
     }
     
+    push_frame_history(dec, true);
+    
+    int minutes, hours, day_of_year, year;
+    float confidence;
+    int frames_used = 1;
+    
+    /* A frame that decodes cleanly on its own needs no search */
+    float m_min = 0.0f, m_hour = 0.0f, m_doy = 0.0f, m_year = 0.0f;
+    bool hard_ok = decode_time_hard(f, &minutes, &hours, &day_of_year, &m_min, &m_hour, &m_doy);
+    if (hard_ok && dec->integration_frames > 1) {
+        float m = fminf(m_min, fminf(m_hour, m_doy));
+        hard_ok = m >= BCD_INTEGRATION_MIN_LOG_ODDS;
+    }
+    
+    if (dec->integration_frames > 1 && !hard_ok) {
+        /* Most likely time given the last N frames */
+        int mod;
+        float log_odds;
+        if (!decode_integrated(dec, &mod, &day_of_year, &year, &log_odds, &frames_used)) {
+            return false;
+        }
+        minutes = mod % 60;
+        hours = mod / 60;
+        confidence = 1.0f / (1.0f + expf(-log_odds));
+        if (quality_out) quality_out->min_margin = log_odds;
+        
+        if (log_odds < BCD_INTEGRATION_MIN_LOG_ODDS) {
+            LOG_WARN("[BCD] Integrated time too ambiguous: %02d:%02d day %d (%d frames, p=%.2f)",
+                     hours, minutes, day_of_year, frames_used, confidence);
+            log_frame(dec);
+            return false;
+        }
+    } else {
+        /* Single frame: hard decode, otherwise most likely valid value of each field */
+        uint64_t clean = f->filled & f->strong & ~f->markers;
+        if (!hard_ok) {
+            minutes = decode_field_soft(f->llr, &FIELD_MINUTES, &m_min);
+            hours = decode_field_soft(f->llr, &FIELD_HOURS, &m_hour);
+            day_of_year = decode_field_soft(f->llr, &FIELD_DOY, &m_doy);
+        }
+        
+        if ((clean & YEAR_MASK) == YEAR_MASK &&
+            (year = decode_field_hard(f->ones, &FIELD_YEAR)) >= 0) {
+            m_year = hard_field_log_odds(f, YEAR_MASK);
+        } else {
+            year = decode_field_soft(f->llr, &FIELD_YEAR, &m_year);
+        }
+        
+        float min_margin = m_min;
+        if (m_hour < min_margin) min_margin = m_hour;
+        if (m_doy < min_margin) min_margin = m_doy;
+        if (quality_out) quality_out->min_margin = min_margin;
+        
+        if (min_margin < BCD_SOFT_MIN_MARGIN) {
+            LOG_WARN("[BCD] Frame too ambiguous: %02d:%02d day %d (margins min=%.1f hr=%.1f doy=%.1f)",
+                     hours, minutes, day_of_year, m_min, m_hour, m_doy);
+            log_frame(dec);
+            return false;
+        }
+        
+        /* Year is informational; keep it only if unambiguous */
+        if (m_year < BCD_SOFT_MIN_MARGIN) {
+            year = -1;
+        }
+        
+        LOG_DEBUG("[BCD] Soft decode margins: min=%.1f hr=%.1f doy=%.1f yr=%.1f",
+                  m_min, m_hour, m_doy, m_year);
+        confidence = 1.0f / (1.0f + expf(-min_margin));
+    }
+    
+    /* Next integrated decodes search near this time */
+    dec->prior_epoch_ms = dec->history[dec->history_head].epoch_ms;
+    dec->prior_minute = (day_of_year - 1) * MINUTES_PER_DAY + hours * 60 + minutes;
+    
     /* Decode DUT1 sign: seconds 35-37 */
     int dut1_sign = 0;
-    if (f[35] == BCD_SYMBOL_ONE || f[36] == BCD_SYMBOL_ONE) {
+    if (f->ones & (FRAME_BIT(35) | FRAME_BIT(36))) {
         dut1_sign = 1;
     }
-    if (f[37] == BCD_SYMBOL_ONE) {
+    if (f->ones & FRAME_BIT(37)) {
         dut1_sign = -1;
     }
     
-    /* Decode DUT1 magnitude: seconds 40-43 */
-    float dut1_value = 0.0f;
-    if (f[40] == BCD_SYMBOL_ONE) dut1_value += 0.8f;
-    if (f[41] == BCD_SYMBOL_ONE) dut1_value += 0.4f;
-    if (f[42] == BCD_SYMBOL_ONE) dut1_value += 0.2f;
-    if (f[43] == BCD_SYMBOL_ONE) dut1_value += 0.1f;
-    
-    /* Decode year: seconds 51-58 */
-    static const int year_weights[] = {80, 40, 20, 10, 8, 4, 2, 1};
-    int year = decode_bcd_field(&f[51], year_weights, 8);
-    if (year < 0 || year > 99) {
-        year = -1;  /* Invalid but don't fail decode */
-    }
+    /* Decode DUT1 magnitude: seconds 40-43 (weights 0.8, 0.4, 0.2, 0.1) */
+    static const float dut1_weights[16] = {
+        0.0f, 0.8f, 0.4f, 1.2f, 0.2f, 1.0f, 0.6f, 1.4f,
+        0.1f, 0.9f, 0.5f, 1.3f, 0.3f, 1.1f, 0.7f, 1.5f
+    };
+    float dut1_value = dut1_weights[(f->ones >> 40) & 0xF];
     
     /* Fill output */
     time_out->valid = true;
@@ -226,20 +723,176 @@ static bool decode_frame(bcd_decoder_t *dec, bcd_time_t *time_out,
     time_out->dut1_value = dut1_value;
     time_out->leap_second_pending = false;
     time_out->dst_pending = false;
-    time_out->decode_timestamp_ms = 0;  /* Timestamp not used with frame_second mode */
+    time_out->decode_timestamp_ms = frame_epoch_ms(dec);
+    time_out->confidence = confidence;
+    time_out->frames_integrated = frames_used;
     
     return true;
 }
 
+/**
+ * Frame the modem should have sent for a decoded time: symbol class per
+ * position, -1 where not implied by the time (DUT1, unused, unknown year)
+ */
+static void encode_field_truth(int *truth, const bcd_field_t *field, int value) {
+    for (int i = 0; i < field->count; i++) {
+        int w = field->weights[i];
+        if (w != 0 && value >= w) {
+            truth[field->positions[i]] = BCD_SYMBOL_ONE;
+            value -= w;
+        } else {
+            truth[field->positions[i]] = BCD_SYMBOL_ZERO;
+        }
+    }
+}
+
+static void expected_frame(const bcd_time_t *t, int truth[BCD_FRAME_LENGTH]) {
+    for (int pos = 0; pos < BCD_FRAME_LENGTH; pos++) {
+        truth[pos] = is_p_marker_position(pos) ? BCD_SYMBOL_MARKER : -1;
+    }
+    encode_field_truth(truth, &FIELD_MINUTES, t->minutes);
+    encode_field_truth(truth, &FIELD_HOURS, t->hours);
+    encode_field_truth(truth, &FIELD_DOY, t->day_of_year);
+    if (t->year >= 0) {
+        encode_field_truth(truth, &FIELD_YEAR, t->year);
+    }
+}
+
+/*============================================================================
+ * Phase Search
+ *============================================================================*/
+
+/**
+ * Build the expected P-marker pattern for every phase
+ *
+ * Template for phase N: newest symbol is frame second N, so the symbol
+ * K seconds ago is frame second (N - K) mod 60.
+ */
+static void phase_build_templates(bcd_decoder_t *dec) {
+    memset(dec->phase_templates, 0, sizeof(dec->phase_templates));
+    for (int phase = 0; phase < BCD_FRAME_LENGTH; phase++) {
+        for (int age = 0; age < BCD_PHASE_WINDOW_SEC; age++) {
+            int second = ((phase - age) % BCD_FRAME_LENGTH + BCD_FRAME_LENGTH) % BCD_FRAME_LENGTH;
+            if (is_p_marker_position(second)) {
+                dec->phase_templates[phase][age / 64] |= 1ULL << (age % 64);
+            }
+        }
+    }
+}
+
+/**
+ * Age a shift register by n seconds, dropping bits past the window
+ */
+static void phase_shift(uint64_t w[PHASE_WORDS], int n) {
+    if (n >= 128) {
+        w[0] = w[1] = 0;
+    } else if (n >= 64) {
+        w[1] = w[0] << (n - 64);
+        w[0] = 0;
+    } else if (n > 0) {
+        w[1] = (w[1] << n) | (w[0] >> (64 - n));
+        w[0] <<= n;
+    }
+    w[1] &= (1ULL << (BCD_PHASE_WINDOW_SEC - 64)) - 1;
+}
+
+static void phase_clear(bcd_decoder_t *dec) {
+    memset(dec->phase_markers, 0, sizeof(dec->phase_markers));
+    memset(dec->phase_filled, 0, sizeof(dec->phase_filled));
+    dec->phase_have_last = false;
+    dec->phase_locked = false;
+    dec->phase_second = -1;
+    dec->phase_score = 0;
+    dec->phase_offset = 0;
+}
+
+/**
+ * P hits minus misses (P position received as 0/1) at one phase.
+ * Markers off the pattern are ordinary symbol errors and not counted,
+ * so a new phase can outscore an old one within a minute.
+ */
+static int phase_score(const bcd_decoder_t *dec, int phase) {
+    int score = 0;
+    for (int w = 0; w < PHASE_WORDS; w++) {
+        uint64_t t = dec->phase_templates[phase][w];
+        score += popcount64(dec->phase_markers[w] & t);
+        score -= popcount64(dec->phase_filled[w] & ~dec->phase_markers[w] & t);
+    }
+    return score;
+}
+
+/**
+ * Add a symbol to the phase search and update the locked phase
+ *
+ * Symbols are placed by the start of their second (pulse start), not by
+ * modem frame second.
+ */
+static void phase_update(bcd_decoder_t *dec, bool is_marker, uint64_t start_ms) {
+    int elapsed = 1;
+    if (dec->phase_have_last) {
+        int64_t diff = (int64_t)(start_ms - dec->phase_last_start_ms);
+        if (diff > 128000) diff = 128000;
+        elapsed = (int)((diff + 500) / 1000);
+        if (elapsed < 1) elapsed = 1;          /* Late pulse end, still next second */
+        if (elapsed > 128) elapsed = 128;
+    }
+    dec->phase_last_start_ms = start_ms;
+    dec->phase_have_last = true;
+    
+    phase_shift(dec->phase_markers, elapsed);
+    phase_shift(dec->phase_filled, elapsed);
+    dec->phase_filled[0] |= 1;
+    if (is_marker) dec->phase_markers[0] |= 1;
+    
+    if (dec->phase_second >= 0) {
+        dec->phase_second = (dec->phase_second + elapsed) % BCD_FRAME_LENGTH;
+    }
+    
+    /* Correlate against all 60 phases */
+    int best_phase = 0;
+    int best = -1000;
+    int runner_up = -1000;
+    for (int phase = 0; phase < BCD_FRAME_LENGTH; phase++) {
+        int score = phase_score(dec, phase);
+        if (score > best) {
+            runner_up = best;
+            best = score;
+            best_phase = phase;
+        } else if (score > runner_up) {
+            runner_up = score;
+        }
+    }
+    
+    if (!dec->phase_locked) {
+        if (best >= BCD_PHASE_MIN_SCORE && best - runner_up >= BCD_PHASE_MIN_MARGIN) {
+            dec->phase_locked = true;
+            dec->phase_second = best_phase;
+            LOG_INFO("[BCD] Phase search locked at second %d (score %d, margin %d)",
+                     best_phase, best, best - runner_up);
+        }
+    } else {
+        int held = phase_score(dec, dec->phase_second);
+        if (best_phase != dec->phase_second &&
+            best >= BCD_PHASE_MIN_SCORE && best - held >= BCD_PHASE_MIN_MARGIN) {
+            LOG_WARN("[BCD] Phase slip: second %d -> %d (score %d vs %d)",
+                     dec->phase_second, best_phase, held, best);
+            dec->phase_second = best_phase;
+        } else if (held < BCD_PHASE_MIN_SCORE / 2) {
+            LOG_WARN("[BCD] Phase search lost lock (score %d)", held);
+            dec->phase_locked = false;
+        }
+    }
+    dec->phase_score = dec->phase_locked ? phase_score(dec, dec->phase_second) : best;
+}
+
 /**
  * Clear frame buffer for new frame
  */
 static void clear_frame(bcd_decoder_t *dec) {
-    for (int i = 0; i < BCD_FRAME_LENGTH; i++) {
-        dec->frame[i] = BCD_SYMBOL_NONE;
-    }
-    dec->symbols_in_frame = 0;
-    dec->p_markers_in_frame = 0;
+    memset(&dec->frame, 0, sizeof(dec->frame));
+    dec->frame_epoch_count = 0;
+    dec->frame_epoch_sum = 0.0;
+    bcd_stats_discard_frame(dec->stats);
 }
 
 /*============================================================================
@@ -255,8 +908,21 @@ bcd_decoder_t *bcd_decoder_create(void) {
     dec->last_frame_position = -1;
     dec->last_symbol = BCD_SYMBOL_NONE;
     dec->last_sync_state = SYNC_ACQUIRING;
+    dec->width_var = BCD_SOFT_WIDTH_SIGMA_MS * BCD_SOFT_WIDTH_SIGMA_MS;
+    dec->integration_frames = BCD_INTEGRATION_DEFAULT_FRAMES;
+    
+    dec->stats = bcd_stats_create();
+    dec->clock = bcd_clock_create();
+    if (!dec->stats || !dec->clock) {
+        bcd_stats_destroy(dec->stats);
+        bcd_clock_destroy(dec->clock);
+        free(dec);
+        return NULL;
+    }
     
     clear_frame(dec);
+    phase_build_templates(dec);
+    phase_clear(dec);
     
     LOG_INFO("[BCD] Frame assembler created, frame position from modem");
     return dec;
@@ -268,6 +934,8 @@ void bcd_decoder_destroy(bcd_decoder_t *dec) {
             LOG_INFO("[BCD] Final stats: %u decoded, %u failed, %u symbols",
                    dec->frames_decoded, dec->frames_failed, dec->total_symbols);
         }
+        bcd_stats_destroy(dec->stats);
+        bcd_clock_destroy(dec->clock);
         free(dec);
     }
 }
@@ -278,6 +946,17 @@ void bcd_decoder_process_symbol(bcd_decoder_t *dec,
                                 float width_ms,
                                 float confidence,
                                 sync_state_t sync_state) {
+    bcd_decoder_process_symbol_at(dec, symbol_char, frame_second, width_ms,
+                                  confidence, sync_state, bcd_clock_monotonic_ms());
+}
+
+void bcd_decoder_process_symbol_at(bcd_decoder_t *dec,
+                                   char symbol_char,
+                                   int frame_second,
+                                   float width_ms,
+                                   float confidence,
+                                   sync_state_t sync_state,
+                                   uint64_t timestamp_ms) {
     if (!dec) return;
     
     bcd_symbol_t symbol = char_to_symbol(symbol_char);
@@ -288,23 +967,57 @@ void bcd_decoder_process_symbol(bcd_decoder_t *dec,
     dec->last_symbol_width_ms = width_ms;
     dec->last_symbol_confidence = confidence;
     
+    float ll[NUM_SYMBOL_CLASSES];
+    symbol_likelihoods(symbol, width_ms, confidence, dec->width_var, ll);
+    bool is_marker = ll[BCD_SYMBOL_MARKER] > ll[BCD_SYMBOL_ZERO] &&
+                     ll[BCD_SYMBOL_MARKER] > ll[BCD_SYMBOL_ONE];
+    
+    /* SYM is sent at the end of the pulse: arrival - width is the start
+     * of the second */
+    uint64_t start_ms = timestamp_ms - (uint64_t)(width_ms > 0.0f ? width_ms : 0.0f);
+    
+    /* Phase search runs on every symbol, whatever the modem's sync state */
+    phase_update(dec, is_marker, start_ms);
+    bool use_phase = dec->phase_search && dec->phase_locked;
+    
+    if (dec->phase_locked && frame_second >= 0 && frame_second < BCD_FRAME_LENGTH) {
+        int offset = (dec->phase_second - frame_second + BCD_FRAME_LENGTH) % BCD_FRAME_LENGTH;
+        if (offset >= BCD_FRAME_LENGTH / 2) offset -= BCD_FRAME_LENGTH;
+        if (offset != dec->phase_offset) {
+            LOG_WARN("[BCD] Phase search disagrees with modem: second %d vs modem %d (%+d s)",
+                     dec->phase_second, frame_second, offset);
+            dec->phase_offset = offset;
+            /* Frame so far was assembled at the other phase */
+            if (use_phase) clear_frame(dec);
+        }
+    }
+    
     /* Track sync state changes */
     if (dec->last_sync_state != sync_state) {
         const char *state_names[] = {"ACQUIRING", "TENTATIVE", "LOCKED", "RECOVERING"};
-        LOG_INFO("[BCD] Sync state change: %s -> %s",
-                 state_names[dec->last_sync_state], state_names[sync_state]);
+        LOG_INFO("[BCD] Sync state change: %s -> %s%s",
+                 state_names[dec->last_sync_state], state_names[sync_state],
+                 use_phase ? " (phase search locked, frame kept)" : "");
         dec->last_sync_state = sync_state;
         
         /* Clear frame on state change to avoid stale data */
-        clear_frame(dec);
+        if (!use_phase) {
+            clear_frame(dec);
+            clear_frame_history(dec);
+        }
     }
     
-    /* Only process symbols when not in ACQUIRING state */
-    if (sync_state == SYNC_ACQUIRING) {
+    if (use_phase) {
+        /* Frame position and decode gating come from the symbol stream */
+        frame_second = dec->phase_second;
+        sync_state = SYNC_LOCKED;
+    } else if (sync_state == SYNC_ACQUIRING) {
+        /* Only process symbols when not in ACQUIRING state */
         if (dec->sync_state != BCD_SYNC_WAITING) {
             LOG_INFO("[BCD] Lost sync (ACQUIRING), clearing frame");
             dec->sync_state = BCD_SYNC_WAITING;
             clear_frame(dec);
+            clear_frame_history(dec);
         }
         return;
     }
@@ -321,26 +1034,36 @@ void bcd_decoder_process_symbol(bcd_decoder_t *dec,
         return;
     }
     
-    /* Detect frame boundary (second 0 or wrap from 59->0) */
-    bool new_frame = false;
-    if (frame_second == 0 || (dec->last_frame_position == 59 && frame_second == 0)) {
-        new_frame = true;
-        
+    /* Detect frame boundary (second 0, or position wrapped with second 0 missed) */
+    if (frame_second == 0 ||
+        (dec->last_frame_position >= 0 && frame_second < dec->last_frame_position)) {
         /* Check if we should attempt decode */
-        if (dec->sync_state == BCD_SYNC_ACTIVE && dec->symbols_in_frame > 0) {
+        if (dec->sync_state == BCD_SYNC_ACTIVE && dec->frame.filled != 0) {
             LOG_DEBUG("[BCD] Frame complete: %d symbols, %d P-markers",
-                      dec->symbols_in_frame, dec->p_markers_in_frame);
+                      popcount64(dec->frame.filled), popcount64(dec->frame.markers));
             
             /* Attempt decode (only in LOCKED state for now) */
             if (sync_state == SYNC_LOCKED) {
                 bcd_time_t decoded_time;
                 bcd_frame_quality_t quality;
                 if (decode_frame(dec, &decoded_time, &quality)) {
+                    int truth[BCD_FRAME_LENGTH];
+                    expected_frame(&decoded_time, truth);
+                    bcd_stats_commit_frame(dec->stats, truth);
+                    
+                    /* Frame started at the decoded minute: discipline the clock */
+                    int64_t utc_ms;
+                    if (decoded_time.decode_timestamp_ms != 0 &&
+                        time_to_utc_ms(dec, &decoded_time, &utc_ms)) {
+                        bcd_clock_add_fix(dec->clock, decoded_time.decode_timestamp_ms, utc_ms);
+                    }
+                    
                     dec->last_time = decoded_time;
                     dec->frames_decoded++;
-                    LOG_INFO("[BCD] Decoded time: %04d-%02d-%02d %02d:%02d",
+                    LOG_INFO("[BCD] Decoded time: %04d-%02d-%02d %02d:%02d (p=%.2f, %d frames)",
                              decoded_time.year, decoded_time.day_of_year / 100, decoded_time.day_of_year % 100,
-                             decoded_time.hours, decoded_time.minutes);
+                             decoded_time.hours, decoded_time.minutes,
+                             decoded_time.confidence, decoded_time.frames_integrated);
                 } else {
                     dec->frames_failed++;
                     LOG_WARN("[BCD] Frame decode failed");
@@ -364,13 +1087,46 @@ void bcd_decoder_process_symbol(bcd_decoder_t *dec,
     
     /* Accumulate symbol into frame */
     if (dec->sync_state == BCD_SYNC_ACTIVE) {
-        /* Store symbol */
-        dec->frame[frame_second] = symbol;
-        dec->symbols_in_frame++;
+        bcd_stats_add_symbol(dec->stats, frame_second, (int)symbol, width_ms, confidence);
         
-        /* Count P markers */
-        if (symbol == BCD_SYMBOL_MARKER) {
-            dec->p_markers_in_frame++;
+        /* Second 0 estimate from this symbol; drop ones far off the frame's */
+        uint64_t epoch = start_ms - (uint64_t)frame_second * 1000;
+        if (dec->frame_epoch_count == 0) {
+            dec->frame_epoch_ref = epoch;
+            dec->frame_epoch_sum = 0.0;
+            dec->frame_epoch_count = 1;
+        } else {
+            int64_t dev = (int64_t)(epoch - dec->frame_epoch_ref);
+            if (dev >= -BCD_EPOCH_MAX_DEV_MS && dev <= BCD_EPOCH_MAX_DEV_MS) {
+                dec->frame_epoch_sum += (double)dev;
+                dec->frame_epoch_count++;
+            }
+        }
+        
+        /* Store most likely symbol and the soft ONE/ZERO ratio */
+        uint64_t bit = FRAME_BIT(frame_second);
+        bcd_frame_bits_t *f = &dec->frame;
+        f->filled |= bit;
+        f->ones &= ~bit;
+        f->markers &= ~bit;
+        f->strong &= ~bit;
+        if (is_marker) {
+            f->markers |= bit;
+        } else if (ll[BCD_SYMBOL_ONE] > ll[BCD_SYMBOL_ZERO]) {
+            f->ones |= bit;
+        }
+        f->llr[frame_second] = ll[BCD_SYMBOL_ONE] - ll[BCD_SYMBOL_ZERO];
+        if (fabsf(f->llr[frame_second]) >= BCD_STRONG_LLR) {
+            f->strong |= bit;
+        }
+        
+        /* P marker positions are known symbols: use them to track width spread */
+        if (is_p_marker_position(frame_second) && width_ms > 0.0f) {
+            float d = width_ms - BCD_WIDTH_MARKER_MS;
+            float lo = BCD_SOFT_SIGMA_MIN_MS * BCD_SOFT_SIGMA_MIN_MS;
+            float hi = BCD_SOFT_SIGMA_MAX_MS * BCD_SOFT_SIGMA_MAX_MS;
+            dec->width_var += BCD_SOFT_SIGMA_ALPHA * (d * d - dec->width_var);
+            dec->width_var = CLAMP(dec->width_var, lo, hi);
         }
     }
 }
@@ -383,10 +1139,156 @@ void bcd_decoder_reset(bcd_decoder_t *dec) {
     dec->last_frame_position = -1;
     dec->last_symbol = BCD_SYMBOL_NONE;
     clear_frame(dec);
+    clear_frame_history(dec);
+    dec->prior_epoch_ms = 0;
+    phase_clear(dec);
+    bcd_stats_reset(dec->stats);
     
     LOG_INFO("[BCD] Reset, waiting for minute sync");
 }
 
+void bcd_decoder_set_integration(bcd_decoder_t *dec, int frames) {
+    if (!dec) return;
+    dec->integration_frames = CLAMP(frames, 1, BCD_INTEGRATION_MAX_FRAMES);
+    LOG_INFO("[BCD] Multi-frame integration: %d frame(s)", dec->integration_frames);
+}
+
+int bcd_decoder_get_integration(bcd_decoder_t *dec) {
+    return dec ? dec->integration_frames : 1;
+}
+
+bool bcd_decoder_load_config(bcd_decoder_t *dec, const char *filename) {
+    if (!dec || !filename) return false;
+    
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        LOG_DEBUG("No config file found: %s", filename);
+        return false;
+    }
+    
+    char line[256];
+    bool in_bcd_section = false;
+    
+    while (fgets(line, sizeof(line), f)) {
+        /* Trim newline */
+        char *nl = strchr(line, '\n');
+        if (nl) *nl = '\0';
+        nl = strchr(line, '\r');
+        if (nl) *nl = '\0';
+        
+        /* Skip empty lines and comments */
+        if (line[0] == '\0' || line[0] == ';' || line[0] == '#') continue;
+        
+        /* Section headers */
+        if (line[0] == '[') {
+            in_bcd_section = (strcmp(line, "[BCD]") == 0);
+            continue;
+        }
+        
+        /* Key=value pairs in [BCD] section */
+        if (in_bcd_section) {
+            char *eq = strchr(line, '=');
+            if (eq) {
+                *eq = '\0';
+                const char *key = line;
+                const char *value = eq + 1;
+                
+                if (strcmp(key, "integration_frames") == 0) {
+                    bcd_decoder_set_integration(dec, atoi(value));
+                }
+            }
+        }
+    }
+    
+    fclose(f);
+    LOG_INFO("Loaded BCD options from %s (integration=%d)", filename, dec->integration_frames);
+    return true;
+}
+
+bool bcd_decoder_save_config(bcd_decoder_t *dec, const char *filename) {
+    if (!dec || !filename) return false;
+    
+    /* Read existing file content (without [BCD] section) */
+    char *existing_content = NULL;
+    size_t existing_size = 0;
+    
+    FILE *f = fopen(filename, "r");
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        long file_size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        
+        if (file_size > 0) {
+            char *buffer = malloc(file_size + 1);
+            existing_content = malloc(file_size + 1);
+            if (buffer && existing_content) {
+                size_t got = fread(buffer, 1, file_size, f);
+                buffer[got] = '\0';
+                
+                /* Copy everything except [BCD] section */
+                char *src = buffer;
+                char *dst = existing_content;
+                bool skip_section = false;
+                
+                while (*src) {
+                    char *eol = strchr(src, '\n');
+                    size_t line_len = eol ? (size_t)(eol - src + 1) : strlen(src);
+                    
+                    if (src[0] == '[') {
+                        skip_section = (strncmp(src, "[BCD]", 5) == 0);
+                    }
+                    if (!skip_section) {
+                        memcpy(dst, src, line_len);
+                        dst += line_len;
+                    }
+                    src += line_len;
+                }
+                *dst = '\0';
+                existing_size = dst - existing_content;
+            }
+            free(buffer);
+        }
+        fclose(f);
+    }
+    
+    /* Write file with [BCD] section at end */
+    f = fopen(filename, "w");
+    if (!f) {
+        LOG_ERROR("Failed to open %s for writing", filename);
+        free(existing_content);
+        return false;
+    }
+    
+    if (existing_content && existing_size > 0) {
+        fwrite(existing_content, 1, existing_size, f);
+        if (existing_content[existing_size - 1] != '\n') {
+            fprintf(f, "\n");
+        }
+    }
+    free(existing_content);
+    
+    fprintf(f, "\n[BCD]\n");
+    fprintf(f, "integration_frames=%d\n", dec->integration_frames);
+    
+    fclose(f);
+    LOG_INFO("Saved BCD options to %s", filename);
+    return true;
+}
+
+void bcd_decoder_set_phase_search(bcd_decoder_t *dec, bool enable) {
+    if (!dec || dec->phase_search == enable) return;
+    dec->phase_search = enable;
+    LOG_INFO("[BCD] Phase search %s", enable ? "enabled" : "disabled");
+}
+
+bool bcd_decoder_get_phase_search(bcd_decoder_t *dec) {
+    return dec ? dec->phase_search : false;
+}
+
+bcd_clock_t *bcd_decoder_get_clock(bcd_decoder_t *dec) {
+    return dec ? dec->clock : NULL;
+}
+
 bcd_sync_state_t bcd_decoder_get_sync_state(bcd_decoder_t *dec) {
     return dec ? dec->sync_state : BCD_SYNC_WAITING;
 }
@@ -425,12 +1327,19 @@ void bcd_decoder_get_ui_status(bcd_decoder_t *dec, bcd_ui_status_t *status) {
     status->last_symbol = dec->last_symbol;
     status->last_symbol_width_ms = dec->last_symbol_width_ms;
     status->last_symbol_timestamp_ms = 0.0f;  /* Legacy field - no longer used */
-    status->symbols_in_frame = dec->symbols_in_frame;
-    status->p_markers_found = dec->p_markers_in_frame;
+    status->symbols_in_frame = popcount64(dec->frame.filled);
+    status->p_markers_found = popcount64(dec->frame.markers);
     status->frames_decoded = dec->frames_decoded;
     status->frames_failed = dec->frames_failed;
     status->total_symbols = dec->total_symbols;
     
+    status->phase_search = dec->phase_search;
+    status->phase_locked = dec->phase_locked;
+    status->phase_second = dec->phase_locked ? dec->phase_second : -1;
+    status->phase_offset = dec->phase_locked ? dec->phase_offset : 0;
+    status->phase_score = dec->phase_score;
+    bcd_stats_get_summary(dec->stats, &status->symbol_stats);
+    
     status->time_valid = dec->last_time.valid;
     if (dec->last_time.valid) {
         status->current_time = dec->last_time;
@@ -16,6 +16,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "common.h"  /* For sync_state_t */
+#include "bcd_stats.h"
+#include "bcd_clock.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +39,34 @@ extern "C" {
 #define BCD_P5_SECOND               49
 #define BCD_P6_SECOND               59      /* Also next minute's P0 */
 
+/* Soft-decision decoding */
+#define BCD_WIDTH_ZERO_MS           200.0f  /* Nominal pulse widths */
+#define BCD_WIDTH_ONE_MS            500.0f
+#define BCD_WIDTH_MARKER_MS         800.0f
+#define BCD_SOFT_WIDTH_SIGMA_MS     75.0f   /* Initial pulse width spread */
+#define BCD_SOFT_SIGMA_MIN_MS       40.0f   /* Clamp for estimated spread */
+#define BCD_SOFT_SIGMA_MAX_MS       250.0f
+#define BCD_SOFT_SIGMA_ALPHA        0.1f    /* Spread estimator smoothing (per P marker) */
+#define BCD_SOFT_LABEL_WEIGHT       0.25f   /* Weight of modem label when width known */
+#define BCD_SOFT_MIN_MARGIN         2.0f    /* Min log-odds of decoded value per field */
+#define BCD_SOFT_MIN_MARKERS        3       /* Min P markers (of 7) favoured */
+#define BCD_STRONG_LLR              6.0f    /* Bit unambiguous enough for hard fast path */
+
+/* Multi-frame integration */
+#define BCD_INTEGRATION_MAX_FRAMES      10      /* History ring size */
+#define BCD_INTEGRATION_DEFAULT_FRAMES  5       /* Frames combined per decode (1 = off) */
+#define BCD_INTEGRATION_MIN_LOG_ODDS    3.0f    /* Min log-odds of integrated time */
+#define BCD_INTEGRATION_SEARCH_MINUTES  10      /* Search +/- this around the expected time */
+#define BCD_INTEGRATION_PRIOR_MAX_MS    3600000 /* Expected time from a decode up to 1 h old */
+
+/* Phase search (frame alignment from the P-marker pattern itself) */
+#define BCD_PHASE_WINDOW_SEC        120     /* Seconds of symbols correlated (max 128) */
+#define BCD_PHASE_MIN_SCORE         6       /* Min P hits minus misses to lock */
+#define BCD_PHASE_MIN_MARGIN        4       /* Lead over every other phase to lock/slip */
+
+/* Frame timing */
+#define BCD_EPOCH_MAX_DEV_MS        250     /* Symbol timing ignored beyond this from frame */
+
 /*============================================================================
  * Types
  *============================================================================*/
@@ -67,7 +97,9 @@ typedef struct {
     float dut1_value;           /* 0.0 to 0.9 seconds */
     bool leap_second_pending;   /* Leap second warning */
     bool dst_pending;           /* DST change warning */
-    uint64_t decode_timestamp_ms; /* When this was decoded */
+    uint64_t decode_timestamp_ms; /* Monotonic ms at frame second 0 (0 = untimed) */
+    float confidence;           /* Posterior probability of this time (0-1) */
+    int frames_integrated;      /* Frames contributing evidence */
 } bcd_time_t;
 
 /** Frame quality metrics */
@@ -76,6 +108,7 @@ typedef struct {
     int markers_found;          /* Position markers detected */
     int markers_correct;        /* P markers at correct positions */
     float frame_coverage;       /* % of frame positions filled */
+    float min_margin;           /* Weakest field log-odds (soft decode) */
 } bcd_frame_quality_t;
 
 /** Comprehensive status structure for UI */
@@ -97,6 +130,16 @@ typedef struct {
     uint32_t frames_failed;         /* Failed decode */
     uint32_t total_symbols;         /* All symbols received */
     
+    /* Phase search */
+    bool phase_search;              /* Frame position taken from symbol stream */
+    bool phase_locked;              /* P-marker pattern found */
+    int phase_second;               /* Symbol stream frame position, or -1 */
+    int phase_offset;               /* Symbol stream minus modem position (-30..29) */
+    int phase_score;                /* P hits minus misses at locked phase */
+    
+    /* Modem symbol quality over recent decoded frames */
+    bcd_stats_summary_t symbol_stats;
+    
     /* Current time (if valid) */
     bool time_valid;
     bcd_time_t current_time;
@@ -122,12 +165,18 @@ void bcd_decoder_destroy(bcd_decoder_t *dec);
 /**
  * Process a symbol from the modem
  *
+ * Width and confidence are kept as per-position soft likelihoods;
+ * each frame is decoded to the most likely valid time.
+ *
  * @param dec               Decoder instance
  * @param symbol            Symbol type ('0', '1', 'P')
  * @param frame_second      Frame position (0-59) from modem
  * @param width_ms          Pulse width in milliseconds
  * @param confidence        Symbol confidence 0.0-1.0
  * @param sync_state        Current sync state from modem
+ *
+ * Call once per received symbol: repeats are not filtered here, since a
+ * modem that sticks on a second must not hide real symbols from phase search.
  */
 void bcd_decoder_process_symbol(bcd_decoder_t *dec,
                                 char symbol,
@@ -136,6 +185,79 @@ void bcd_decoder_process_symbol(bcd_decoder_t *dec,
                                 float confidence,
                                 sync_state_t sync_state);
 
+/**
+ * Process a symbol with an explicit arrival time
+ *
+ * As bcd_decoder_process_symbol(), which stamps symbols with the
+ * monotonic clock on arrival. SYM is sent at the end of the pulse, so
+ * arrival minus width_ms gives the second boundary used by phase search.
+ *
+ * @param timestamp_ms      Arrival time (bcd_clock_monotonic_ms() domain)
+ */
+void bcd_decoder_process_symbol_at(bcd_decoder_t *dec,
+                                   char symbol,
+                                   int frame_second,
+                                   float width_ms,
+                                   float confidence,
+                                   sync_state_t sync_state,
+                                   uint64_t timestamp_ms);
+
+/**
+ * Enable or disable phase search
+ *
+ * The P-marker pattern of the last BCD_PHASE_WINDOW_SEC seconds is
+ * correlated at all 60 offsets. Once locked, frames are assembled at the
+ * found phase instead of the modem's frame second, and decoding no longer
+ * waits for modem sync to reach LOCKED. Disagreement with the modem is
+ * reported in the UI status and logged.
+ */
+void bcd_decoder_set_phase_search(bcd_decoder_t *dec, bool enable);
+
+/**
+ * Check whether phase search is enabled
+ */
+bool bcd_decoder_get_phase_search(bcd_decoder_t *dec);
+
+/**
+ * Get the clock disciplined by decoded frames
+ *
+ * Each decoded frame adds a fix (monotonic time of its second 0, UTC
+ * minute it carries). Owned by the decoder; survives bcd_decoder_reset().
+ */
+bcd_clock_t *bcd_decoder_get_clock(bcd_decoder_t *dec);
+
+/**
+ * Set number of consecutive frames combined per decode
+ *
+ * Evidence from frames in the last N minutes is combined, each placed by
+ * its frame timing (with hour/day rollover); missing minutes are skipped
+ * and a gap longer than the history restarts integration. Once a time has
+ * been decoded, later decodes search only near the time it implies and
+ * fall back to searching the whole year if that is ambiguous. 1 decodes
+ * each frame on its own.
+ *
+ * @param dec               Decoder instance
+ * @param frames            1 to BCD_INTEGRATION_MAX_FRAMES
+ */
+void bcd_decoder_set_integration(bcd_decoder_t *dec, int frames);
+
+/**
+ * Get number of frames combined per decode
+ */
+int bcd_decoder_get_integration(bcd_decoder_t *dec);
+
+/**
+ * Load [BCD] options from INI file
+ * Keys: integration_frames (1 = decode each frame on its own)
+ * @return true if the file was read
+ */
+bool bcd_decoder_load_config(bcd_decoder_t *dec, const char *filename);
+
+/**
+ * Save [BCD] options to INI file (other sections are kept)
+ */
+bool bcd_decoder_save_config(bcd_decoder_t *dec, const char *filename);
+
 /**
  * Reset decoder state
  */
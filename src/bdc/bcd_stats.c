@@ -0,0 +1,183 @@
+/**
+ * @file bcd_stats.c
+ * @brief BCD Symbol Quality Statistics Implementation
+ *
+ * Each decoded frame is scored position by position and kept in a ring of
+ * BCD_STATS_WINDOW_FRAMES entries. Running counts are updated as frames
+ * enter and leave the ring, so a summary never rescans the window.
+ */
+
+#include "bcd_stats.h"
+#include "../include/common.h"  /* For LOG_INFO etc */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*============================================================================
+ * Internal Types
+ *============================================================================*/
+
+#define FRAME_BIT(pos) (1ULL << (pos))
+#define NO_WIDTH 0xFFFF
+
+/* One scored frame in the rolling window */
+typedef struct {
+    uint64_t checked;                           /* Positions with known truth */
+    uint64_t errors;                            /* Modem label differed from truth */
+    int8_t truth[BCD_STATS_POSITIONS];
+    int8_t label[BCD_STATS_POSITIONS];
+    uint8_t conf_bin[BCD_STATS_POSITIONS];
+    uint16_t width_ms[BCD_STATS_POSITIONS];     /* NO_WIDTH if unknown */
+} bcd_stats_frame_t;
+
+struct bcd_stats {
+    /* Frame being assembled */
+    uint64_t pending_filled;
+    int8_t pending_label[BCD_STATS_POSITIONS];
+    uint8_t pending_conf_bin[BCD_STATS_POSITIONS];
+    uint16_t pending_width_ms[BCD_STATS_POSITIONS];
+    
+    /* Rolling window (oldest overwritten) */
+    bcd_stats_frame_t window[BCD_STATS_WINDOW_FRAMES];
+    int window_head;
+    int window_count;
+    
+    /* Running counts over the window */
+    bcd_stats_summary_t counts;
+    double width_sum[BCD_STATS_CLASSES];
+    double width_sq_sum[BCD_STATS_CLASSES];
+    uint32_t width_n[BCD_STATS_CLASSES];
+};
+
+/*============================================================================
+ * Internal Helpers
+ *============================================================================*/
+
+/**
+ * Add (sign = +1) or remove (sign = -1) a frame from the running counts
+ */
+static void apply_frame(bcd_stats_t *stats, const bcd_stats_frame_t *fr, int sign) {
+    bcd_stats_summary_t *c = &stats->counts;
+    
+    c->frames += sign;
+    for (int pos = 0; pos < BCD_STATS_POSITIONS; pos++) {
+        if (!(fr->checked & FRAME_BIT(pos))) continue;
+    
+        int t = fr->truth[pos];
+        bool err = (fr->errors & FRAME_BIT(pos)) != 0;
+    
+        c->position_symbols[pos] += sign;
+        c->symbols += sign;
+        if (err) {
+            c->position_errors[pos] += sign;
+            c->errors += sign;
+        }
+        c->confusion[t][fr->label[pos]] += sign;
+        c->conf_hist[t][fr->conf_bin[pos]] += sign;
+    
+        if (fr->width_ms[pos] != NO_WIDTH) {
+            double w = fr->width_ms[pos];
+            int bin = (int)(w / BCD_STATS_WIDTH_BIN_MS);
+            if (bin >= BCD_STATS_WIDTH_BINS) bin = BCD_STATS_WIDTH_BINS - 1;
+            c->width_hist[t][bin] += sign;
+            stats->width_sum[t] += sign * w;
+            stats->width_sq_sum[t] += sign * w * w;
+            stats->width_n[t] += sign;
+        }
+    }
+}
+
+/*============================================================================
+ * Public API Implementation
+ *============================================================================*/
+
+bcd_stats_t *bcd_stats_create(void) {
+    return calloc(1, sizeof(bcd_stats_t));
+}
+
+void bcd_stats_destroy(bcd_stats_t *stats) {
+    if (stats) {
+        if (stats->counts.symbols > 0) {
+            LOG_INFO("[BCD] Symbol stats: %u errors in %u checked symbols (last %d frames)",
+                     stats->counts.errors, stats->counts.symbols, stats->counts.frames);
+        }
+        free(stats);
+    }
+}
+
+void bcd_stats_reset(bcd_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+}
+
+void bcd_stats_add_symbol(bcd_stats_t *stats, int position, int label,
+                          float width_ms, float confidence) {
+    if (!stats || position < 0 || position >= BCD_STATS_POSITIONS) return;
+    if (label < 0 || label >= BCD_STATS_CLASSES) return;
+    
+    int conf_bin = (int)(confidence * BCD_STATS_CONF_BINS);
+    
+    stats->pending_filled |= FRAME_BIT(position);
+    stats->pending_label[position] = (int8_t)label;
+    stats->pending_conf_bin[position] = (uint8_t)CLAMP(conf_bin, 0, BCD_STATS_CONF_BINS - 1);
+    stats->pending_width_ms[position] = (width_ms > 0.0f && width_ms < 60000.0f) ?
+                                        (uint16_t)(width_ms + 0.5f) : NO_WIDTH;
+}
+
+void bcd_stats_commit_frame(bcd_stats_t *stats, const int truth[BCD_STATS_POSITIONS]) {
+    if (!stats || !truth) return;
+    
+    /* Evict the oldest frame once the window is full */
+    stats->window_head = (stats->window_head + 1) % BCD_STATS_WINDOW_FRAMES;
+    bcd_stats_frame_t *fr = &stats->window[stats->window_head];
+    if (stats->window_count == BCD_STATS_WINDOW_FRAMES) {
+        apply_frame(stats, fr, -1);
+    } else {
+        stats->window_count++;
+    }
+    
+    memset(fr, 0, sizeof(*fr));
+    for (int pos = 0; pos < BCD_STATS_POSITIONS; pos++) {
+        if (!(stats->pending_filled & FRAME_BIT(pos))) continue;
+        if (truth[pos] < 0 || truth[pos] >= BCD_STATS_CLASSES) continue;
+    
+        fr->checked |= FRAME_BIT(pos);
+        fr->truth[pos] = (int8_t)truth[pos];
+        fr->label[pos] = stats->pending_label[pos];
+        fr->conf_bin[pos] = stats->pending_conf_bin[pos];
+        fr->width_ms[pos] = stats->pending_width_ms[pos];
+        if (fr->label[pos] != fr->truth[pos]) {
+            fr->errors |= FRAME_BIT(pos);
+        }
+    }
+    apply_frame(stats, fr, +1);
+    
+    bcd_stats_discard_frame(stats);
+}
+
+void bcd_stats_discard_frame(bcd_stats_t *stats) {
+    if (!stats) return;
+    stats->pending_filled = 0;
+}
+
+void bcd_stats_get_summary(const bcd_stats_t *stats, bcd_stats_summary_t *out) {
+    if (!out) return;
+    if (!stats) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    
+    *out = stats->counts;
+    for (int t = 0; t < BCD_STATS_CLASSES; t++) {
+        uint32_t n = stats->width_n[t];
+        if (n == 0) {
+            out->width_mean_ms[t] = 0.0f;
+            out->width_sd_ms[t] = 0.0f;
+            continue;
+        }
+        double mean = stats->width_sum[t] / n;
+        double var = stats->width_sq_sum[t] / n - mean * mean;
+        out->width_mean_ms[t] = (float)mean;
+        out->width_sd_ms[t] = (float)sqrt(var > 0.0 ? var : 0.0);
+    }
+}
@@ -0,0 +1,115 @@
+/**
+ * @file bcd_stats.h
+ * @brief BCD Symbol Quality Statistics
+ *
+ * Compares the modem's symbols against frames whose time decoded, to show
+ * which frame positions and symbol classes the modem misdetects.
+ * All windows are fixed-size rings; nothing allocates after create.
+ *
+ * Input: Modem symbols per frame position + expected frame after decode
+ * Output: Per-position error rates, confusion, confidence and width histograms
+ */
+
+#ifndef BCD_STATS_H
+#define BCD_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================
+ * Configuration
+ *============================================================================*/
+
+#define BCD_STATS_POSITIONS         60      /* Frame positions (seconds) */
+#define BCD_STATS_CLASSES           3       /* ZERO, ONE, MARKER (bcd_symbol_t order) */
+#define BCD_STATS_WINDOW_FRAMES     30      /* Decoded frames kept in rolling window */
+#define BCD_STATS_CONF_BINS         10      /* Confidence bins, 0.1 wide */
+#define BCD_STATS_WIDTH_BINS        20      /* Width bins, 0-1000 ms */
+#define BCD_STATS_WIDTH_BIN_MS      50.0f
+
+/*============================================================================
+ * Types
+ *============================================================================*/
+
+/** Rolling-window summary (all counts cover the last N decoded frames) */
+typedef struct {
+    int frames;                                 /* Decoded frames in window */
+
+    /* Per frame position: symbols with known truth and modem errors */
+    uint16_t position_symbols[BCD_STATS_POSITIONS];
+    uint16_t position_errors[BCD_STATS_POSITIONS];
+
+    /* By true symbol class */
+    uint32_t confusion[BCD_STATS_CLASSES][BCD_STATS_CLASSES];   /* [truth][modem label] */
+    uint32_t conf_hist[BCD_STATS_CLASSES][BCD_STATS_CONF_BINS];
+    uint32_t width_hist[BCD_STATS_CLASSES][BCD_STATS_WIDTH_BINS];
+    float width_mean_ms[BCD_STATS_CLASSES];
+    float width_sd_ms[BCD_STATS_CLASSES];
+
+    /* Window totals */
+    uint32_t symbols;
+    uint32_t errors;
+} bcd_stats_summary_t;
+
+/** Opaque statistics state */
+typedef struct bcd_stats bcd_stats_t;
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+/**
+ * Create statistics tracker
+ */
+bcd_stats_t *bcd_stats_create(void);
+
+/**
+ * Destroy statistics tracker
+ */
+void bcd_stats_destroy(bcd_stats_t *stats);
+
+/**
+ * Clear all windows
+ */
+void bcd_stats_reset(bcd_stats_t *stats);
+
+/**
+ * Record the modem's symbol at a position of the frame being assembled
+ *
+ * @param stats             Statistics instance
+ * @param position          Frame position (0-59)
+ * @param label             Modem symbol class (0 = ZERO, 1 = ONE, 2 = MARKER)
+ * @param width_ms          Pulse width in milliseconds (<= 0 if unknown)
+ * @param confidence        Modem confidence 0.0-1.0
+ */
+void bcd_stats_add_symbol(bcd_stats_t *stats, int position, int label,
+                          float width_ms, float confidence);
+
+/**
+ * Score the assembled frame against the frame its decoded time implies
+ * and add it to the rolling window
+ *
+ * @param stats             Statistics instance
+ * @param truth             Expected class per position, -1 where unknown
+ */
+void bcd_stats_commit_frame(bcd_stats_t *stats, const int truth[BCD_STATS_POSITIONS]);
+
+/**
+ * Drop the assembled frame (no decode, or frame cleared)
+ */
+void bcd_stats_discard_frame(bcd_stats_t *stats);
+
+/**
+ * Get rolling-window summary
+ */
+void bcd_stats_get_summary(const bcd_stats_t *stats, bcd_stats_summary_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BCD_STATS_H */
@@ -0,0 +1,265 @@
+/*
+ * gain_opt.c - Controller-side gain optimizer implementation
+ */
+
+#include "gain_opt.h"
+#include "common.h"
+#include <string.h>
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+static void measure_restart(gain_opt_t *go, uint32_t now_ms)
+{
+    go->snr_sum = 0.0;
+    go->noise_sum = 0.0;
+    go->samples = 0;
+    go->settle_until_ms = now_ms + GAIN_OPT_SETTLE_MS;
+}
+
+/* Move to a new setting: queue it for sending and measure afresh */
+static void apply(gain_opt_t *go, int gain, int lna, uint32_t now_ms)
+{
+    go->gain = gain;
+    go->lna = lna;
+    go->pending = true;
+    measure_restart(go, now_ms);
+}
+
+/* One step from the current setting. Less gain: IF reduction first, then
+ * LNA attenuation once IF is at its stop; more gain the reverse. */
+static bool step_setting(const gain_opt_t *go, int direction, int step_db, int *gain, int *lna)
+{
+    int g = go->gain;
+    int l = go->lna;
+    
+    if (direction > 0) {
+        if (g < go->gain_max) {
+            g = CLAMP(g + step_db, go->gain_min, go->gain_max);
+        } else if (l < go->lna_max) {
+            l++;
+        } else {
+            return false;
+        }
+    } else {
+        if (g > go->gain_min) {
+            g = CLAMP(g - step_db, go->gain_min, go->gain_max);
+        } else if (l > LNA_MIN) {
+            l--;
+        } else {
+            return false;
+        }
+    }
+    
+    *gain = g;
+    *lna = l;
+    return true;
+}
+
+/* Would this setting have as much gain as one that recently overloaded? */
+static bool above_ceiling(const gain_opt_t *go, int gain, int lna, uint32_t now_ms)
+{
+    if ((int32_t)(now_ms - go->ceil_until_ms) >= 0) return false;
+    return lna < go->ceil_lna || (lna == go->ceil_lna && gain <= go->ceil_gain);
+}
+
+/* Start a trial step from the current (just measured) setting */
+static void probe_start(gain_opt_t *go, uint32_t now_ms)
+{
+    for (int tries = 0; tries < 2; tries++) {
+        int gain, lna;
+        bool can_step = step_setting(go, go->direction, GAIN_OPT_STEP_DB, &gain, &lna);
+        
+        /* Below an overload point less gain has already lost: just wait */
+        if (can_step && go->direction < 0 && above_ceiling(go, gain, lna, now_ms)) {
+            break;
+        }
+        if (can_step) {
+            go->prev_gain = go->gain;
+            go->prev_lna = go->lna;
+            go->probing = true;
+            go->adjustments++;
+            LOG_DEBUG("Gain opt: trying GR %d LNA %d (SNR %.1f dB)", gain, lna, go->base_snr_db);
+            apply(go, gain, lna, now_ms);
+            return;
+        }
+        go->direction = -go->direction;
+    }
+    
+    /* Boxed in by limits or the overload ceiling */
+    go->hold_until_ms = now_ms + GAIN_OPT_HOLD_MS;
+}
+
+/* One optimizer step (enabled and running) */
+static void optimize(gain_opt_t *go, uint32_t now_ms)
+{
+    /* Overload: back off now, climb later */
+    if (go->overload) {
+        if (now_ms - go->last_overload_step_ms >= GAIN_OPT_OVERLOAD_STEP_MS) {
+            go->last_overload_step_ms = now_ms;
+            go->ceil_gain = go->gain;
+            go->ceil_lna = go->lna;
+            go->ceil_until_ms = now_ms + go->ceil_hold_ms;
+            go->probing = false;
+            go->direction = 1;
+            go->hold_until_ms = now_ms + GAIN_OPT_HOLD_MS;
+            
+            int gain, lna;
+            if (step_setting(go, 1, GAIN_OPT_OVERLOAD_STEP_DB, &gain, &lna)) {
+                LOG_INFO("Gain opt: overload, GR %d LNA %d -> GR %d LNA %d",
+                         go->gain, go->lna, gain, lna);
+                go->overload_steps++;
+                apply(go, gain, lna, now_ms);
+            } else {
+                LOG_WARN("Gain opt: overload at minimum gain");
+            }
+        }
+        return;
+    }
+    
+    if (go->samples < GAIN_OPT_SAMPLES) return;
+    
+    float snr = (float)(go->snr_sum / go->samples);
+    float noise = (float)(go->noise_sum / go->samples);
+    measure_restart(go, now_ms);
+    
+    if (go->probing) {
+        go->probing = false;
+        
+        /* More gain must pay for itself; less gain only must not cost SNR */
+        bool keep = (go->direction < 0) ? (snr >= go->base_snr_db + GAIN_OPT_IMPROVE_DB)
+                                        : (snr >= go->base_snr_db - GAIN_OPT_IMPROVE_DB);
+        if (keep) {
+            LOG_INFO("Gain opt: GR %d LNA %d kept (SNR %.1f -> %.1f dB)",
+                     go->gain, go->lna, go->base_snr_db, snr);
+            
+            /* Keep going the same way, measured against the run's start */
+            if (go->direction < 0) go->base_snr_db = snr;
+            go->base_noise_db = noise;
+            probe_start(go, now_ms);
+            return;
+        }
+        
+        /* Noise floor rose with the gain but SNR did not: band noise
+         * dominates, more gain will not help for a while */
+        bool noise_limited = (go->direction < 0 &&
+                              noise - go->base_noise_db >= 0.7f * GAIN_OPT_STEP_DB);
+        LOG_DEBUG("Gain opt: GR %d LNA %d rejected (SNR %.1f -> %.1f dB%s)", go->gain, go->lna,
+                  go->base_snr_db, snr, noise_limited ? ", noise limited" : "");
+        
+        go->direction = -go->direction;
+        go->hold_until_ms = now_ms + (noise_limited ? GAIN_OPT_NOISE_HOLD_MS : GAIN_OPT_HOLD_MS);
+        apply(go, go->prev_gain, go->prev_lna, now_ms);
+        return;
+    }
+    
+    /* Baseline for the next trial */
+    go->base_snr_db = snr;
+    go->base_noise_db = noise;
+    if ((int32_t)(now_ms - go->hold_until_ms) >= 0) {
+        probe_start(go, now_ms);
+    }
+}
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+void gain_opt_init(gain_opt_t *go, int gain, int lna)
+{
+    memset(go, 0, sizeof(*go));
+    go->gain = gain;
+    go->lna = lna;
+    go->gain_min = GAIN_MIN;
+    go->gain_max = GAIN_MAX;
+    go->lna_max = LNA_MAX;
+    go->direction = -1;
+}
+
+void gain_opt_enable(gain_opt_t *go, bool enable, uint32_t now_ms)
+{
+    if (go->enabled == enable) return;
+    
+    go->enabled = enable;
+    go->probing = false;
+    go->direction = -1;
+    go->hold_until_ms = now_ms;
+    measure_restart(go, now_ms);
+    LOG_INFO("Gain optimizer %s (GR %d, LNA %d)", enable ? "on" : "off", go->gain, go->lna);
+}
+
+void gain_opt_set_limits(gain_opt_t *go, int gain_min, int gain_max, int lna_max)
+{
+    go->gain_min = gain_min;
+    go->gain_max = gain_max;
+    go->lna_max = lna_max;
+}
+
+void gain_opt_request(gain_opt_t *go, int gain, int lna, uint32_t now_ms)
+{
+    /* Give the operator's choice a while before probing around it */
+    go->probing = false;
+    go->hold_until_ms = now_ms + GAIN_OPT_HOLD_MS;
+    apply(go, gain, lna, now_ms);
+}
+
+void gain_opt_sync(gain_opt_t *go, int gain, int lna, uint32_t now_ms)
+{
+    go->gain = gain;
+    go->lna = lna;
+    go->pending = false;
+    go->probing = false;
+    measure_restart(go, now_ms);
+}
+
+void gain_opt_add_channel(gain_opt_t *go, const telem_channel_t *chan, uint32_t now_ms)
+{
+    if (!chan || !chan->valid) return;
+    if (chan->last_update == go->last_chan_update) return;
+    go->last_chan_update = chan->last_update;
+    
+    if ((int32_t)(now_ms - go->settle_until_ms) < 0) return;
+    
+    go->snr_sum += chan->snr_db;
+    go->noise_sum += chan->noise_db;
+    go->samples++;
+}
+
+void gain_opt_set_overload(gain_opt_t *go, bool overload, uint32_t now_ms)
+{
+    /* New overload episode: first step at once */
+    if (overload && !go->overload) {
+        go->last_overload_step_ms = now_ms - GAIN_OPT_OVERLOAD_STEP_MS;
+        
+        /* Episodes that keep coming back keep the ceiling longer */
+        if (go->ceil_hold_ms != 0 &&
+            (int32_t)(now_ms - go->ceil_until_ms) < (int32_t)go->ceil_hold_ms) {
+            go->ceil_hold_ms = go->ceil_hold_ms * 2 > GAIN_OPT_CEILING_MAX_MS ?
+                               GAIN_OPT_CEILING_MAX_MS : go->ceil_hold_ms * 2;
+        } else {
+            go->ceil_hold_ms = GAIN_OPT_OVERLOAD_HOLD_MS;
+        }
+    }
+    go->overload = overload;
+}
+
+bool gain_opt_update(gain_opt_t *go, uint32_t now_ms, bool running, int *gain_out, int *lna_out)
+{
+    if (go->enabled && running) {
+        optimize(go, now_ms);
+    } else {
+        go->probing = false;
+        measure_restart(go, now_ms);
+    }
+    
+    /* Coalesce: send only the latest setting, at a bounded rate */
+    if (!go->pending || now_ms - go->last_cmd_ms < GAIN_OPT_CMD_INTERVAL_MS) {
+        return false;
+    }
+    go->pending = false;
+    go->last_cmd_ms = now_ms;
+    *gain_out = go->gain;
+    *lna_out = go->lna;
+    return true;
+}
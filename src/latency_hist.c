@@ -0,0 +1,104 @@
+/**
+ * Phoenix SDR Controller - Latency Histogram Implementation
+ */
+
+#include "latency_hist.h"
+#include <string.h>
+
+#define SUB_COUNT   (1u << LATENCY_HIST_SUB_BITS)
+#define SUB_MASK    (SUB_COUNT - 1)
+
+/* Position of the highest set bit (v > 0) */
+static int highest_bit(uint32_t v)
+{
+    int bit = 0;
+    while (v >>= 1) {
+        bit++;
+    }
+    return bit;
+}
+
+static int bucket_index(uint32_t us)
+{
+    if (us < SUB_COUNT) {
+        return (int)us;
+    }
+    
+    int shift = highest_bit(us) - LATENCY_HIST_SUB_BITS;
+    int index = ((shift + 1) << LATENCY_HIST_SUB_BITS) | (int)((us >> shift) & SUB_MASK);
+    return index < LATENCY_HIST_BUCKETS ? index : LATENCY_HIST_BUCKETS - 1;
+}
+
+/* Largest value that maps to bucket */
+static uint32_t bucket_upper(int index)
+{
+    if (index < (int)SUB_COUNT) {
+        return (uint32_t)index;
+    }
+    
+    int shift = (index >> LATENCY_HIST_SUB_BITS) - 1;
+    uint32_t low = ((uint32_t)(index & SUB_MASK) | SUB_COUNT) << shift;
+    return low + ((1u << shift) - 1);
+}
+
+void latency_hist_reset(latency_hist_t* hist)
+{
+    if (hist) {
+        memset(hist, 0, sizeof(*hist));
+    }
+}
+
+void latency_hist_record(latency_hist_t* hist, uint32_t us)
+{
+    if (!hist) return;
+    
+    SDL_AtomicAdd(&hist->counts[bucket_index(us)], 1);
+    SDL_AtomicAdd(&hist->total, 1);
+    
+    /* Lock-free max */
+    int old_max = SDL_AtomicGet(&hist->max_us);
+    while ((uint32_t)old_max < us &&
+           !SDL_AtomicCAS(&hist->max_us, old_max, (int)us)) {
+        old_max = SDL_AtomicGet(&hist->max_us);
+    }
+}
+
+void latency_hist_record_error(latency_hist_t* hist)
+{
+    if (hist) {
+        SDL_AtomicAdd(&hist->errors, 1);
+    }
+}
+
+uint32_t latency_hist_count(const latency_hist_t* hist)
+{
+    return hist ? (uint32_t)SDL_AtomicGet((SDL_atomic_t*)&hist->total) : 0;
+}
+
+uint32_t latency_hist_percentile(const latency_hist_t* hist, double percentile)
+{
+    uint32_t total = latency_hist_count(hist);
+    if (total == 0) return 0;
+    
+    /* Rank of the requested sample (1-based, rounded up) */
+    double rank_d = percentile / 100.0 * total;
+    uint32_t rank = (uint32_t)rank_d;
+    if ((double)rank < rank_d) rank++;
+    if (rank < 1) rank = 1;
+    
+    uint32_t seen = 0;
+    for (int i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        seen += (uint32_t)SDL_AtomicGet((SDL_atomic_t*)&hist->counts[i]);
+        if (seen >= rank) {
+            uint32_t upper = bucket_upper(i);
+            uint32_t max = latency_hist_max(hist);
+            return upper < max ? upper : max;
+        }
+    }
+    return latency_hist_max(hist);
+}
+
+uint32_t latency_hist_max(const latency_hist_t* hist)
+{
+    return hist ? (uint32_t)SDL_AtomicGet((SDL_atomic_t*)&hist->max_us) : 0;
+}
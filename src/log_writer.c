@@ -0,0 +1,214 @@
+/**
+ * Phoenix SDR Controller - Asynchronous Log Writer
+ *
+ * Bounded multi-producer ring: each record carries a sequence number that
+ * says whose turn it is. A producer claims a position by advancing head,
+ * fills the record and publishes it by setting its sequence; the writer
+ * thread consumes positions in order and hands records back one lap later.
+ */
+
+#include "log_writer.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+/* One queued message */
+typedef struct {
+    SDL_atomic_t seq;           /* pos: free for pos, pos + 1: holds pos */
+    uint8_t level;
+    char text[LOG_RECORD_LEN];
+} log_record_t;
+
+static struct {
+    log_record_t records[LOG_QUEUE_RECORDS];
+    SDL_atomic_t head;          /* Next position to claim */
+    uint32_t tail;              /* Next position to write (writer only) */
+    SDL_atomic_t running;       /* Producers queue while set */
+    SDL_atomic_t producers;     /* log_write calls between checking running and publishing */
+    SDL_atomic_t dropped;
+    uint32_t dropped_reported;
+    SDL_Thread* thread;
+    FILE* file;
+    bool file_tried;
+} g_log;
+
+static const char* level_tag(int level)
+{
+    switch (level) {
+        case LOG_LEVEL_DEBUG: return "[DEBUG] ";
+        case LOG_LEVEL_INFO:  return "[INFO] ";
+        case LOG_LEVEL_WARN:  return "[WARN] ";
+        default:              return "[ERROR] ";
+    }
+}
+
+static FILE* log_file(void)
+{
+    if (!g_log.file_tried) {
+        g_log.file_tried = true;
+        g_log.file = fopen(LOG_FILENAME, "a");
+        if (g_log.file) {
+            fprintf(g_log.file, "\n=== Session started ===\n");
+            fflush(g_log.file);
+        }
+    }
+    return g_log.file;
+}
+
+/* One line to the file and console (caller flushes the file) */
+static void emit(int level, const char* text)
+{
+    FILE* lf = log_file();
+    if (lf) fprintf(lf, "%s%s\n", level_tag(level), text);
+    fprintf(level == LOG_LEVEL_ERROR ? stderr : stdout, "%s%s\n", level_tag(level), text);
+}
+
+/* Format and write one line now, on the caller's thread */
+static void write_through(int level, const char* fmt, va_list args)
+{
+    char text[LOG_RECORD_LEN];
+    vsnprintf(text, sizeof(text), fmt, args);
+    emit(level, text);
+    if (g_log.file) fflush(g_log.file);
+}
+
+/* Write out every published record; returns the number written */
+static int drain(void)
+{
+    int count = 0;
+    
+    for (;;) {
+        log_record_t* rec = &g_log.records[g_log.tail & (LOG_QUEUE_RECORDS - 1)];
+        if ((uint32_t)SDL_AtomicGet(&rec->seq) != g_log.tail + 1) break;
+        SDL_MemoryBarrierAcquire();
+        
+        emit(rec->level, rec->text);
+        count++;
+        
+        /* Free for the producer one lap ahead */
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&rec->seq, (int)(g_log.tail + LOG_QUEUE_RECORDS));
+        g_log.tail++;
+    }
+    
+    uint32_t dropped = (uint32_t)SDL_AtomicGet(&g_log.dropped);
+    if (dropped != g_log.dropped_reported) {
+        char note[64];
+        snprintf(note, sizeof(note), "%u log messages dropped (queue full)",
+                 dropped - g_log.dropped_reported);
+        g_log.dropped_reported = dropped;
+        emit(LOG_LEVEL_WARN, note);
+        count++;
+    }
+    
+    if (count > 0) {
+        if (g_log.file) fflush(g_log.file);
+        fflush(stdout);
+    }
+    return count;
+}
+
+static int writer_thread(void* data)
+{
+    (void)data;
+    
+    while (SDL_AtomicGet(&g_log.running)) {
+        drain();
+        SDL_Delay(LOG_FLUSH_INTERVAL_MS);
+    }
+    drain();
+    return 0;
+}
+
+bool log_writer_start(void)
+{
+    if (g_log.thread) return true;
+    
+    for (uint32_t i = 0; i < LOG_QUEUE_RECORDS; i++) {
+        SDL_AtomicSet(&g_log.records[i].seq, (int)i);
+    }
+    SDL_AtomicSet(&g_log.head, 0);
+    g_log.tail = 0;
+    log_file();
+    
+    SDL_AtomicSet(&g_log.running, 1);
+    g_log.thread = SDL_CreateThread(writer_thread, "log_writer", NULL);
+    if (!g_log.thread) {
+        SDL_AtomicSet(&g_log.running, 0);
+        log_write(LOG_LEVEL_WARN, "Log writer thread failed (%s), logging synchronously",
+                  SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+void log_writer_stop(void)
+{
+    if (!g_log.thread) return;
+    
+    SDL_AtomicSet(&g_log.running, 0);
+    
+    /* Let producers that saw the writer running finish publishing */
+    while (SDL_AtomicGet(&g_log.producers) != 0) {
+        SDL_Delay(1);
+    }
+    SDL_WaitThread(g_log.thread, NULL);
+    g_log.thread = NULL;
+    
+    /* Anything queued while the writer was exiting */
+    drain();
+}
+
+/* Queue one message; false if it should be written through instead */
+static bool enqueue(log_level_t level, const char* fmt, va_list args)
+{
+    /* No writer: write through, as before it existed */
+    if (!SDL_AtomicGet(&g_log.running)) return false;
+    
+    /* Claim a position whose record the writer has handed back */
+    log_record_t* rec;
+    uint32_t pos = (uint32_t)SDL_AtomicGet(&g_log.head);
+    for (;;) {
+        rec = &g_log.records[pos & (LOG_QUEUE_RECORDS - 1)];
+        int32_t diff = (int32_t)((uint32_t)SDL_AtomicGet(&rec->seq) - pos);
+        if (diff == 0) {
+            if (SDL_AtomicCAS(&g_log.head, (int)pos, (int)(pos + 1))) break;
+        } else if (diff < 0) {
+            /* Writer a full lap behind: errors are worth the wait */
+            if (level == LOG_LEVEL_ERROR) return false;
+            SDL_AtomicAdd(&g_log.dropped, 1);
+            return true;
+        }
+        pos = (uint32_t)SDL_AtomicGet(&g_log.head);
+    }
+    
+    rec->level = (uint8_t)level;
+    vsnprintf(rec->text, sizeof(rec->text), fmt, args);
+    
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&rec->seq, (int)(pos + 1));
+    return true;
+}
+
+void log_write(log_level_t level, const char* fmt, ...)
+{
+    va_list args;
+    
+    SDL_AtomicIncRef(&g_log.producers);
+    va_start(args, fmt);
+    bool queued = enqueue(level, fmt, args);
+    va_end(args);
+    SDL_AtomicAdd(&g_log.producers, -1);
+    
+    if (!queued) {
+        va_start(args, fmt);
+        write_through(level, fmt, args);
+        va_end(args);
+    }
+}
+
+uint32_t log_writer_dropped(void)
+{
+    return (uint32_t)SDL_AtomicGet(&g_log.dropped);
+}
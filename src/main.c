@@ -15,17 +15,32 @@
 #include "udp_telemetry.h"
 #include "pn_discovery.h"
 #include "aff.h"
+#include "reconnect.h"
+#include "scan.h"
+#include "gain_opt.h"
+#include "snapshot.h"
 #include "bdc/bcd_decoder.h"
 
 #include <SDL.h>
 
 /* Timing constants */
-#define STATUS_POLL_INTERVAL_MS  500
 #define KEEPALIVE_INTERVAL_MS    60000
+#define AFF_MODEL_SAVE_MS        600000     /* Flush learned AFF samples */
 
 /* Relay mode port */
 #define RELAY_CONTROL_PORT 3001
 
+/* Post-connect handshake steps, one server round trip per frame */
+typedef enum {
+    HANDSHAKE_NONE = 0,         /* TCP connect in progress (or idle) */
+    HANDSHAKE_VERSION,
+    HANDSHAKE_BINARY,
+    HANDSHAKE_CAPS,
+    HANDSHAKE_REPLAY,           /* Reconnects only */
+    HANDSHAKE_STATUS,
+    HANDSHAKE_SUBSCRIBE
+} handshake_step_t;
+
 /* Application context */
 typedef struct {
     tcp_client_t* tcp;
@@ -36,8 +51,24 @@ typedef struct {
     process_manager_t proc_mgr;
     udp_telemetry_t* telemetry;
     aff_state_t* aff;
+    aff_model_t* aff_model;
     bcd_decoder_t* bcd_decoder;
-    uint32_t last_bcd_update;  /* Track last processed BCD1 timestamp */
+    uint32_t last_bcd_update;  /* Track last processed BCDS symbol timestamp */
+    uint32_t last_aff_update[AFF_SOURCE_COUNT];  /* Last telemetry fed to AFF estimator */
+    uint32_t last_aff_model_save;
+    reconnect_t reconnect;     /* Automatic reconnection after link loss */
+    handshake_step_t handshake; /* Next handshake step while CONN_CONNECTING */
+    scan_t* scan;              /* WWV band scan (F5) */
+    gain_opt_t gain_opt;       /* Gain optimizer (F7) and gain/LNA command coalescing */
+    
+    /* Published versions for the render pass (producers write state/telemetry,
+     * drawing reads only the view copies taken once per frame) */
+    snapshot_t state_snap;
+    snapshot_t telem_snap;
+    app_state_t view_state;
+    udp_telemetry_t view_telem;
+    uint32_t view_state_version;
+    uint32_t view_telem_version;
 } app_context_t;
 
 /* Forward declarations */
@@ -45,7 +76,13 @@ static bool app_init(app_context_t* app);
 static void app_shutdown(app_context_t* app);
 static void app_handle_actions(app_context_t* app, const ui_actions_t* actions);
 static void app_periodic_tasks(app_context_t* app);
+static void app_scan_poll(app_context_t* app, uint32_t now);
+static void app_gain_poll(app_context_t* app, uint32_t now);
+static void app_publish(app_context_t* app);
+static void app_read_view(app_context_t* app);
 static void app_connect(app_context_t* app);
+static void app_connect_poll(app_context_t* app);
+static void app_link_lost(app_context_t* app, const char* reason);
 static void app_disconnect(app_context_t* app);
 
 /* Phoenix Discovery callback - called when sdr_server is discovered */
@@ -107,19 +144,32 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
             }
         }
     }
+    
+    /* Parse --time-shm flag (publish decoded time to NTP SHM unit N) */
+    int time_shm_unit = -1;
+    if (lpCmdLine && lpCmdLine[0]) {
+        char* shm_arg = strstr(lpCmdLine, "--time-shm");
+        if (shm_arg) {
+            time_shm_unit = atoi(shm_arg + 10);
+        }
+    }
 #else
 int main(int argc, char* argv[])
 {
-    /* Parse --relay flag from command line */
+    /* Parse --relay and --time-shm flags from command line */
     char relay_host[256] = {0};
+    int time_shm_unit = -1;
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--relay") == 0 && i + 1 < argc) {
-            strncpy(relay_host, argv[i + 1], 255);
-            break;
+            strncpy(relay_host, argv[++i], 255);
+        } else if (strcmp(argv[i], "--time-shm") == 0 && i + 1 < argc) {
+            time_shm_unit = atoi(argv[++i]);
         }
     }
 #endif
     
+    /* Log from here on goes through the background writer */
+    log_writer_start();
     LOG_INFO("Phoenix SDR Controller v%s starting", APP_VERSION);
     
     /* Initialize application context */
@@ -128,6 +178,7 @@ int main(int argc, char* argv[])
     if (!app_init(&app)) {
         LOG_ERROR("Application initialization failed");
         app_shutdown(&app);
+        log_writer_stop();
         return 1;
     }
     
@@ -138,6 +189,11 @@ int main(int argc, char* argv[])
         LOG_INFO("Relay mode: connecting to %s:%d", relay_host, RELAY_CONTROL_PORT);
     }
     
+    /* Serve BCD-disciplined time as an NTP/chrony SHM refclock */
+    if (time_shm_unit >= 0 && app.bcd_decoder) {
+        bcd_clock_enable_shm(bcd_decoder_get_clock(app.bcd_decoder), time_shm_unit);
+    }
+    
     LOG_INFO("Application initialized successfully");
     
     /* Main event loop */
@@ -155,8 +211,8 @@ int main(int argc, char* argv[])
             ui_layout_recalculate(app.layout);
         }
         
-        /* Sync UI state from app state */
-        ui_layout_sync_state(app.layout, app.state);
+        /* Sync UI state from last frame's view (controls reflect what was drawn) */
+        ui_layout_sync_state(app.layout, &app.view_state);
         
         /* Sync process button states */
         ui_layout_sync_process_state(app.layout, &app.proc_mgr);
@@ -208,6 +264,46 @@ int main(int argc, char* argv[])
             }
         }
         
+        /* F5: Start/stop WWV band scan */
+        if (app.ui->last_key == SDLK_F5 && app.scan) {
+            if (scan_is_active(app.scan)) {
+                scan_stop(app.scan);
+                snprintf(app.state->status_message, sizeof(app.state->status_message),
+                         "Scan stopped");
+            } else if (sdr_is_connected(app.proto)) {
+                scan_start(app.scan);
+            }
+        }
+        
+        /* F6: Toggle automatic best-band selection */
+        if (app.ui->last_key == SDLK_F6 && app.scan) {
+            if (scan_auto_is_enabled(app.scan)) {
+                int64_t home = scan_auto_stop(app.scan);
+                if (home != 0 && sdr_is_connected(app.proto)) {
+                    /* Stopped mid-probe: go back to the home band */
+                    int64_t actual_freq = home + (app.state->dc_offset_enabled ? DC_OFFSET_HZ : 0);
+                    if (sdr_set_freq(app.proto, actual_freq)) {
+                        app.state->frequency = home;
+                    }
+                }
+                snprintf(app.state->status_message, sizeof(app.state->status_message),
+                         "Auto band off");
+            } else {
+                scan_auto_start(app.scan, app.state->frequency, ui_get_ticks());
+                snprintf(app.state->status_message, sizeof(app.state->status_message),
+                         "Auto band on: home %s", app_format_frequency(app.state->frequency));
+            }
+        }
+        
+        /* F7: Toggle gain optimizer */
+        if (app.ui->last_key == SDLK_F7) {
+            bool enable = !app.gain_opt.enabled;
+            gain_opt_enable(&app.gain_opt, enable, ui_get_ticks());
+            snprintf(app.state->status_message, sizeof(app.state->status_message),
+                     enable && app.state->agc != AGC_OFF ? "Gain optimizer on (waits for AGC OFF)" :
+                     enable ? "Gain optimizer on" : "Gain optimizer off");
+        }
+        
         /* Debug: Toggle overload with 'O' key for testing */
         if (app.ui->last_key == SDLK_o) {
             app.state->overload = !app.state->overload;
@@ -217,15 +313,22 @@ int main(int argc, char* argv[])
         /* Poll UDP telemetry */
         if (app.telemetry) {
             udp_telemetry_poll(app.telemetry);
-            ui_layout_sync_telemetry(app.layout, app.telemetry);
+            
+            /* Per-dwell channel SNR and schedule match for the band scan */
+            if (app.scan) {
+                scan_add_channel(app.scan, &app.telemetry->channel, ui_get_ticks());
+                scan_add_subcarrier(app.scan, &app.telemetry->subcarrier, ui_get_ticks());
+            }
+            gain_opt_add_channel(&app.gain_opt, &app.telemetry->channel, ui_get_ticks());
             
             /* Feed BCD symbols to frame assembler when NEW symbols arrive */
+            /* (STATUS/TIME/FREQ also refresh BCDS; only SYM/CORR carry a symbol) */
             if (app.bcd_decoder && app.telemetry->bcds.valid &&
-                app.telemetry->bcds.last_update != app.last_bcd_update) {
+                app.telemetry->bcds.last_symbol_update != app.last_bcd_update) {
                 
-                app.last_bcd_update = app.telemetry->bcds.last_update;
+                app.last_bcd_update = app.telemetry->bcds.last_symbol_update;
                 
-                /* Only process if we have a symbol (not just STATUS update) */
+                /* Only process if we have a symbol */
                 if (app.telemetry->bcds.last_symbol != 0) {
                     /* Debug: log first symbol */
                     static bool first_sym = true;
@@ -250,8 +353,28 @@ int main(int argc, char* argv[])
             }
 
             
+            /* Feed new offset measurements to the AFF estimator (Kalman/fast modes) */
+            /* AFF holds while auto band is away probing another band */
+            bool aff_hold = scan_is_probing(app.scan);
+            
+            if (app.aff && !aff_hold && aff_get_mode(app.aff) != AFF_MODE_STEP) {
+                udp_telemetry_t* t = app.telemetry;
+                
+                if (t->sync.valid && t->sync.state == SYNC_LOCKED &&
+                    t->sync.last_update != app.last_aff_update[AFF_SOURCE_SYNC]) {
+                    app.last_aff_update[AFF_SOURCE_SYNC] = t->sync.last_update;
+                    aff_update_offset(app.aff, AFF_SOURCE_SYNC, t->sync.delta_ms, t->channel.snr_db);
+                }
+                if (t->carrier.valid && t->carrier.measurement_valid &&
+                    t->carrier.last_update != app.last_aff_update[AFF_SOURCE_CARRIER]) {
+                    app.last_aff_update[AFF_SOURCE_CARRIER] = t->carrier.last_update;
+                    aff_update_offset(app.aff, AFF_SOURCE_CARRIER, t->carrier.offset_hz, t->carrier.snr_db);
+                }
+            }
+            
             /* Feed SYNC data to AFF when available */
-            if (app.aff && app.telemetry->sync.valid) {
+            if (app.aff && !aff_hold && (app.telemetry->sync.valid ||
+                                         aff_get_mode(app.aff) != AFF_MODE_STEP)) {
                 bool is_locked = (app.telemetry->sync.state == SYNC_LOCKED);
                 aff_update(app.aff, app.telemetry->sync.delta_ms, 
                           app.state->frequency, is_locked);
@@ -270,6 +393,10 @@ int main(int argc, char* argv[])
                             snprintf(app.state->status_message, 
                                     sizeof(app.state->status_message),
                                     "AFF: %+d Hz", adjustment_hz);
+                            
+                            /* Persist the corrected tuning now, so a crash or
+                             * kill cannot lead to the correction being re-applied */
+                            aff_model_save(app.aff_model, AFF_MODEL_FILENAME);
                         }
                     } else {
                         /* Not connected - just update local state */
@@ -285,15 +412,26 @@ int main(int argc, char* argv[])
             if (app.aff) {
                 app.layout->toggle_aff.value = aff_is_enabled(app.aff);
                 app.layout->aff_interval_value = aff_get_interval(app.aff);
+                app.layout->aff_mode_value = aff_get_mode(app.aff);
             }
         }
         
+        /* Publish this frame's state and take the consistent view to draw */
+        app_publish(&app);
+        app_read_view(&app);
+        if (app.telemetry) {
+            ui_layout_sync_telemetry(app.layout, &app.view_telem);
+        }
+        
         /* Draw UI */
-        ui_layout_draw(app.layout, app.state);
+        ui_layout_draw(app.layout, &app.view_state);
+        
+        /* Draw AFF drift history */
+        ui_layout_draw_aff_panel(app.layout, app.aff);
         
         /* Draw WWV telemetry panel (overlays main UI) */
         if (app.telemetry) {
-            ui_layout_draw_wwv_panel(app.layout, app.telemetry);
+            ui_layout_draw_wwv_panel(app.layout, &app.view_telem);
         }
         
         /* Draw BCD time code panel - use local frame assembler */
@@ -304,21 +442,22 @@ int main(int argc, char* argv[])
         
         /* Draw Tick Correlation panel */
         if (app.telemetry) {
-            ui_layout_draw_corr_panel(app.layout, app.telemetry);
+            ui_layout_draw_corr_panel(app.layout, &app.view_telem);
         }
         
         /* Draw Sync Status panel */
         if (app.telemetry) {
-            ui_layout_draw_sync_panel(app.layout, app.telemetry);
+            ui_layout_draw_sync_panel(app.layout, &app.view_telem);
         }
         
         /* Draw Minute Marker panel */
         if (app.telemetry) {
-            ui_layout_draw_mark_panel(app.layout, app.telemetry);
+            ui_layout_draw_mark_panel(app.layout, &app.view_telem);
         }
         
         /* Draw debug overlay (F1 to toggle) */
         ui_layout_draw_debug(app.layout);
+        ui_layout_draw_latency(app.layout, app.proto);
         
         /* End frame - present */
         ui_core_end_frame(app.ui);
@@ -330,6 +469,7 @@ int main(int argc, char* argv[])
     app_shutdown(&app);
     
     LOG_INFO("Phoenix SDR Controller exiting");
+    log_writer_stop();
     return 0;
 }
 
@@ -370,6 +510,9 @@ static bool app_init(app_context_t* app)
         LOG_INFO("Loaded presets from %s", PRESETS_FILENAME);
     }
     
+    /* Socket options ([Network] section) */
+    tcp_client_load_options(app->tcp, PRESETS_FILENAME);
+    
     /* Initialize UI */
     char title[128];
     snprintf(title, sizeof(title), "%s v%s", APP_NAME, APP_VERSION);
@@ -406,16 +549,46 @@ static bool app_init(app_context_t* app)
         }
     }
     
+    reconnect_init(&app->reconnect, ui_get_ticks());
+    gain_opt_init(&app->gain_opt, app->state->gain, app->state->lna);
+    
+    /* Render-side snapshots (first view is the startup state) */
+    if (!snapshot_init(&app->state_snap, sizeof(app_state_t)) ||
+        !snapshot_init(&app->telem_snap, sizeof(udp_telemetry_t))) {
+        LOG_ERROR("Failed to create state snapshots");
+        return false;
+    }
+    app_publish(app);
+    app_read_view(app);
+    
     /* Initialize AFF module */
     app->aff = aff_create();
     if (!app->aff) {
         LOG_WARN("Failed to create AFF module");
     }
     
+    /* Learned oscillator model; receiver is selected on connect */
+    app->aff_model = aff_model_create();
+    if (app->aff_model) {
+        aff_model_load(app->aff_model, AFF_MODEL_FILENAME);
+        aff_set_model(app->aff, app->aff_model);
+    }
+    
+    app->scan = scan_create();
+    if (!app->scan) {
+        LOG_WARN("Failed to create band scanner");
+    } else if (scan_load_config(app->scan, PRESETS_FILENAME) && scan_config_auto(app->scan)) {
+        scan_auto_start(app->scan, app->state->frequency, ui_get_ticks());
+    }
+    
     /* Initialize BCD decoder */
     app->bcd_decoder = bcd_decoder_create();
     if (!app->bcd_decoder) {
         LOG_WARN("Failed to create BCD decoder");
+    } else {
+        /* Keep decoding through modem sync glitches */
+        bcd_decoder_set_phase_search(app->bcd_decoder, true);
+        bcd_decoder_load_config(app->bcd_decoder, PRESETS_FILENAME);
     }
     
     /* Initialize Phoenix Discovery for sdr_server auto-discovery */
@@ -445,16 +618,18 @@ static void app_shutdown(app_context_t* app)
         aff_destroy(app->aff);
         app->aff = NULL;
     }
-    
-    /* Shutdown BCD decoder */
-    if (app->bcd_decoder) {
-        bcd_decoder_destroy(app->bcd_decoder);
-        app->bcd_decoder = NULL;
+    if (app->aff_model) {
+        aff_model_save(app->aff_model, AFF_MODEL_FILENAME);
+        aff_model_destroy(app->aff_model);
+        app->aff_model = NULL;
     }
     
     /* Shutdown Phoenix Discovery */
     pn_discovery_shutdown();
     
+    snapshot_free(&app->state_snap);
+    snapshot_free(&app->telem_snap);
+    
     /* Shutdown UDP telemetry */
     if (app->telemetry) {
         udp_telemetry_destroy(app->telemetry);
@@ -488,7 +663,27 @@ static void app_shutdown(app_context_t* app)
     /* Save process config AFTER presets (it appends to the file) */
     process_manager_save_config(&app->proc_mgr, PRESETS_FILENAME);
     
+    /* Network options likewise */
+    if (app->tcp) {
+        tcp_client_save_options(app->tcp, PRESETS_FILENAME);
+    }
+    
+    /* Scan options likewise */
+    if (app->scan) {
+        scan_save_config(app->scan, PRESETS_FILENAME);
+        scan_destroy(app->scan);
+        app->scan = NULL;
+    }
+    
+    /* BCD options likewise */
+    if (app->bcd_decoder) {
+        bcd_decoder_save_config(app->bcd_decoder, PRESETS_FILENAME);
+        bcd_decoder_destroy(app->bcd_decoder);
+        app->bcd_decoder = NULL;
+    }
+    
     if (app->proto) {
+        sdr_dump_latency(app->proto, LATENCY_FILENAME);
         sdr_protocol_destroy(app->proto);
         app->proto = NULL;
     }
@@ -511,7 +706,11 @@ static void app_handle_actions(app_context_t* app, const ui_actions_t* actions)
     
     /* Connection actions */
     if (actions->connect_clicked) {
-        app_connect(app);
+        if (app->state->conn_state == CONN_CONNECTING) {
+            app_disconnect(app);  /* Cancel */
+        } else {
+            app_connect(app);
+        }
     }
     
     if (actions->disconnect_clicked) {
@@ -638,6 +837,7 @@ static void app_handle_actions(app_context_t* app, const ui_actions_t* actions)
     if (actions->freq_changed) {
         /* Reset AFF when user manually changes frequency */
         if (app->aff) aff_reset(app->aff);
+        scan_stop(app->scan);
         
         /* Apply DC offset when sending to server if enabled */
         int64_t actual_freq = actions->new_frequency + 
@@ -652,6 +852,7 @@ static void app_handle_actions(app_context_t* app, const ui_actions_t* actions)
     if (actions->freq_up) {
         /* Reset AFF when user manually changes frequency */
         if (app->aff) aff_reset(app->aff);
+        scan_stop(app->scan);
         
         int64_t new_display_freq = app->state->frequency + (int64_t)app->state->tuning_step;
         int64_t actual_freq = new_display_freq + 
@@ -664,6 +865,7 @@ static void app_handle_actions(app_context_t* app, const ui_actions_t* actions)
     if (actions->freq_down) {
         /* Reset AFF when user manually changes frequency */
         if (app->aff) aff_reset(app->aff);
+        scan_stop(app->scan);
         
         int64_t new_display_freq = app->state->frequency - (int64_t)app->state->tuning_step;
         int64_t actual_freq = new_display_freq + 
@@ -677,6 +879,7 @@ static void app_handle_actions(app_context_t* app, const ui_actions_t* actions)
     if (actions->wwv_clicked) {
         /* Reset AFF when user manually changes frequency */
         if (app->aff) aff_reset(app->aff);
+        scan_stop(app->scan);
         
         int64_t display_freq = actions->wwv_frequency;
         /* Apply DC offset when sending to server if enabled */
@@ -709,6 +912,7 @@ static void app_handle_actions(app_context_t* app, const ui_actions_t* actions)
         } else {
             /* Click = Recall preset */
             if (app_recall_preset(app->state, slot)) {
+                scan_stop(app->scan);
                 /* Apply preset settings to server if connected */
                 if (sdr_is_connected(app->proto)) {
                     /* Apply DC offset to frequency when sending */
@@ -734,19 +938,15 @@ static void app_handle_actions(app_context_t* app, const ui_actions_t* actions)
         }
     }
     
-    /* Gain control - always update local state, send to server if connected */
+    /* Gain control - always update local state; sent coalesced while connected */
     if (actions->gain_changed) {
         app->state->gain = actions->new_gain;
-        if (sdr_is_connected(app->proto)) {
-            sdr_set_gain(app->proto, actions->new_gain);
-        }
+        gain_opt_request(&app->gain_opt, app->state->gain, app->state->lna, ui_get_ticks());
     }
     
     if (actions->lna_changed) {
         app->state->lna = actions->new_lna;
-        if (sdr_is_connected(app->proto)) {
-            sdr_set_lna(app->proto, actions->new_lna);
-        }
+        gain_opt_request(&app->gain_opt, app->state->gain, app->state->lna, ui_get_ticks());
     }
     
     /* AGC control */
@@ -777,14 +977,25 @@ static void app_handle_actions(app_context_t* app, const ui_actions_t* actions)
         app->state->antenna = actions->new_antenna;
         LOG_INFO("Antenna changed to %d", actions->new_antenna);
         
-        /* Hi-Z antenna has reduced LNA states (0-4 vs 0-8 for A/B) */
-        if (actions->new_antenna == ANTENNA_HIZ) {
-            if (app->state->lna > LNA_MAX_HIZ) {
-                app->state->lna = LNA_MAX_HIZ;
-                LOG_INFO("LNA clamped to %d for Hi-Z antenna", LNA_MAX_HIZ);
-                if (sdr_is_connected(app->proto)) {
-                    sdr_set_lna(app->proto, app->state->lna);
-                }
+        /* Some antennas have fewer LNA states (RSP2 Hi-Z: 0-4 vs 0-8 for A/B) */
+        int lna_max = sdr_caps_lna_max(&app->proto->caps, actions->new_antenna);
+        if (app->state->lna > lna_max) {
+            app->state->lna = lna_max;
+            LOG_INFO("LNA clamped to %d for antenna %s", lna_max,
+                     antenna_to_string(actions->new_antenna));
+            if (sdr_is_connected(app->proto)) {
+                sdr_set_lna(app->proto, app->state->lna);
+            }
+        }
+        
+        int gain_min, gain_max;
+        sdr_caps_gain_range(&app->proto->caps, actions->new_antenna, &gain_min, &gain_max);
+        if (app->state->gain < gain_min || app->state->gain > gain_max) {
+            app->state->gain = CLAMP(app->state->gain, gain_min, gain_max);
+            LOG_INFO("Gain clamped to %d for antenna %s", app->state->gain,
+                     antenna_to_string(actions->new_antenna));
+            if (sdr_is_connected(app->proto)) {
+                sdr_set_gain(app->proto, app->state->gain);
             }
         }
         
@@ -833,6 +1044,23 @@ static void app_handle_actions(app_context_t* app, const ui_actions_t* actions)
         }
     }
     
+    if (actions->aff_mode_cycle) {
+        aff_mode_t mode = (aff_get_mode(app->aff) + 1) % AFF_MODE_COUNT;
+        aff_set_mode(app->aff, mode);
+        snprintf(app->state->status_message, sizeof(app->state->status_message),
+                 "AFF mode: %s", aff_mode_string(mode));
+    }
+    
+    if (actions->aff_export && app->aff) {
+        if (aff_export_history_csv(app->aff, AFF_HISTORY_CSV_FILENAME)) {
+            snprintf(app->state->status_message, sizeof(app->state->status_message),
+                     "AFF history saved to %s", AFF_HISTORY_CSV_FILENAME);
+        } else {
+            snprintf(app->state->status_message, sizeof(app->state->status_message),
+                     "AFF history export failed");
+        }
+    }
+    
     if (actions->aff_interval_inc) {
         int current = aff_get_interval(app->aff);
         if (current < AFF_INTERVAL_120S) {
@@ -852,16 +1080,18 @@ static void app_periodic_tasks(app_context_t* app)
     
     uint32_t now = ui_get_ticks();
     
-    if (sdr_is_connected(app->proto)) {
-        /* Status polling */
-        if (now - app->state->last_status_update >= STATUS_POLL_INTERVAL_MS) {
+    app_connect_poll(app);
+    
+    if (app->state->conn_state == CONN_CONNECTED && sdr_is_connected(app->proto)) {
+        /* Status: pushed by the server, or polled adaptively */
+        if (sdr_poll_status(app->proto, now)) {
             app->state->last_status_update = now;
-            
-            if (sdr_get_status(app->proto)) {
-                app_state_update_from_sdr(app->state, &app->proto->status);
-            }
+            app_state_update_from_sdr(app->state, &app->proto->status);
         }
         
+        app_scan_poll(app, now);
+        app_gain_poll(app, now);
+        
         /* Keepalive ping (when not actively polling) */
         if (!app->state->streaming && 
             now - app->state->last_keepalive >= KEEPALIVE_INTERVAL_MS) {
@@ -869,16 +1099,196 @@ static void app_periodic_tasks(app_context_t* app)
             
             if (!sdr_ping(app->proto)) {
                 LOG_WARN("Keepalive ping failed");
-                app->state->conn_state = CONN_ERROR;
-                snprintf(app->state->status_message, sizeof(app->state->status_message),
-                         "Connection lost");
+                app_link_lost(app, "keepalive ping failed");
             }
         }
+    } else if (app->state->conn_state == CONN_CONNECTED) {
+        /* Link dropped under us (server closed, send/recv failed) */
+        app_link_lost(app, tcp_client_get_error(app->tcp));
+    }
+    
+    /* Automatic reconnection */
+    if (app->state->conn_state != CONN_CONNECTING &&
+        reconnect_due(&app->reconnect, now)) {
+        LOG_INFO("Reconnect attempt %d", app->reconnect.attempts);
+        app_connect(app);
+    }
+    
+    /* Learned AFF samples: flush periodically, not only at shutdown */
+    if (app->aff_model && now - app->last_aff_model_save >= AFF_MODEL_SAVE_MS) {
+        app->last_aff_model_save = now;
+        aff_model_save(app->aff_model, AFF_MODEL_FILENAME);
+    }
+    
+    /* Disciplined clock: write NTP SHM samples, if enabled */
+    if (app->bcd_decoder) {
+        bcd_clock_poll(bcd_decoder_get_clock(app->bcd_decoder));
+    }
+}
+
+/*
+ * Advance the band scan / auto band: retune on dwell boundaries and probes
+ */
+static void app_scan_poll(app_context_t* app, uint32_t now)
+{
+    bool sweeping = scan_is_active(app->scan);
+    if (!sweeping && !scan_auto_is_enabled(app->scan)) return;
+    
+    /* Manual retunes re-home auto band; AFF corrections are followed */
+    scan_auto_track(app->scan, app->state->frequency, now);
+    
+    /* Issue the retune one median SET_FREQ round trip before the dwell ends */
+    uint32_t lead_ms = latency_hist_percentile(sdr_get_latency(app->proto, SDR_VERB_SET_FREQ), 50) / 1000;
+    
+    int64_t display_freq = 0;
+    scan_action_t action = scan_poll(app->scan, now, lead_ms, &display_freq);
+    if (action == SCAN_IDLE) {
+        if (sweeping && !scan_is_active(app->scan)) {
+            snprintf(app->state->status_message, sizeof(app->state->status_message),
+                     "Scan done: no usable telemetry");
+        }
+        return;
+    }
+    
+    /* New home band: the radio is already there */
+    if (action == SCAN_SWITCH) {
+        if (app->aff) aff_reset(app->aff);
+        snprintf(app->state->status_message, sizeof(app->state->status_message),
+                 "Auto band: moved to %s", app_format_frequency(display_freq));
+        return;
+    }
+    
+    /* Auto band probes leave AFF alone; it resumes on return home */
+    if (app->aff && !scan_auto_is_enabled(app->scan)) aff_reset(app->aff);
+    int64_t actual_freq = display_freq + (app->state->dc_offset_enabled ? DC_OFFSET_HZ : 0);
+    if (!sdr_set_freq(app->proto, actual_freq)) {
+        LOG_WARN("Scan: retune to %lld Hz failed: %s", (long long)display_freq,
+                 sdr_get_error_msg(app->proto));
+        scan_tune_failed(app->scan, now);
+        return;
+    }
+    app->state->frequency = display_freq;
+    
+    if (!sweeping) {
+        snprintf(app->state->status_message, sizeof(app->state->status_message),
+                 scan_is_probing(app->scan) ? "Auto band: probing %s" : "Auto band: home %s",
+                 app_format_frequency(display_freq));
+        return;
+    }
+    
+    if (action == SCAN_TUNE) {
+        int index = 0, count = 0;
+        scan_get_progress(app->scan, &index, &count, NULL);
+        snprintf(app->state->status_message, sizeof(app->state->status_message),
+                 "Scan: %s (%d/%d)", app_format_frequency(display_freq), index + 1, count);
+        return;
+    }
+    
+    scan_result_t ranking[SCAN_MAX_FREQS];
+    int n = scan_get_ranking(app->scan, now, ranking, SCAN_MAX_FREQS);
+    for (int i = 0; i < n; i++) {
+        LOG_INFO("Scan rank %d: %.3f MHz score %.1f dB (%d dwells)", i + 1,
+                 ranking[i].freq_hz / 1e6, ranking[i].score_db, ranking[i].dwells);
+    }
+    snprintf(app->state->status_message, sizeof(app->state->status_message),
+             "Scan done: best %s (%.1f dB)", app_format_frequency(display_freq), ranking[0].score_db);
+}
+
+/*
+ * Gain optimizer: feed overload state, send coalesced gain/LNA settings
+ */
+static void app_gain_poll(app_context_t* app, uint32_t now)
+{
+    gain_opt_t* go = &app->gain_opt;
+    sdr_status_t* st = &app->proto->status;
+    
+    int gain_min, gain_max;
+    sdr_caps_gain_range(&app->proto->caps, app->state->antenna, &gain_min, &gain_max);
+    gain_opt_set_limits(go, gain_min, gain_max, sdr_caps_lna_max(&app->proto->caps, app->state->antenna));
+    gain_opt_set_overload(go, st->overload, now);
+    
+    /* Changed elsewhere (hardware AGC, antenna clamp, reconnect replay) */
+    if (!go->pending && (st->gain != go->gain || st->lna != go->lna)) {
+        gain_opt_sync(go, st->gain, st->lna, now);
+    }
+    
+    /* Telemetry only describes the home band while streaming there */
+    bool running = app->state->streaming && app->state->agc == AGC_OFF &&
+                   !scan_is_active(app->scan) && !scan_is_probing(app->scan);
+    
+    int gain, lna;
+    if (!gain_opt_update(go, now, running, &gain, &lna)) return;
+    
+    if (sdr_set_gain_lna(app->proto, gain, lna)) {
+        app->state->gain = gain;
+        app->state->lna = lna;
+    } else {
+        LOG_WARN("Gain/LNA update failed: %s", sdr_get_error_msg(app->proto));
+        gain_opt_sync(go, st->gain, st->lna, now);
+        app->state->gain = st->gain;
+        app->state->lna = st->lna;
+    }
+}
+
+/*
+ * Publish the current app state and telemetry as new immutable versions
+ */
+static void app_publish(app_context_t* app)
+{
+    snapshot_publish(&app->state_snap, app->state);
+    if (app->telemetry) {
+        snapshot_publish(&app->telem_snap, app->telemetry);
+    }
+}
+
+/*
+ * Take one consistent view of state and telemetry for this frame.
+ * Nothing new (or a producer that lapped the reader) keeps the previous view.
+ */
+static void app_read_view(app_context_t* app)
+{
+    snapshot_read(&app->state_snap, &app->view_state, &app->view_state_version);
+    snapshot_read(&app->telem_snap, &app->view_telem, &app->view_telem_version);
+}
+
+/*
+ * Connection attempt failed (schedules the next try while reconnecting)
+ */
+static void app_connect_failed(app_context_t* app)
+{
+    app->state->conn_state = CONN_ERROR;
+    LOG_ERROR("Connection failed: %s", tcp_client_get_error(app->tcp));
+    
+    if (app->reconnect.active) {
+        uint32_t delay = reconnect_failed(&app->reconnect, ui_get_ticks());
+        snprintf(app->state->status_message, sizeof(app->state->status_message),
+                 "Reconnect failed: %s - retrying in %.1f s",
+                 tcp_client_get_error(app->tcp), delay / 1000.0);
+    } else {
+        snprintf(app->state->status_message, sizeof(app->state->status_message),
+                 "Connection failed: %s", tcp_client_get_error(app->tcp));
     }
 }
 
 /*
- * Connect to SDR server
+ * Server link lost: drop the socket and start reconnecting
+ */
+static void app_link_lost(app_context_t* app, const char* reason)
+{
+    tcp_client_disconnect(app->tcp);
+    scan_stop(app->scan);
+    app->state->conn_state = CONN_ERROR;
+    app->state->streaming = false;
+    app->state->overload = false;
+    
+    uint32_t delay = reconnect_arm(&app->reconnect, ui_get_ticks());
+    snprintf(app->state->status_message, sizeof(app->state->status_message),
+             "Connection lost (%s) - reconnecting in %.1f s", reason, delay / 1000.0);
+    LOG_WARN("Connection lost (%s), reconnecting in %u ms", reason, delay);
+}
+
+/*
+ * Connect to SDR server (non-blocking; app_connect_poll finishes it)
  */
 static void app_connect(app_context_t* app)
 {
@@ -887,35 +1297,140 @@ static void app_connect(app_context_t* app)
     snprintf(app->state->status_message, sizeof(app->state->status_message),
              "Connecting to %s:%d...", app->state->server_host, app->state->server_port);
     
-    if (sdr_connect(app->proto, app->state->server_host, app->state->server_port)) {
-        app->state->conn_state = CONN_CONNECTED;
-        
-        /* Get version info */
-        if (sdr_get_version(app->proto)) {
+    app->handshake = HANDSHAKE_NONE;
+    if (sdr_connect_start(app->proto, app->state->server_host, app->state->server_port)) {
+        app->state->conn_state = CONN_CONNECTING;
+    } else {
+        app_connect_failed(app);
+    }
+}
+
+/*
+ * Advance a connect in progress (called every frame while connecting)
+ *
+ * Once the socket is up, the handshake runs one command per frame so a
+ * slow server never stalls the render loop for more than one round trip.
+ * conn_state stays CONN_CONNECTING until it is done, keeping status
+ * polling and keepalives off the link meanwhile.
+ */
+static void app_connect_poll(app_context_t* app)
+{
+    if (!app || app->state->conn_state != CONN_CONNECTING) return;
+    
+    if (app->handshake == HANDSHAKE_NONE) {
+        connection_state_t result = sdr_connect_poll(app->proto);
+        if (result == CONN_CONNECTING) {
+            return;
+        }
+        if (result != CONN_CONNECTED) {
+            app_connect_failed(app);
+            return;
+        }
+        snprintf(app->state->status_message, sizeof(app->state->status_message),
+                 "Connected to %s:%d - handshake...", app->state->server_host,
+                 app->state->server_port);
+        app->handshake = HANDSHAKE_VERSION;
+        return;
+    }
+    
+    /* Link dropped mid-handshake */
+    if (!sdr_is_connected(app->proto)) {
+        app->handshake = HANDSHAKE_NONE;
+        app_connect_failed(app);
+        return;
+    }
+    
+    switch (app->handshake) {
+        case HANDSHAKE_VERSION:
+            /* Get version info */
+            if (sdr_get_version(app->proto)) {
+                snprintf(app->state->status_message, sizeof(app->state->status_message),
+                         "Connected - Phoenix SDR v%s", app->proto->version.phoenix_version);
+            } else {
+                snprintf(app->state->status_message, sizeof(app->state->status_message),
+                         "Connected");
+            }
+            app->handshake = HANDSHAKE_BINARY;
+            return;
+            
+        case HANDSHAKE_BINARY:
+            /* Binary framing for set/status commands, if the server offers it */
+            sdr_negotiate_binary(app->proto);
+            app->handshake = HANDSHAKE_CAPS;
+            return;
+            
+        case HANDSHAKE_CAPS:
+            /* Capabilities drive control ranges (cached per server version) */
+            sdr_load_caps(app->proto, CAPS_CACHE_FILENAME);
+            ui_layout_apply_caps(app->layout, &app->proto->caps);
+            app->handshake = app->reconnect.active ? HANDSHAKE_REPLAY : HANDSHAKE_STATUS;
+            return;
+            
+        case HANDSHAKE_REPLAY: {
+            /* Reconnected: push what the operator had set, in one round trip */
+            sdr_status_t desired = app->proto->status;
+            desired.frequency = app->state->frequency +
+                                (app->state->dc_offset_enabled ? DC_OFFSET_HZ : 0);
+            desired.gain = app->state->gain;
+            desired.lna = app->state->lna;
+            desired.agc = app->state->agc;
+            desired.antenna = app->state->antenna;
+            desired.notch = app->state->notch;
+            bool replayed = sdr_replay_state(app->proto, &desired);
+            if (!sdr_is_connected(app->proto)) {
+                return;  /* Replay lost the link; retried as a failed connect */
+            }
+            
+            uint32_t outage = reconnect_succeeded(&app->reconnect, ui_get_ticks());
             snprintf(app->state->status_message, sizeof(app->state->status_message),
-                     "Connected - Phoenix SDR v%s", app->proto->version.phoenix_version);
+                     "Reconnected after %.1f s%s", outage / 1000.0,
+                     replayed ? "" : " (state replay incomplete)");
+            LOG_INFO("Reconnected after %u ms, state replay %s",
+                     outage, replayed ? "OK" : "incomplete");
+            app->handshake = HANDSHAKE_STATUS;
+            return;
+        }
+            
+        case HANDSHAKE_STATUS:
+            /* Get initial status and sync UI to server state */
+            if (sdr_get_status(app->proto)) {
+                app_state_update_from_sdr(app->state, &app->proto->status);
+            }
+            
+            /* UI now reflects server state - no need to push settings back */
+            app->handshake = HANDSHAKE_SUBSCRIBE;
+            return;
+            
+        case HANDSHAKE_SUBSCRIBE:
+            /* Prefer pushed status; older servers are polled adaptively */
+            sdr_subscribe_status(app->proto);
+            break;
+            
+        default:
+            break;
+    }
+    
+    app->handshake = HANDSHAKE_NONE;
+    app->state->conn_state = CONN_CONNECTED;
+    app->state->last_status_update = ui_get_ticks();
+    app->state->last_keepalive = ui_get_ticks();
+    
+    /* Each receiver has its own AFF model: by hardware identity when the
+     * server reports one (it survives moving hosts), else by server address */
+    if (app->aff_model) {
+        const sdr_version_t* ver = &app->proto->version;
+        char key[AFF_MODEL_KEY_MAX];
+        if (ver->serial[0]) {
+            snprintf(key, sizeof(key), "%s#%s", ver->device[0] ? ver->device : "sdr", ver->serial);
         } else {
-            snprintf(app->state->status_message, sizeof(app->state->status_message),
-                     "Connected");
+            snprintf(key, sizeof(key), "%s:%d", app->state->server_host, app->state->server_port);
         }
-        
-        /* Get initial status and sync UI to server state */
-        if (sdr_get_status(app->proto)) {
-            app_state_update_from_sdr(app->state, &app->proto->status);
+        if (aff_model_select(app->aff_model, key)) {
+            aff_reset(app->aff);
         }
-        
-        /* UI now reflects server state - no need to push settings back */
-        
-        app->state->last_status_update = ui_get_ticks();
-        app->state->last_keepalive = ui_get_ticks();
-        
-        LOG_INFO("Connected to %s:%d", app->state->server_host, app->state->server_port);
-    } else {
-        app->state->conn_state = CONN_ERROR;
-        snprintf(app->state->status_message, sizeof(app->state->status_message),
-                 "Connection failed: %s", tcp_client_get_error(app->tcp));
-        LOG_ERROR("Connection failed: %s", tcp_client_get_error(app->tcp));
     }
+    
+    LOG_INFO("Connected to %s:%d", app->state->server_host, app->state->server_port);
 }
 
 /*
@@ -925,7 +1440,10 @@ static void app_disconnect(app_context_t* app)
 {
     if (!app) return;
     
+    reconnect_cancel(&app->reconnect);
+    app->handshake = HANDSHAKE_NONE;
     sdr_disconnect(app->proto);
+    scan_stop(app->scan);
     app->state->conn_state = CONN_DISCONNECTED;
     app->state->streaming = false;
     app->state->overload = false;
@@ -0,0 +1,96 @@
+/*
+ * reconnect.c - Automatic reconnection policy implementation
+ */
+
+#include "reconnect.h"
+#include <string.h>
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+static uint32_t next_random(reconnect_t *rc)
+{
+    /* xorshift32 */
+    uint32_t x = rc->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rc->rng = x;
+    return x;
+}
+
+/* Backoff for the current attempt count, with equal jitter */
+static uint32_t schedule(reconnect_t *rc, uint32_t now_ms)
+{
+    uint32_t ceiling = RECONNECT_BASE_MS;
+    for (int i = 0; i < rc->attempts && ceiling < RECONNECT_MAX_MS; i++) {
+        ceiling *= 2;
+    }
+    if (ceiling > RECONNECT_MAX_MS) {
+        ceiling = RECONNECT_MAX_MS;
+    }
+    
+    uint32_t half = ceiling / 2;
+    uint32_t delay = half + next_random(rc) % (half + 1);
+    rc->next_attempt_ms = now_ms + delay;
+    return delay;
+}
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+void reconnect_init(reconnect_t *rc, uint32_t seed)
+{
+    if (!rc) return;
+    
+    memset(rc, 0, sizeof(*rc));
+    rc->rng = seed ? seed : 0x9E3779B9u;
+}
+
+uint32_t reconnect_arm(reconnect_t *rc, uint32_t now_ms)
+{
+    if (!rc) return 0;
+    
+    if (!rc->active) {
+        rc->active = true;
+        rc->attempts = 0;
+        rc->lost_ms = now_ms;
+    }
+    return schedule(rc, now_ms);
+}
+
+bool reconnect_due(reconnect_t *rc, uint32_t now_ms)
+{
+    if (!rc || !rc->active || rc->next_attempt_ms == 0) return false;
+    if ((int32_t)(now_ms - rc->next_attempt_ms) < 0) return false;
+    
+    rc->next_attempt_ms = 0;    /* In progress until failed/succeeded */
+    rc->attempts++;
+    return true;
+}
+
+uint32_t reconnect_failed(reconnect_t *rc, uint32_t now_ms)
+{
+    if (!rc || !rc->active) return 0;
+    
+    return schedule(rc, now_ms);
+}
+
+uint32_t reconnect_succeeded(reconnect_t *rc, uint32_t now_ms)
+{
+    if (!rc || !rc->active) return 0;
+    
+    rc->active = false;
+    rc->next_attempt_ms = 0;
+    return now_ms - rc->lost_ms;
+}
+
+void reconnect_cancel(reconnect_t *rc)
+{
+    if (!rc) return;
+    
+    rc->active = false;
+    rc->next_attempt_ms = 0;
+}
@@ -0,0 +1,648 @@
+/*
+ * scan.c - WWV band scan implementation
+ */
+
+#include "scan.h"
+#include "common.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*============================================================================
+ * Internal Types
+ *============================================================================*/
+
+/* One completed dwell */
+typedef struct {
+    float snr_db;
+    float noise_db;
+    float match_ratio;          /* <0 if no SUBC during the dwell */
+    int samples;
+    uint32_t end_ms;
+} scan_dwell_t;
+
+typedef struct {
+    int64_t freq_hz;
+    scan_dwell_t history[SCAN_HISTORY_DWELLS];
+    int history_count;
+    int history_head;           /* Next slot to write */
+    int wins;                   /* Auto: consecutive probes beating home */
+} scan_band_t;
+
+struct scan {
+    scan_band_t bands[SCAN_MAX_FREQS];
+    int band_count;
+    uint32_t dwell_ms;
+    
+    bool active;
+    bool tune_pending;          /* First band not tuned yet */
+    int index;                  /* Band being dwelt on (-1 = not in list) */
+    uint32_t settle_until_ms;   /* Samples before this belong to the old band */
+    uint32_t dwell_end_ms;
+    
+    /* Auto-band mode */
+    bool auto_enabled;
+    bool probing;
+    int home_index;             /* -1 if home is not one of the bands */
+    int64_t home_hz;            /* Home frequency, including AFF corrections */
+    int probe_next;             /* Round-robin probe cursor */
+    uint32_t next_probe_ms;
+    uint32_t probe_interval_ms;
+    float hysteresis_db;
+    bool config_auto;
+    
+    /* Current dwell accumulators */
+    double snr_sum;
+    double noise_sum;
+    int samples;
+    int match_count;
+    int match_total;
+    uint32_t last_chan_update;
+    uint32_t last_subc_update;
+};
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+static void dwell_clear(scan_t* scan)
+{
+    scan->snr_sum = 0.0;
+    scan->noise_sum = 0.0;
+    scan->samples = 0;
+    scan->match_count = 0;
+    scan->match_total = 0;
+}
+
+/* Accepting telemetry into the current dwell? */
+static bool dwell_open(const scan_t* scan, uint32_t now_ms)
+{
+    if (!(scan->active && !scan->tune_pending) && !scan->auto_enabled) return false;
+    return (int32_t)(now_ms - scan->settle_until_ms) >= 0;
+}
+
+/* Close the current dwell into its band's history; false if it was unusable */
+static bool dwell_finish(scan_t* scan, uint32_t now_ms)
+{
+    if (scan->index < 0) {
+        dwell_clear(scan);
+        return false;
+    }
+    
+    scan_band_t* band = &scan->bands[scan->index];
+    bool usable = (scan->samples >= SCAN_MIN_SAMPLES);
+    
+    if (usable) {
+        scan_dwell_t* d = &band->history[band->history_head];
+        d->snr_db = (float)(scan->snr_sum / scan->samples);
+        d->noise_db = (float)(scan->noise_sum / scan->samples);
+        d->match_ratio = scan->match_total > 0 ?
+                         (float)scan->match_count / scan->match_total : -1.0f;
+        d->samples = scan->samples;
+        d->end_ms = now_ms;
+        band->history_head = (band->history_head + 1) % SCAN_HISTORY_DWELLS;
+        if (band->history_count < SCAN_HISTORY_DWELLS) band->history_count++;
+        
+        /* Home dwells in auto mode are routine; probes and sweeps are not */
+        if (scan->auto_enabled && !scan->probing) {
+            LOG_DEBUG("Scan: %.3f MHz SNR %.1f dB (%d samples)",
+                      band->freq_hz / 1e6, d->snr_db, d->samples);
+        } else {
+            LOG_INFO("Scan: %.3f MHz SNR %.1f dB (%d samples)",
+                     band->freq_hz / 1e6, d->snr_db, d->samples);
+        }
+    } else {
+        LOG_INFO("Scan: %.3f MHz no usable telemetry (%d samples)",
+                 band->freq_hz / 1e6, scan->samples);
+    }
+    dwell_clear(scan);
+    return usable;
+}
+
+/* Score one band from its history */
+static void band_result(const scan_band_t* band, uint32_t now_ms, scan_result_t* r)
+{
+    memset(r, 0, sizeof(*r));
+    r->freq_hz = band->freq_hz;
+    r->score_db = -INFINITY;
+    r->last_match_ratio = -1.0f;
+    
+    double wsum = 0.0, wsnr = 0.0;
+    for (int i = 0; i < band->history_count; i++) {
+        /* Oldest to newest */
+        int slot = (band->history_head - band->history_count + i + SCAN_HISTORY_DWELLS) %
+                   SCAN_HISTORY_DWELLS;
+        const scan_dwell_t* d = &band->history[slot];
+        double w = pow(0.5, (double)(now_ms - d->end_ms) / SCAN_HALF_LIFE_MS);
+        wsum += w;
+        wsnr += w * d->snr_db;
+        r->last_snr_db = d->snr_db;
+        r->last_noise_db = d->noise_db;
+        r->last_match_ratio = d->match_ratio;
+        r->last_ms = d->end_ms;
+    }
+    r->dwells = band->history_count;
+    if (wsum > 0.0) {
+        r->score_db = (float)(wsnr / wsum);
+    }
+}
+
+static int compare_results(const void* a, const void* b)
+{
+    const scan_result_t* ra = (const scan_result_t*)a;
+    const scan_result_t* rb = (const scan_result_t*)b;
+    if (ra->score_db > rb->score_db) return -1;
+    if (ra->score_db < rb->score_db) return 1;
+    return (ra->freq_hz < rb->freq_hz) ? -1 : (ra->freq_hz > rb->freq_hz);
+}
+
+/* Band index for a frequency (within tracking tolerance), -1 if none */
+static int band_find(const scan_t* scan, int64_t freq_hz)
+{
+    for (int i = 0; i < scan->band_count; i++) {
+        int64_t diff = freq_hz - scan->bands[i].freq_hz;
+        if (diff >= -SCAN_TRACK_TOLERANCE_HZ && diff <= SCAN_TRACK_TOLERANCE_HZ) return i;
+    }
+    return -1;
+}
+
+/* Begin a dwell on the current band once a retune lands */
+static void dwell_begin(scan_t* scan, uint32_t now_ms, uint32_t lead_ms, uint32_t dwell_ms)
+{
+    dwell_clear(scan);
+    scan->settle_until_ms = now_ms + lead_ms + SCAN_SETTLE_MS;
+    scan->dwell_end_ms = now_ms + lead_ms + dwell_ms;
+}
+
+/* (Re)home auto mode on a frequency */
+static void auto_set_home(scan_t* scan, int64_t home_hz, uint32_t now_ms)
+{
+    scan->probing = false;
+    scan->home_hz = home_hz;
+    scan->home_index = band_find(scan, home_hz);
+    scan->index = scan->home_index;
+    scan->next_probe_ms = now_ms + scan->probe_interval_ms;
+    for (int i = 0; i < scan->band_count; i++) {
+        scan->bands[i].wins = 0;
+    }
+    dwell_begin(scan, now_ms, 0, scan->dwell_ms);
+}
+
+/* Next alternate band to probe, -1 if there is none */
+static int auto_pick_probe(scan_t* scan)
+{
+    for (int n = 0; n < scan->band_count; n++) {
+        int i = scan->probe_next;
+        scan->probe_next = (scan->probe_next + 1) % scan->band_count;
+        if (i != scan->home_index) return i;
+    }
+    return -1;
+}
+
+/* Did the probe that just finished beat the home band? */
+static bool auto_probe_wins(const scan_t* scan, int probe, uint32_t now_ms)
+{
+    scan_result_t cand, home;
+    band_result(&scan->bands[probe], now_ms, &cand);
+    
+    /* Must carry the WWV schedule, if SUBC says anything at all */
+    if (cand.last_match_ratio >= 0.0f && cand.last_match_ratio < SCAN_MIN_MATCH_RATIO) {
+        LOG_INFO("Auto band: %.3f MHz subcarrier mismatch (%.0f%%)",
+                 cand.freq_hz / 1e6, cand.last_match_ratio * 100.0f);
+        return false;
+    }
+    
+    if (scan->home_index < 0) return true;
+    band_result(&scan->bands[scan->home_index], now_ms, &home);
+    return cand.last_snr_db >= home.score_db + scan->hysteresis_db;
+}
+
+/* Auto-band schedule (called from scan_poll) */
+static scan_action_t auto_poll(scan_t* scan, uint32_t now_ms, uint32_t lead_ms, int64_t* freq_out)
+{
+    if (!scan->probing) {
+        /* Roll the home dwell over; no retune */
+        if ((int32_t)(now_ms - scan->dwell_end_ms) >= 0) {
+            dwell_finish(scan, now_ms);
+            scan->dwell_end_ms = now_ms + scan->dwell_ms;
+        }
+        
+        /* Leave for a probe */
+        if ((int32_t)(now_ms - scan->next_probe_ms) < 0) return SCAN_IDLE;
+        int probe = auto_pick_probe(scan);
+        if (probe < 0) {
+            scan->next_probe_ms = now_ms + scan->probe_interval_ms;
+            return SCAN_IDLE;
+        }
+        
+        dwell_finish(scan, now_ms);
+        scan->probing = true;
+        scan->index = probe;
+        dwell_begin(scan, now_ms, lead_ms, SCAN_PROBE_DWELL_MS);
+        if (freq_out) *freq_out = scan->bands[probe].freq_hz;
+        return SCAN_TUNE;
+    }
+    
+    /* Probe window: head home one lead time early */
+    if ((int32_t)(now_ms + lead_ms - scan->dwell_end_ms) < 0) return SCAN_IDLE;
+    
+    int probe = scan->index;
+    scan_band_t* band = &scan->bands[probe];
+    
+    if (dwell_finish(scan, now_ms) && auto_probe_wins(scan, probe, now_ms)) {
+        band->wins++;
+        LOG_INFO("Auto band: %.3f MHz better than home (%d/%d)",
+                 band->freq_hz / 1e6, band->wins, SCAN_SWITCH_CONFIRM);
+        
+        /* Confirm on the next probe rather than a full round later */
+        scan->probe_next = probe;
+        
+        if (band->wins >= SCAN_SWITCH_CONFIRM) {
+            /* Already tuned there: just adopt it */
+            LOG_INFO("Auto band: switching home %.3f -> %.3f MHz",
+                     scan->home_hz / 1e6, band->freq_hz / 1e6);
+            auto_set_home(scan, band->freq_hz, now_ms);
+            if (freq_out) *freq_out = band->freq_hz;
+            return SCAN_SWITCH;
+        }
+    } else {
+        band->wins = 0;
+    }
+    
+    scan->probing = false;
+    scan->index = scan->home_index;
+    scan->next_probe_ms = now_ms + scan->probe_interval_ms;
+    dwell_begin(scan, now_ms, lead_ms, scan->dwell_ms);
+    if (freq_out) *freq_out = scan->home_hz;
+    return SCAN_TUNE;
+}
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+scan_t* scan_create(void)
+{
+    static const int64_t wwv[] = {
+        WWV_2_5_MHZ, WWV_5_MHZ, WWV_10_MHZ, WWV_15_MHZ, WWV_20_MHZ, WWV_25_MHZ
+    };
+    
+    scan_t* scan = (scan_t*)calloc(1, sizeof(scan_t));
+    if (!scan) {
+        LOG_ERROR("Failed to allocate scan_t");
+        return NULL;
+    }
+    scan->dwell_ms = SCAN_DWELL_DEFAULT_MS;
+    scan->probe_interval_ms = SCAN_PROBE_INTERVAL_MS;
+    scan->hysteresis_db = SCAN_HYSTERESIS_DB;
+    scan_set_frequencies(scan, wwv, (int)ARRAY_SIZE(wwv));
+    return scan;
+}
+
+void scan_destroy(scan_t* scan)
+{
+    free(scan);
+}
+
+void scan_set_frequencies(scan_t* scan, const int64_t* freqs_hz, int count)
+{
+    if (!scan || !freqs_hz) return;
+    
+    scan->active = false;
+    scan->auto_enabled = false;
+    scan->probing = false;
+    memset(scan->bands, 0, sizeof(scan->bands));
+    scan->band_count = CLAMP(count, 0, SCAN_MAX_FREQS);
+    for (int i = 0; i < scan->band_count; i++) {
+        scan->bands[i].freq_hz = freqs_hz[i];
+    }
+    scan->probe_next = 0;
+}
+
+void scan_set_dwell(scan_t* scan, uint32_t dwell_ms)
+{
+    if (!scan) return;
+    scan->dwell_ms = dwell_ms < SCAN_DWELL_MIN_MS ? SCAN_DWELL_MIN_MS : dwell_ms;
+}
+
+bool scan_load_config(scan_t* scan, const char* filename)
+{
+    if (!scan || !filename) return false;
+    
+    FILE* f = fopen(filename, "r");
+    if (!f) {
+        LOG_DEBUG("No config file found: %s", filename);
+        return false;
+    }
+    
+    char line[256];
+    bool in_scan_section = false;
+    
+    while (fgets(line, sizeof(line), f)) {
+        /* Trim newline */
+        char* nl = strchr(line, '\n');
+        if (nl) *nl = '\0';
+        nl = strchr(line, '\r');
+        if (nl) *nl = '\0';
+        
+        /* Skip empty lines and comments */
+        if (line[0] == '\0' || line[0] == ';' || line[0] == '#') continue;
+        
+        /* Section headers */
+        if (line[0] == '[') {
+            in_scan_section = (strcmp(line, "[Scan]") == 0);
+            continue;
+        }
+        
+        /* Key=value pairs in [Scan] section */
+        if (in_scan_section) {
+            char* eq = strchr(line, '=');
+            if (eq) {
+                *eq = '\0';
+                const char* key = line;
+                const char* value = eq + 1;
+                
+                if (strcmp(key, "dwell_ms") == 0) {
+                    scan_set_dwell(scan, (uint32_t)CLAMP(atoi(value), 0, 600000));
+                } else if (strcmp(key, "auto_band") == 0) {
+                    scan->config_auto = (atoi(value) != 0);
+                } else if (strcmp(key, "probe_interval_s") == 0) {
+                    scan->probe_interval_ms = (uint32_t)CLAMP(atoi(value), 30, 86400) * 1000;
+                } else if (strcmp(key, "hysteresis_db") == 0) {
+                    scan->hysteresis_db = CLAMP((float)atof(value), 0.0f, 20.0f);
+                }
+            }
+        }
+    }
+    
+    fclose(f);
+    LOG_INFO("Loaded scan options from %s (dwell=%u ms, auto_band=%d)",
+             filename, scan->dwell_ms, scan->config_auto);
+    return true;
+}
+
+bool scan_save_config(const scan_t* scan, const char* filename)
+{
+    if (!scan || !filename) return false;
+    
+    /* Read existing file content (without [Scan] section) */
+    char* existing_content = NULL;
+    size_t existing_size = 0;
+    
+    FILE* f = fopen(filename, "r");
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        long file_size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        
+        if (file_size > 0) {
+            char* buffer = malloc(file_size + 1);
+            existing_content = malloc(file_size + 1);
+            if (buffer && existing_content) {
+                size_t got = fread(buffer, 1, file_size, f);
+                buffer[got] = '\0';
+                
+                /* Copy everything except [Scan] section */
+                char* src = buffer;
+                char* dst = existing_content;
+                bool skip_section = false;
+                
+                while (*src) {
+                    char* eol = strchr(src, '\n');
+                    size_t line_len = eol ? (size_t)(eol - src + 1) : strlen(src);
+                    
+                    if (src[0] == '[') {
+                        skip_section = (strncmp(src, "[Scan]", 6) == 0);
+                    }
+                    if (!skip_section) {
+                        memcpy(dst, src, line_len);
+                        dst += line_len;
+                    }
+                    src += line_len;
+                }
+                *dst = '\0';
+                existing_size = dst - existing_content;
+            }
+            free(buffer);
+        }
+        fclose(f);
+    }
+    
+    /* Write file with [Scan] section at end */
+    f = fopen(filename, "w");
+    if (!f) {
+        LOG_ERROR("Failed to open %s for writing", filename);
+        free(existing_content);
+        return false;
+    }
+    
+    if (existing_content && existing_size > 0) {
+        fwrite(existing_content, 1, existing_size, f);
+        if (existing_content[existing_size - 1] != '\n') {
+            fprintf(f, "\n");
+        }
+    }
+    free(existing_content);
+    
+    fprintf(f, "\n[Scan]\n");
+    fprintf(f, "dwell_ms=%u\n", scan->dwell_ms);
+    fprintf(f, "auto_band=%d\n", scan->config_auto ? 1 : 0);
+    fprintf(f, "probe_interval_s=%u\n", scan->probe_interval_ms / 1000);
+    fprintf(f, "hysteresis_db=%.1f\n", scan->hysteresis_db);
+    
+    fclose(f);
+    LOG_INFO("Saved scan options to %s", filename);
+    return true;
+}
+
+bool scan_config_auto(const scan_t* scan)
+{
+    return scan && scan->config_auto;
+}
+
+void scan_start(scan_t* scan)
+{
+    if (!scan || scan->band_count == 0) return;
+    
+    if (scan->auto_enabled) {
+        scan_auto_stop(scan);
+    }
+    scan->active = true;
+    scan->tune_pending = true;
+    scan->index = 0;
+    dwell_clear(scan);
+    LOG_INFO("Scan started: %d bands, %u ms dwell", scan->band_count, scan->dwell_ms);
+}
+
+void scan_stop(scan_t* scan)
+{
+    if (!scan || !scan->active) return;
+    scan->active = false;
+    LOG_INFO("Scan stopped");
+}
+
+bool scan_is_active(const scan_t* scan)
+{
+    return scan && scan->active;
+}
+
+void scan_auto_start(scan_t* scan, int64_t home_hz, uint32_t now_ms)
+{
+    if (!scan || scan->band_count == 0) return;
+    
+    scan_stop(scan);
+    scan->auto_enabled = true;
+    auto_set_home(scan, home_hz, now_ms);
+    LOG_INFO("Auto band on: home %.3f MHz, probe every %u s, %.1f dB hysteresis",
+             home_hz / 1e6, scan->probe_interval_ms / 1000, scan->hysteresis_db);
+}
+
+int64_t scan_auto_stop(scan_t* scan)
+{
+    if (!scan || !scan->auto_enabled) return 0;
+    
+    bool was_probing = scan->probing;
+    scan->auto_enabled = false;
+    scan->probing = false;
+    dwell_clear(scan);
+    LOG_INFO("Auto band off");
+    return was_probing ? scan->home_hz : 0;
+}
+
+bool scan_auto_is_enabled(const scan_t* scan)
+{
+    return scan && scan->auto_enabled;
+}
+
+bool scan_is_probing(const scan_t* scan)
+{
+    return scan && scan->auto_enabled && scan->probing;
+}
+
+void scan_auto_track(scan_t* scan, int64_t freq_hz, uint32_t now_ms)
+{
+    if (!scan || !scan->auto_enabled) return;
+    
+    int64_t expected = scan->probing ? scan->bands[scan->index].freq_hz : scan->home_hz;
+    int64_t diff = freq_hz - expected;
+    
+    if (diff >= -SCAN_TRACK_TOLERANCE_HZ && diff <= SCAN_TRACK_TOLERANCE_HZ) {
+        /* Follow AFF corrections on the home band */
+        if (!scan->probing) scan->home_hz = freq_hz;
+        return;
+    }
+    
+    LOG_INFO("Auto band: radio moved to %.3f MHz, new home", freq_hz / 1e6);
+    auto_set_home(scan, freq_hz, now_ms);
+}
+
+void scan_tune_failed(scan_t* scan, uint32_t now_ms)
+{
+    if (!scan) return;
+    
+    /* Probe never left home: resume the home band and probe again later */
+    if (scan->auto_enabled && scan->probing) {
+        LOG_WARN("Auto band: retune to %.3f MHz failed, staying home",
+                 scan->bands[scan->index].freq_hz / 1e6);
+        scan->probing = false;
+        scan->index = scan->home_index;
+        scan->next_probe_ms = now_ms + scan->probe_interval_ms;
+        dwell_begin(scan, now_ms, 0, scan->dwell_ms);
+        return;
+    }
+    
+    /* Radio is not on the dwell's band: take nothing until the next retune */
+    dwell_clear(scan);
+    scan->settle_until_ms = scan->dwell_end_ms;
+}
+
+void scan_add_channel(scan_t* scan, const telem_channel_t* chan, uint32_t now_ms)
+{
+    if (!scan || !chan || !chan->valid) return;
+    if (chan->last_update == scan->last_chan_update) return;
+    scan->last_chan_update = chan->last_update;
+    
+    if (!dwell_open(scan, now_ms)) return;
+    
+    scan->snr_sum += chan->snr_db;
+    scan->noise_sum += chan->noise_db;
+    scan->samples++;
+}
+
+void scan_add_subcarrier(scan_t* scan, const telem_subcarrier_t* subc, uint32_t now_ms)
+{
+    if (!scan || !subc || !subc->valid) return;
+    if (subc->last_update == scan->last_subc_update) return;
+    scan->last_subc_update = subc->last_update;
+    
+    /* Silent minutes carry no schedule information */
+    if (!dwell_open(scan, now_ms) || subc->expected == SUBCAR_NONE) return;
+    
+    scan->match_total++;
+    if (subc->match) scan->match_count++;
+}
+
+scan_action_t scan_poll(scan_t* scan, uint32_t now_ms, uint32_t lead_ms, int64_t* freq_out)
+{
+    if (!scan || (!scan->active && !scan->auto_enabled)) return SCAN_IDLE;
+    
+    /* Lead may not eat into the settle time of a dwell */
+    uint32_t shortest = scan->active ? scan->dwell_ms : SCAN_PROBE_DWELL_MS;
+    if (lead_ms > shortest / 4) lead_ms = shortest / 4;
+    
+    if (!scan->active) {
+        return auto_poll(scan, now_ms, lead_ms, freq_out);
+    }
+    
+    if (!scan->tune_pending) {
+        /* Retune one lead time early so it takes effect at the dwell end */
+        if ((int32_t)(now_ms + lead_ms - scan->dwell_end_ms) < 0) return SCAN_IDLE;
+        
+        dwell_finish(scan, now_ms);
+        scan->index++;
+        
+        if (scan->index >= scan->band_count) {
+            scan->active = false;
+            
+            scan_result_t best;
+            if (scan_get_ranking(scan, now_ms, &best, 1) == 1 && isfinite(best.score_db)) {
+                LOG_INFO("Scan done: best %.3f MHz (%.1f dB)", best.freq_hz / 1e6, best.score_db);
+                if (freq_out) *freq_out = best.freq_hz;
+                return SCAN_DONE;
+            }
+            LOG_WARN("Scan done: no band had usable telemetry");
+            return SCAN_IDLE;
+        }
+    }
+    
+    /* Tune to the current band; its dwell starts when the retune lands */
+    scan->tune_pending = false;
+    dwell_begin(scan, now_ms, lead_ms, scan->dwell_ms);
+    if (freq_out) *freq_out = scan->bands[scan->index].freq_hz;
+    return SCAN_TUNE;
+}
+
+bool scan_get_progress(const scan_t* scan, int* index, int* count, int64_t* freq_hz)
+{
+    if (!scan || !scan->active) return false;
+    
+    if (index) *index = scan->index;
+    if (count) *count = scan->band_count;
+    if (freq_hz) *freq_hz = scan->bands[scan->index].freq_hz;
+    return true;
+}
+
+int scan_get_ranking(const scan_t* scan, uint32_t now_ms, scan_result_t* out, int max_results)
+{
+    if (!scan || !out || max_results <= 0) return 0;
+    
+    scan_result_t all[SCAN_MAX_FREQS];
+    for (int i = 0; i < scan->band_count; i++) {
+        band_result(&scan->bands[i], now_ms, &all[i]);
+    }
+    qsort(all, (size_t)scan->band_count, sizeof(all[0]), compare_results);
+    
+    int n = scan->band_count < max_results ? scan->band_count : max_results;
+    memcpy(out, all, (size_t)n * sizeof(all[0]));
+    return n;
+}
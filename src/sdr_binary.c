@@ -0,0 +1,87 @@
+/*
+ * sdr_binary.c - Binary control frame encoding and decoding
+ *
+ * Fields are packed byte by byte, so the layout does not depend on the
+ * compiler's struct padding or the host's byte order.
+ */
+
+#include "sdr_binary.h"
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+static void put_u16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u64(uint8_t* p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint16_t get_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t* p)
+{
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+void sdr_bin_encode_request(uint8_t* out, sdr_bin_op_t op, uint16_t seq, int64_t arg)
+{
+    out[0] = SDR_BIN_MAGIC;
+    out[1] = (uint8_t)op;
+    put_u16(out + 2, seq);
+    put_u64(out + 4, (uint64_t)arg);
+}
+
+bool sdr_bin_decode_header(const uint8_t* in, sdr_bin_header_t* hdr)
+{
+    if (in[0] != SDR_BIN_MAGIC) return false;
+    
+    hdr->op = in[1];
+    hdr->seq = get_u16(in + 2);
+    hdr->status = in[4];
+    hdr->len = in[5];
+    return true;
+}
+
+bool sdr_bin_decode_status(const uint8_t* in, size_t len, sdr_status_t* status)
+{
+    if (len < SDR_BIN_STATUS_SIZE) return false;
+    
+    /* Enum bytes the controller does not know would index its tables */
+    if (in[16] > AGC_100HZ || in[17] > ANTENNA_HIZ) return false;
+    
+    status->frequency = (int64_t)get_u64(in);
+    status->sample_rate = (int)get_u32(in + 8);
+    status->bandwidth = get_u16(in + 12);
+    status->gain = in[14];
+    status->lna = in[15];
+    status->agc = (agc_mode_t)in[16];
+    status->antenna = (antenna_port_t)in[17];
+    
+    uint8_t flags = in[18];
+    status->streaming = (flags & SDR_BIN_FLAG_STREAMING) != 0;
+    status->overload = (flags & SDR_BIN_FLAG_OVERLOAD) != 0;
+    status->bias_t = (flags & SDR_BIN_FLAG_BIAS_T) != 0;
+    status->notch = (flags & SDR_BIN_FLAG_NOTCH) != 0;
+    return true;
+}
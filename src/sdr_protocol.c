@@ -5,14 +5,55 @@
  */
 
 #include "sdr_protocol.h"
+#include "sdr_binary.h"
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 
 /* Response buffer size */
 #define RESPONSE_BUF_SIZE 1024
 
+/* Verb names, indexed by sdr_verb_t */
+static const char* verb_names[SDR_VERB_COUNT] = {
+    "PING", "VER", "CAPS", "STATUS",
+    "SET_FREQ", "GET_FREQ", "SET_GAIN", "GET_GAIN", "SET_LNA", "GET_LNA",
+    "SET_AGC", "GET_AGC", "SET_SRATE", "GET_SRATE", "SET_BW", "GET_BW",
+    "SET_ANTENNA", "GET_ANTENNA", "SET_BIAST", "SET_NOTCH",
+    "START", "STOP", "QUIT", "SUBSCRIBE", "BINARY", "OTHER"
+};
+
+/* Binary opcodes, indexed by sdr_verb_t (SDR_BIN_OP_NONE = text only) */
+static const uint8_t verb_ops[SDR_VERB_COUNT] = {
+    [SDR_VERB_PING]        = SDR_BIN_OP_PING,
+    [SDR_VERB_STATUS]      = SDR_BIN_OP_STATUS,
+    [SDR_VERB_SET_FREQ]    = SDR_BIN_OP_SET_FREQ,
+    [SDR_VERB_SET_GAIN]    = SDR_BIN_OP_SET_GAIN,
+    [SDR_VERB_SET_LNA]     = SDR_BIN_OP_SET_LNA,
+    [SDR_VERB_SET_AGC]     = SDR_BIN_OP_SET_AGC,
+    [SDR_VERB_SET_SRATE]   = SDR_BIN_OP_SET_SRATE,
+    [SDR_VERB_SET_BW]      = SDR_BIN_OP_SET_BW,
+    [SDR_VERB_SET_ANTENNA] = SDR_BIN_OP_SET_ANTENNA,
+    [SDR_VERB_SET_BIAST]   = SDR_BIN_OP_SET_BIAST,
+    [SDR_VERB_SET_NOTCH]   = SDR_BIN_OP_SET_NOTCH,
+    [SDR_VERB_START]       = SDR_BIN_OP_START,
+    [SDR_VERB_STOP]        = SDR_BIN_OP_STOP,
+};
+
+/* Helper: map command to its verb */
+static sdr_verb_t command_verb(const char* cmd)
+{
+    size_t len = strcspn(cmd, " ");
+    for (int i = 0; i < SDR_VERB_OTHER; i++) {
+        if (strlen(verb_names[i]) == len && strncmp(cmd, verb_names[i], len) == 0) {
+            return (sdr_verb_t)i;
+        }
+    }
+    return SDR_VERB_OTHER;
+}
+
 /* Helper: parse error code from response */
 static error_code_t parse_error_code(const char* err_str)
 {
@@ -167,6 +208,320 @@ antenna_port_t string_to_antenna(const char* str)
     return ANTENNA_A;
 }
 
+/* STATUS keys, dispatched by status_key_lookup() */
+typedef enum {
+    STATUS_KEY_NONE = 0,
+    STATUS_KEY_STREAMING,
+    STATUS_KEY_FREQ,
+    STATUS_KEY_GAIN,
+    STATUS_KEY_LNA,
+    STATUS_KEY_AGC,
+    STATUS_KEY_SRATE,
+    STATUS_KEY_BW,
+    STATUS_KEY_OVERLOAD
+} status_key_t;
+
+/* Perfect hash over the STATUS keys: (3 * length + first + last) & 15.
+ * Every key lands in its own slot; a candidate is confirmed by comparing
+ * the name, so unknown keys cost one hash and at most one memcmp. */
+#define STATUS_KEY_HASH(k, len) \
+    ((3u * (unsigned)(len) + (unsigned char)(k)[0] + (unsigned char)(k)[(len) - 1]) & 15u)
+
+static const struct {
+    const char* name;
+    status_key_t key;
+} status_key_table[16] = {
+    [5]  = { "STREAMING", STATUS_KEY_STREAMING },
+    [3]  = { "FREQ",      STATUS_KEY_FREQ },
+    [1]  = { "GAIN",      STATUS_KEY_GAIN },
+    [6]  = { "LNA",       STATUS_KEY_LNA },
+    [13] = { "AGC",       STATUS_KEY_AGC },
+    [7]  = { "SRATE",     STATUS_KEY_SRATE },
+    [15] = { "BW",        STATUS_KEY_BW },
+    [11] = { "OVERLOAD",  STATUS_KEY_OVERLOAD },
+};
+
+static status_key_t status_key_lookup(const char* key, size_t len)
+{
+    if (len == 0) return STATUS_KEY_NONE;
+    
+    unsigned slot = STATUS_KEY_HASH(key, len);
+    const char* name = status_key_table[slot].name;
+    if (name && strlen(name) == len && memcmp(name, key, len) == 0) {
+        return status_key_table[slot].key;
+    }
+    return STATUS_KEY_NONE;
+}
+
+/* Helper: apply STATUS fields present in text; true if any value changed.
+ * Single pass over "KEY=VALUE" tokens; tokens without '=' (the leading OK)
+ * and unknown keys are skipped. */
+static bool parse_status_fields(sdr_protocol_t* proto, const char* text)
+{
+    sdr_status_t before = proto->status;
+    sdr_status_t* st = &proto->status;
+    const char* p = text;
+    
+    while (*p && *p != '\n') {
+        /* Token boundaries */
+        while (*p == ' ' || *p == '\r') p++;
+        const char* key = p;
+        while (*p && *p != '=' && *p != ' ' && *p != '\r' && *p != '\n') p++;
+        if (*p != '=') continue;
+        size_t key_len = (size_t)(p - key);
+        const char* value = ++p;
+        while (*p && *p != ' ' && *p != '\r' && *p != '\n') p++;
+        size_t value_len = (size_t)(p - value);
+        if (value_len == 0) continue;
+        
+        switch (status_key_lookup(key, key_len)) {
+            case STATUS_KEY_STREAMING: st->streaming = (atoi(value) != 0); break;
+            case STATUS_KEY_FREQ:      st->frequency = strtoll(value, NULL, 10); break;
+            case STATUS_KEY_GAIN:      st->gain = atoi(value); break;
+            case STATUS_KEY_LNA:       st->lna = atoi(value); break;
+            case STATUS_KEY_SRATE:     st->sample_rate = atoi(value); break;
+            case STATUS_KEY_BW:        st->bandwidth = atoi(value); break;
+            case STATUS_KEY_OVERLOAD:  st->overload = (atoi(value) != 0); break;
+            case STATUS_KEY_AGC: {
+                char agc_str[16];
+                if (value_len < sizeof(agc_str)) {
+                    memcpy(agc_str, value, value_len);
+                    agc_str[value_len] = '\0';
+                    st->agc = string_to_agc_mode(agc_str);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    
+    if (memcmp(&before, &proto->status, sizeof(before)) != 0) {
+        proto->status_seq++;
+        return true;
+    }
+    return false;
+}
+
+/* Helper: handle one '!' notification line */
+static void handle_notification(sdr_protocol_t* proto, const char* buffer)
+{
+    LOG_DEBUG("Async notification: %s", buffer);
+    
+    /* Parse notification */
+    if (strncmp(buffer, "! STATUS ", 9) == 0) {
+        /* Pushed fields (SUBSCRIBE STATUS): only those that changed */
+        parse_status_fields(proto, buffer + 9);
+    } else if (strstr(buffer, "OVERLOAD DETECTED")) {
+        proto->status.overload = true;
+        proto->status_seq++;
+        LOG_WARN("ADC Overload detected!");
+    } else if (strstr(buffer, "OVERLOAD CLEARED")) {
+        proto->status.overload = false;
+        proto->status_seq++;
+        LOG_INFO("ADC Overload cleared");
+    } else if (strstr(buffer, "GAIN_CHANGE")) {
+        /* Parse: ! GAIN_CHANGE GR_ACTUAL=x LNA_GR=y 
+         * Note: These are actual hardware values (informational only).
+         * We do NOT update status.gain or status.lna - those reflect what was SET.
+         * The server now reports SET values in STATUS, not hardware readback.
+         */
+        int gr_actual, lna_gr;
+        bool got_gr = parse_status_int(buffer, "GR_ACTUAL", &gr_actual);
+        bool got_lna = parse_status_int(buffer, "LNA_GR", &lna_gr);
+        
+        if (got_gr && got_lna) {
+            LOG_INFO("AGC hardware: GR_ACTUAL=%d dB, LNA_GR=%d dB", gr_actual, lna_gr);
+        } else if (got_gr) {
+            LOG_INFO("AGC hardware: GR_ACTUAL=%d dB", gr_actual);
+        } else {
+            LOG_INFO("AGC notification: %s", buffer);
+        }
+    } else if (strstr(buffer, "DISCONNECT")) {
+        LOG_WARN("Server disconnect notification: %s", buffer);
+        /* Connection will be closed by server */
+    }
+}
+
+/* Helper: send command, wait for response, record round trip.
+ * Notifications arriving ahead of the response are handled, not returned. */
+static bool send_command(sdr_protocol_t* proto, const char* cmd,
+                         char* response, size_t response_size)
+{
+    sdr_verb_t verb = command_verb(cmd);
+    latency_hist_t* hist = &proto->latency[verb];
+    uint64_t start = SDL_GetPerformanceCounter();
+    
+    bool ok = tcp_client_send_receive(proto->client, cmd, response, response_size, SOCKET_TIMEOUT_MS);
+    while (ok && response[0] == '!') {
+        handle_notification(proto, response);
+        ok = tcp_client_receive(proto->client, response, response_size, SOCKET_TIMEOUT_MS);
+    }
+    if (!ok) {
+        latency_hist_record_error(hist);
+        return false;
+    }
+    
+    uint64_t us = (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency();
+    latency_hist_record(hist, us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+    
+    /* Accepted state changes: poll soon in case the server adjusts them */
+    if (is_response_ok(response) && (strncmp(cmd, "SET_", 4) == 0 ||
+                                     verb == SDR_VERB_START || verb == SDR_VERB_STOP)) {
+        proto->status_seq++;
+    }
+    return true;
+}
+
+/* Helper: wait for the binary reply with sequence number seq (sent at
+ * start). Notifications arriving first are handled; stale replies (from a
+ * request that timed out) and stray text lines are dropped. */
+static bool binary_await(sdr_protocol_t* proto, sdr_verb_t verb, uint16_t seq, uint64_t start,
+                         uint8_t* payload, uint8_t* payload_len)
+{
+    latency_hist_t* hist = &proto->latency[verb];
+    uint8_t discard[SDR_BIN_MAX_PAYLOAD];
+    uint8_t* body = payload ? payload : discard;
+    sdr_bin_header_t hdr;
+    bool matched = false;
+    
+    for (int i = 0; i < 16 && !matched; i++) {
+        uint8_t head[SDR_BIN_HEADER_SIZE];
+        if (!tcp_client_receive_bytes(proto->client, head, 1, SOCKET_TIMEOUT_MS)) break;
+        
+        if (head[0] != SDR_BIN_MAGIC) {
+            char line[RESPONSE_BUF_SIZE];
+            line[0] = (char)head[0];
+            if (!tcp_client_receive(proto->client, line + 1, sizeof(line) - 1, SOCKET_TIMEOUT_MS)) break;
+            if (line[0] == '!') {
+                handle_notification(proto, line);
+            } else {
+                LOG_WARN("Dropping text reply in binary mode: %s", line);
+            }
+            continue;
+        }
+        
+        if (!tcp_client_receive_bytes(proto->client, head + 1, sizeof(head) - 1, SOCKET_TIMEOUT_MS)) break;
+        sdr_bin_decode_header(head, &hdr);
+        if (hdr.len > 0 && !tcp_client_receive_bytes(proto->client, body, hdr.len, SOCKET_TIMEOUT_MS)) break;
+        
+        matched = (hdr.seq == seq);
+        if (!matched) {
+            LOG_WARN("Dropping stale binary reply (seq %u, expected %u)", hdr.seq, seq);
+        }
+    }
+    
+    if (!matched) {
+        latency_hist_record_error(hist);
+        proto->last_error = ERR_TIMEOUT;
+        snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
+                 "%s: no binary reply (%s)", verb_names[verb],
+                 tcp_client_get_error(proto->client));
+        return false;
+    }
+    
+    uint64_t us = (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency();
+    latency_hist_record(hist, us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+    
+    if (hdr.status != 0) {
+        proto->last_error = hdr.status <= ERR_TIMEOUT ? (error_code_t)hdr.status : ERR_UNKNOWN;
+        snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
+                 "%s rejected (error %u)", verb_names[verb], hdr.status);
+        return false;
+    }
+    
+    if (payload_len) *payload_len = hdr.len;
+    
+    /* Accepted state changes: poll soon in case the server adjusts them */
+    if (verb_ops[verb] >= SDR_BIN_OP_SET_FREQ) {
+        proto->status_seq++;
+    }
+    return true;
+}
+
+/* Helper: send a binary frame and wait for its reply */
+static bool binary_command(sdr_protocol_t* proto, sdr_verb_t verb, int64_t arg,
+                           uint8_t* payload, uint8_t* payload_len)
+{
+    uint64_t start = SDL_GetPerformanceCounter();
+    uint16_t seq = ++proto->binary_seq;
+    
+    uint8_t frame[SDR_BIN_REQUEST_SIZE];
+    sdr_bin_encode_request(frame, (sdr_bin_op_t)verb_ops[verb], seq, arg);
+    if (!tcp_client_send_bytes(proto->client, frame, sizeof(frame))) {
+        latency_hist_record_error(&proto->latency[verb]);
+        return false;
+    }
+    return binary_await(proto, verb, seq, start, payload, payload_len);
+}
+
+/* Helper: a pipelined batch failed to receive with replies outstanding.
+ * They could still arrive and be read as replies to later commands, so the
+ * link is dropped; the caller's link-loss handling reconnects cleanly. */
+static void pipeline_abort(sdr_protocol_t* proto, const char* what, int outstanding)
+{
+    proto->last_error = ERR_TIMEOUT;
+    snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
+             "%s: no reply (%s)", what, tcp_client_get_error(proto->client));
+    LOG_WARN("%s: %d reply(s) outstanding, dropping connection", proto->last_error_msg, outstanding);
+    tcp_client_disconnect(proto->client);
+    proto->binary = false;
+}
+
+/* Helper: run a command answered by OK/ERR. Sent as a binary frame when
+ * negotiated, otherwise as the text line fmt (formatted only then). */
+static bool run_command(sdr_protocol_t* proto, sdr_verb_t verb, int64_t arg,
+                        const char* fmt, ...)
+{
+    if (proto->binary && verb_ops[verb] != SDR_BIN_OP_NONE) {
+        return binary_command(proto, verb, arg, NULL, NULL);
+    }
+    
+    char cmd[MAX_CMD_LENGTH];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(cmd, sizeof(cmd), fmt, args);
+    va_end(args);
+    
+    char response[RESPONSE_BUF_SIZE];
+    if (!send_command(proto, cmd, response, sizeof(response))) {
+        return false;
+    }
+    
+    if (!is_response_ok(response)) {
+        set_error_from_response(proto, response);
+        return false;
+    }
+    return true;
+}
+
+/* Helper: check gain reduction against the current antenna's range */
+static bool gain_in_range(sdr_protocol_t* proto, int gain_db)
+{
+    int gain_min, gain_max;
+    sdr_caps_gain_range(&proto->caps, proto->status.antenna, &gain_min, &gain_max);
+    if (gain_db < gain_min || gain_db > gain_max) {
+        proto->last_error = ERR_RANGE;
+        snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
+                 "Gain out of range: %d (must be %d-%d)", gain_db, gain_min, gain_max);
+        return false;
+    }
+    return true;
+}
+
+/* Helper: check LNA state against the current antenna's range */
+static bool lna_in_range(sdr_protocol_t* proto, int lna_state)
+{
+    int lna_max = sdr_caps_lna_max(&proto->caps, proto->status.antenna);
+    if (lna_state < LNA_MIN || lna_state > lna_max) {
+        proto->last_error = ERR_RANGE;
+        snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
+                 "LNA state out of range: %d (must be %d-%d)", lna_state, LNA_MIN, lna_max);
+        return false;
+    }
+    return true;
+}
+
 /*
  * Create protocol handler
  */
@@ -183,6 +538,7 @@ sdr_protocol_t* sdr_protocol_create(tcp_client_t* client)
     proto->last_error_msg[0] = '\0';
     proto->caps_loaded = false;
     proto->version_loaded = false;
+    sdr_caps_defaults(&proto->caps);
     
     /* Initialize status with defaults */
     proto->status.streaming = false;
@@ -219,9 +575,35 @@ bool sdr_connect(sdr_protocol_t* proto, const char* host, int port)
         return false;
     }
     
+    proto->binary = false;
     return tcp_client_connect(proto->client, host, port);
 }
 
+/*
+ * Start non-blocking connect to SDR server
+ */
+bool sdr_connect_start(sdr_protocol_t* proto, const char* host, int port)
+{
+    if (!proto || !proto->client) {
+        return false;
+    }
+    
+    proto->binary = false;
+    return tcp_client_connect_start(proto->client, host, port);
+}
+
+/*
+ * Advance non-blocking connect
+ */
+connection_state_t sdr_connect_poll(sdr_protocol_t* proto)
+{
+    if (!proto || !proto->client) {
+        return CONN_DISCONNECTED;
+    }
+    
+    return tcp_client_connect_poll(proto->client);
+}
+
 /*
  * Disconnect from SDR server
  */
@@ -231,6 +613,7 @@ void sdr_disconnect(sdr_protocol_t* proto)
         /* Try to send QUIT first */
         sdr_quit(proto);
         tcp_client_disconnect(proto->client);
+        proto->binary = false;
     }
 }
 
@@ -249,8 +632,12 @@ bool sdr_ping(sdr_protocol_t* proto)
 {
     if (!sdr_is_connected(proto)) return false;
     
+    if (proto->binary) {
+        return binary_command(proto, SDR_VERB_PING, 0, NULL, NULL);
+    }
+    
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "PING", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, "PING", response, sizeof(response))) {
         return false;
     }
     
@@ -264,8 +651,12 @@ bool sdr_get_version(sdr_protocol_t* proto)
 {
     if (!sdr_is_connected(proto)) return false;
     
+    /* Identity is optional; never carry one over from another server */
+    proto->version.device[0] = '\0';
+    proto->version.serial[0] = '\0';
+    
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "VER", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, "VER", response, sizeof(response))) {
         return false;
     }
     
@@ -281,74 +672,561 @@ bool sdr_get_version(sdr_protocol_t* proto)
                        sizeof(proto->version.protocol_version));
     parse_status_value(response, "API", proto->version.api_version,
                        sizeof(proto->version.api_version));
+    parse_status_value(response, "DEVICE", proto->version.device,
+                       sizeof(proto->version.device));
+    parse_status_value(response, "SERIAL", proto->version.serial,
+                       sizeof(proto->version.serial));
     
     proto->version_loaded = true;
-    LOG_INFO("SDR Version: %s, Protocol: %s, API: %s",
+    LOG_INFO("SDR Version: %s, Protocol: %s, API: %s%s%s%s%s",
              proto->version.phoenix_version,
              proto->version.protocol_version,
-             proto->version.api_version);
+             proto->version.api_version,
+             proto->version.device[0] ? ", Device: " : "", proto->version.device,
+             proto->version.serial[0] ? ", Serial: " : "", proto->version.serial);
+    
+    return true;
+}
+
+/* Helper: antenna port from its CAPS name, -1 if unknown */
+static int caps_antenna_port(const char* name)
+{
+    for (int i = 0; i < CAPS_ANTENNA_PORTS; i++) {
+        if (strcmp(name, antenna_to_string((antenna_port_t)i)) == 0) return i;
+    }
+    return -1;
+}
+
+/* Helper: parse comma-separated integers */
+static int parse_int_list(const char* value, int* out, int max)
+{
+    int n = 0;
+    while (n < max) {
+        char* end;
+        long v = strtol(value, &end, 10);
+        if (end == value) break;
+        out[n++] = (int)v;
+        if (*end != ',') break;
+        value = end + 1;
+    }
+    return n;
+}
+
+/* Helper: parse comma-separated names into fixed-size slots */
+static int parse_name_list(const char* value, char* out, size_t name_size, int max)
+{
+    int n = 0;
+    while (*value && n < max) {
+        size_t len = strcspn(value, ",");
+        if (len > 0 && len < name_size) {
+            memcpy(out + n * name_size, value, len);
+            out[n * name_size + len] = '\0';
+            n++;
+        }
+        value += len;
+        if (*value == ',') value++;
+    }
+    return n;
+}
+
+/* Helper: apply one CAPS "KEY=VALUE" line; unknown keys are ignored */
+static void caps_parse_line(sdr_capabilities_t* caps, const char* line)
+{
+    const char* eq = strchr(line, '=');
+    if (!eq || eq == line || (size_t)(eq - line) >= 32) return;
+    
+    char key[32];
+    memcpy(key, line, (size_t)(eq - line));
+    key[eq - line] = '\0';
+    const char* value = eq + 1;
+    
+    if (strcmp(key, "FREQ_MIN") == 0) {
+        caps->freq_min = strtoll(value, NULL, 10);
+    } else if (strcmp(key, "FREQ_MAX") == 0) {
+        caps->freq_max = strtoll(value, NULL, 10);
+    } else if (strcmp(key, "GAIN_MIN") == 0) {
+        caps->gain_min = atoi(value);
+    } else if (strcmp(key, "GAIN_MAX") == 0) {
+        caps->gain_max = atoi(value);
+    } else if (strcmp(key, "LNA_STATES") == 0) {
+        caps->lna_states = atoi(value);
+    } else if (strcmp(key, "SRATE_MIN") == 0) {
+        caps->srate_min = atoi(value);
+    } else if (strcmp(key, "SRATE_MAX") == 0) {
+        caps->srate_max = atoi(value);
+    } else if (strcmp(key, "SRATE") == 0) {
+        caps->srate_count = parse_int_list(value, caps->srates, (int)ARRAY_SIZE(caps->srates));
+    } else if (strcmp(key, "BW") == 0) {
+        caps->bandwidth_count = parse_int_list(value, caps->bandwidths,
+                                               (int)ARRAY_SIZE(caps->bandwidths));
+    } else if (strcmp(key, "ANTENNA") == 0) {
+        caps->antenna_count = parse_name_list(value, caps->antennas[0], sizeof(caps->antennas[0]),
+                                              (int)ARRAY_SIZE(caps->antennas));
+    } else if (strcmp(key, "AGC") == 0) {
+        caps->agc_mode_count = parse_name_list(value, caps->agc_modes[0], sizeof(caps->agc_modes[0]),
+                                               (int)ARRAY_SIZE(caps->agc_modes));
+    } else {
+        /* Per-antenna: GAIN_MIN_<ANT>, GAIN_MAX_<ANT>, LNA_STATES_<ANT> */
+        int port;
+        if (strncmp(key, "GAIN_MIN_", 9) == 0 && (port = caps_antenna_port(key + 9)) >= 0) {
+            caps->antenna_gain_min[port] = atoi(value);
+        } else if (strncmp(key, "GAIN_MAX_", 9) == 0 && (port = caps_antenna_port(key + 9)) >= 0) {
+            caps->antenna_gain_max[port] = atoi(value);
+        } else if (strncmp(key, "LNA_STATES_", 11) == 0 && (port = caps_antenna_port(key + 11)) >= 0) {
+            caps->antenna_lna_states[port] = atoi(value);
+        }
+    }
+}
+
+/* Helper: replace missing or inconsistent fields with RSP2 defaults */
+static void caps_validate(sdr_capabilities_t* caps)
+{
+    sdr_capabilities_t def;
+    sdr_caps_defaults(&def);
+    
+    if (caps->freq_min <= 0 || caps->freq_max <= caps->freq_min) {
+        caps->freq_min = def.freq_min;
+        caps->freq_max = def.freq_max;
+    }
+    if (caps->gain_min < 0 || caps->gain_max <= caps->gain_min) {
+        caps->gain_min = def.gain_min;
+        caps->gain_max = def.gain_max;
+    }
+    if (caps->lna_states < 1 || caps->lna_states > 32) {
+        caps->lna_states = def.lna_states;
+    }
+    if (caps->srate_min <= 0 || caps->srate_max < caps->srate_min) {
+        caps->srate_min = def.srate_min;
+        caps->srate_max = def.srate_max;
+    }
+    
+    /* Offered sample rates: server list, else the RSP2 steps, within range */
+    int n = 0;
+    for (int i = 0; i < caps->srate_count; i++) {
+        if (caps->srates[i] >= caps->srate_min && caps->srates[i] <= caps->srate_max) {
+            caps->srates[n++] = caps->srates[i];
+        }
+    }
+    if (n == 0) {
+        for (int i = 0; i < def.srate_count; i++) {
+            if (def.srates[i] >= caps->srate_min && def.srates[i] <= caps->srate_max) {
+                caps->srates[n++] = def.srates[i];
+            }
+        }
+    }
+    if (n == 0) {
+        caps->srates[n++] = caps->srate_min;
+    }
+    caps->srate_count = n;
+    
+    if (caps->bandwidth_count == 0) {
+        memcpy(caps->bandwidths, def.bandwidths, sizeof(def.bandwidths));
+        caps->bandwidth_count = def.bandwidth_count;
+    }
+    if (caps->antenna_count == 0) {
+        memcpy(caps->antennas, def.antennas, sizeof(def.antennas));
+        caps->antenna_count = def.antenna_count;
+    }
+    if (caps->agc_mode_count == 0) {
+        memcpy(caps->agc_modes, def.agc_modes, sizeof(def.agc_modes));
+        caps->agc_mode_count = def.agc_mode_count;
+    }
+    
+    /* Per-antenna limits not reported keep the RSP2 restrictions (Hi-Z LNA) */
+    for (int i = 0; i < CAPS_ANTENNA_PORTS; i++) {
+        if (caps->antenna_gain_max[i] <= caps->antenna_gain_min[i]) {
+            caps->antenna_gain_min[i] = 0;
+            caps->antenna_gain_max[i] = 0;
+        }
+        if (caps->antenna_lna_states[i] < 1 || caps->antenna_lna_states[i] > 32) {
+            caps->antenna_lna_states[i] = 0;
+            if (def.antenna_lna_states[i] > 0 && def.antenna_lna_states[i] < caps->lna_states) {
+                caps->antenna_lna_states[i] = def.antenna_lna_states[i];
+            }
+        }
+    }
+}
+
+/* Helper: write caps in CAPS response format */
+static void caps_write(const sdr_capabilities_t* caps, FILE* f)
+{
+    fprintf(f, "FREQ_MIN=%lld\n", (long long)caps->freq_min);
+    fprintf(f, "FREQ_MAX=%lld\n", (long long)caps->freq_max);
+    fprintf(f, "GAIN_MIN=%d\n", caps->gain_min);
+    fprintf(f, "GAIN_MAX=%d\n", caps->gain_max);
+    fprintf(f, "LNA_STATES=%d\n", caps->lna_states);
+    fprintf(f, "SRATE_MIN=%d\n", caps->srate_min);
+    fprintf(f, "SRATE_MAX=%d\n", caps->srate_max);
+    
+    fprintf(f, "SRATE=");
+    for (int i = 0; i < caps->srate_count; i++) {
+        fprintf(f, "%s%d", i ? "," : "", caps->srates[i]);
+    }
+    fprintf(f, "\nBW=");
+    for (int i = 0; i < caps->bandwidth_count; i++) {
+        fprintf(f, "%s%d", i ? "," : "", caps->bandwidths[i]);
+    }
+    fprintf(f, "\nANTENNA=");
+    for (int i = 0; i < caps->antenna_count; i++) {
+        fprintf(f, "%s%s", i ? "," : "", caps->antennas[i]);
+    }
+    fprintf(f, "\nAGC=");
+    for (int i = 0; i < caps->agc_mode_count; i++) {
+        fprintf(f, "%s%s", i ? "," : "", caps->agc_modes[i]);
+    }
+    fprintf(f, "\n");
+    
+    for (int i = 0; i < CAPS_ANTENNA_PORTS; i++) {
+        const char* ant = antenna_to_string((antenna_port_t)i);
+        if (caps->antenna_gain_max[i] > 0) {
+            fprintf(f, "GAIN_MIN_%s=%d\n", ant, caps->antenna_gain_min[i]);
+            fprintf(f, "GAIN_MAX_%s=%d\n", ant, caps->antenna_gain_max[i]);
+        }
+        if (caps->antenna_lna_states[i] > 0) {
+            fprintf(f, "LNA_STATES_%s=%d\n", ant, caps->antenna_lna_states[i]);
+        }
+    }
+}
+
+/* Helper: cache section header for the connected server version */
+static void caps_cache_key(const sdr_protocol_t* proto, char* key, size_t key_size)
+{
+    snprintf(key, key_size, "[%s/%s/%s]", proto->version.phoenix_version,
+             proto->version.protocol_version, proto->version.api_version);
+}
+
+/* Helper: load caps for this server version from the cache file */
+static bool caps_cache_load(sdr_protocol_t* proto, const char* filename)
+{
+    char key[96];
+    caps_cache_key(proto, key, sizeof(key));
+    
+    FILE* f = fopen(filename, "r");
+    if (!f) return false;
+    
+    sdr_capabilities_t caps;
+    memset(&caps, 0, sizeof(caps));
+    bool in_section = false;
+    bool found = false;
+    char line[256];
+    
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '[') {
+            if (in_section) break;
+            in_section = (strcmp(line, key) == 0);
+            found = found || in_section;
+        } else if (in_section) {
+            caps_parse_line(&caps, line);
+        }
+    }
+    fclose(f);
     
+    if (!found) return false;
+    
+    caps_validate(&caps);
+    proto->caps = caps;
     return true;
 }
 
+/* Helper: store caps for this server version, keeping other versions */
+static bool caps_cache_save(const sdr_protocol_t* proto, const char* filename)
+{
+    char key[96];
+    caps_cache_key(proto, key, sizeof(key));
+    size_t key_len = strlen(key);
+    
+    /* Read existing file content (without this version's section) */
+    char* existing_content = NULL;
+    size_t existing_size = 0;
+    
+    FILE* f = fopen(filename, "r");
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        long file_size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        
+        if (file_size > 0) {
+            char* buffer = malloc(file_size + 1);
+            existing_content = malloc(file_size + 1);
+            if (buffer && existing_content) {
+                size_t got = fread(buffer, 1, file_size, f);
+                buffer[got] = '\0';
+                
+                char* src = buffer;
+                char* dst = existing_content;
+                bool skip_section = false;
+                
+                while (*src) {
+                    char* eol = strchr(src, '\n');
+                    size_t line_len = eol ? (size_t)(eol - src + 1) : strlen(src);
+                    
+                    if (src[0] == '[') {
+                        skip_section = (strncmp(src, key, key_len) == 0 &&
+                                        (src[key_len] == '\n' || src[key_len] == '\r' ||
+                                         src[key_len] == '\0'));
+                    }
+                    if (!skip_section) {
+                        memcpy(dst, src, line_len);
+                        dst += line_len;
+                    }
+                    src += line_len;
+                }
+                *dst = '\0';
+                existing_size = dst - existing_content;
+            }
+            free(buffer);
+        }
+        fclose(f);
+    }
+    
+    f = fopen(filename, "w");
+    if (!f) {
+        LOG_ERROR("Failed to open %s for writing", filename);
+        free(existing_content);
+        return false;
+    }
+    
+    if (existing_content && existing_size > 0) {
+        fwrite(existing_content, 1, existing_size, f);
+        if (existing_content[existing_size - 1] != '\n') {
+            fprintf(f, "\n");
+        }
+    } else {
+        fprintf(f, "# Phoenix SDR capabilities, one section per server version\n");
+    }
+    free(existing_content);
+    
+    fprintf(f, "%s\n", key);
+    caps_write(&proto->caps, f);
+    fclose(f);
+    return true;
+}
+
+/*
+ * Capabilities defaults (RSP2)
+ */
+void sdr_caps_defaults(sdr_capabilities_t* caps)
+{
+    static const int srates[] = {2000000, 4000000, 6000000, 8000000, 10000000};
+    static const int bandwidths[] = {200, 300, 600, 1536, 5000, 6000, 7000, 8000};
+    
+    if (!caps) return;
+    memset(caps, 0, sizeof(*caps));
+    
+    caps->freq_min = FREQ_MIN;
+    caps->freq_max = FREQ_MAX;
+    caps->gain_min = GAIN_MIN;
+    caps->gain_max = GAIN_MAX;
+    caps->lna_states = LNA_MAX + 1;
+    caps->srate_min = SRATE_MIN;
+    caps->srate_max = SRATE_MAX;
+    
+    memcpy(caps->srates, srates, sizeof(srates));
+    caps->srate_count = (int)ARRAY_SIZE(srates);
+    memcpy(caps->bandwidths, bandwidths, sizeof(bandwidths));
+    caps->bandwidth_count = (int)ARRAY_SIZE(bandwidths);
+    
+    for (int i = 0; i < CAPS_ANTENNA_PORTS; i++) {
+        snprintf(caps->antennas[i], sizeof(caps->antennas[i]), "%s",
+                 antenna_to_string((antenna_port_t)i));
+    }
+    caps->antenna_count = CAPS_ANTENNA_PORTS;
+    for (int i = AGC_OFF; i <= AGC_100HZ; i++) {
+        snprintf(caps->agc_modes[i], sizeof(caps->agc_modes[i]), "%s",
+                 agc_mode_to_string((agc_mode_t)i));
+    }
+    caps->agc_mode_count = AGC_100HZ + 1;
+    
+    caps->antenna_lna_states[ANTENNA_HIZ] = LNA_MAX_HIZ + 1;
+}
+
+/*
+ * Gain reduction range for an antenna port
+ */
+void sdr_caps_gain_range(const sdr_capabilities_t* caps, antenna_port_t port,
+                         int* gain_min, int* gain_max)
+{
+    int lo = caps->gain_min;
+    int hi = caps->gain_max;
+    if ((int)port >= 0 && port < CAPS_ANTENNA_PORTS && caps->antenna_gain_max[port] > 0) {
+        lo = caps->antenna_gain_min[port];
+        hi = caps->antenna_gain_max[port];
+    }
+    if (gain_min) *gain_min = lo;
+    if (gain_max) *gain_max = hi;
+}
+
+/*
+ * Highest LNA state for an antenna port
+ */
+int sdr_caps_lna_max(const sdr_capabilities_t* caps, antenna_port_t port)
+{
+    if ((int)port >= 0 && port < CAPS_ANTENNA_PORTS && caps->antenna_lna_states[port] > 0) {
+        return caps->antenna_lna_states[port] - 1;
+    }
+    return caps->lna_states - 1;
+}
+
 /*
- * CAPS - Get capabilities (stub for Phase 2)
+ * CAPS - Get capabilities (multi-line, terminated by END)
  */
 bool sdr_get_caps(sdr_protocol_t* proto)
 {
-    /* TODO: Implement multi-line CAPS parsing in Phase 2 */
     if (!sdr_is_connected(proto)) return false;
     
-    /* For now, use hardcoded RSP2 capabilities */
-    proto->caps.freq_min = FREQ_MIN;
-    proto->caps.freq_max = FREQ_MAX;
-    proto->caps.gain_min = GAIN_MIN;
-    proto->caps.gain_max = GAIN_MAX;
-    proto->caps.lna_states = 9;
-    proto->caps.srate_min = SRATE_MIN;
-    proto->caps.srate_max = SRATE_MAX;
+    char response[RESPONSE_BUF_SIZE];
+    if (!send_command(proto, "CAPS", response, sizeof(response))) {
+        return false;
+    }
     
+    if (!is_response_ok(response)) {
+        set_error_from_response(proto, response);
+        return false;
+    }
+    
+    sdr_capabilities_t caps;
+    memset(&caps, 0, sizeof(caps));
+    
+    /* KEY=VALUE lines until END */
+    bool got_end = false;
+    for (int i = 0; i < CAPS_MAX_LINES; i++) {
+        if (!tcp_client_receive(proto->client, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+            break;
+        }
+        if (strcmp(response, "END") == 0) {
+            got_end = true;
+            break;
+        }
+        if (response[0] == '!') {
+            handle_notification(proto, response);
+            continue;
+        }
+        caps_parse_line(&caps, response);
+    }
+    
+    if (!got_end) {
+        proto->last_error = ERR_TIMEOUT;
+        snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
+                 "CAPS response not terminated by END");
+        LOG_WARN("%s", proto->last_error_msg);
+        return false;
+    }
+    
+    caps_validate(&caps);
+    proto->caps = caps;
     proto->caps_loaded = true;
+    proto->last_error = ERR_NONE;
+    
+    LOG_INFO("SDR Caps: gain %d-%d, %d LNA states, %d sample rates, %d bandwidths",
+             caps.gain_min, caps.gain_max, caps.lna_states,
+             caps.srate_count, caps.bandwidth_count);
     return true;
 }
 
 /*
- * STATUS - Get streaming status
+ * BINARY - Switch set/status commands to binary frames (text stays usable)
  */
-bool sdr_get_status(sdr_protocol_t* proto)
+bool sdr_negotiate_binary(sdr_protocol_t* proto)
 {
     if (!sdr_is_connected(proto)) return false;
     
+    proto->binary = false;
+    if (!proto->client->options.binary) return false;
+    
+    char cmd[MAX_CMD_LENGTH];
+    snprintf(cmd, sizeof(cmd), "BINARY %d", SDR_BIN_VERSION);
+    
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "STATUS", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, cmd, response, sizeof(response))) {
         return false;
     }
     
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    int version = 0;
+    if (!is_response_ok(response) || !parse_status_int(response, "BINARY", &version) ||
+        version != SDR_BIN_VERSION) {
+        LOG_INFO("Server has no binary framing (%s), using text commands", response);
         return false;
     }
     
-    /* Parse STATUS response: OK STREAMING=x FREQ=x GAIN=x LNA=x AGC=x SRATE=x BW=x [OVERLOAD=x] */
-    int streaming = 0;
-    parse_status_int(response, "STREAMING", &streaming);
-    proto->status.streaming = (streaming != 0);
+    proto->binary = true;
+    proto->binary_seq = 0;
+    proto->last_error = ERR_NONE;
+    LOG_INFO("Binary command framing v%d enabled", version);
+    return true;
+}
+
+/*
+ * Load capabilities: cached for this server version, else CAPS (then cached)
+ */
+bool sdr_load_caps(sdr_protocol_t* proto, const char* cache_filename)
+{
+    if (!sdr_is_connected(proto)) return false;
+    
+    bool cacheable = cache_filename && proto->version_loaded &&
+                     proto->version.phoenix_version[0];
     
-    parse_status_int64(response, "FREQ", &proto->status.frequency);
-    parse_status_int(response, "GAIN", &proto->status.gain);
-    parse_status_int(response, "LNA", &proto->status.lna);
-    parse_status_int(response, "SRATE", &proto->status.sample_rate);
-    parse_status_int(response, "BW", &proto->status.bandwidth);
+    if (cacheable && caps_cache_load(proto, cache_filename)) {
+        proto->caps_loaded = true;
+        LOG_INFO("SDR Caps: using cache for server %s", proto->version.phoenix_version);
+        return true;
+    }
     
-    int overload = 0;
-    if (parse_status_int(response, "OVERLOAD", &overload)) {
-        proto->status.overload = (overload != 0);
+    if (!sdr_get_caps(proto)) {
+        /* Older servers: keep the RSP2 defaults */
+        LOG_WARN("CAPS unavailable (%s), using RSP2 defaults", proto->last_error_msg);
+        sdr_caps_defaults(&proto->caps);
+        proto->caps_loaded = false;
+        return false;
     }
     
-    char agc_str[16];
-    if (parse_status_value(response, "AGC", agc_str, sizeof(agc_str))) {
-        proto->status.agc = string_to_agc_mode(agc_str);
+    if (cacheable) {
+        caps_cache_save(proto, cache_filename);
     }
+    return true;
+}
+
+/*
+ * STATUS - Get streaming status
+ */
+bool sdr_get_status(sdr_protocol_t* proto)
+{
+    if (!sdr_is_connected(proto)) return false;
+    
+    if (proto->binary) {
+        uint8_t payload[SDR_BIN_MAX_PAYLOAD];
+        uint8_t len = 0;
+        if (!binary_command(proto, SDR_VERB_STATUS, 0, payload, &len)) {
+            return false;
+        }
+        
+        sdr_status_t status = proto->status;
+        if (!sdr_bin_decode_status(payload, len, &status)) {
+            proto->last_error = ERR_UNKNOWN;
+            snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
+                     "Malformed binary STATUS (%u bytes)", len);
+            return false;
+        }
+        if (memcmp(&status, &proto->status, sizeof(status)) != 0) {
+            proto->status = status;
+            proto->status_seq++;
+        }
+        proto->last_error = ERR_NONE;
+        return true;
+    }
+    
+    char response[RESPONSE_BUF_SIZE];
+    if (!send_command(proto, "STATUS", response, sizeof(response))) {
+        return false;
+    }
+    
+    if (!is_response_ok(response)) {
+        set_error_from_response(proto, response);
+        return false;
+    }
+    
+    /* Parse STATUS response: OK STREAMING=x FREQ=x GAIN=x LNA=x AGC=x SRATE=x BW=x [OVERLOAD=x] */
+    parse_status_fields(proto, response);
     
     proto->last_error = ERR_NONE;
     return true;
@@ -362,7 +1240,7 @@ bool sdr_quit(sdr_protocol_t* proto)
     if (!sdr_is_connected(proto)) return false;
     
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "QUIT", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, "QUIT", response, sizeof(response))) {
         return false;
     }
     
@@ -377,23 +1255,14 @@ bool sdr_set_freq(sdr_protocol_t* proto, int64_t freq_hz)
     if (!sdr_is_connected(proto)) return false;
     
     /* Validate range */
-    if (freq_hz < FREQ_MIN || freq_hz > FREQ_MAX) {
+    if (freq_hz < proto->caps.freq_min || freq_hz > proto->caps.freq_max) {
         proto->last_error = ERR_RANGE;
         snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
                  "Frequency out of range: %lld", freq_hz);
         return false;
     }
     
-    char cmd[MAX_CMD_LENGTH];
-    snprintf(cmd, sizeof(cmd), "SET_FREQ %lld", freq_hz);
-    
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, cmd, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
-        return false;
-    }
-    
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    if (!run_command(proto, SDR_VERB_SET_FREQ, freq_hz, "SET_FREQ %lld", (long long)freq_hz)) {
         return false;
     }
     
@@ -410,7 +1279,7 @@ bool sdr_get_freq(sdr_protocol_t* proto, int64_t* freq_hz)
     if (!sdr_is_connected(proto) || !freq_hz) return false;
     
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "GET_FREQ", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, "GET_FREQ", response, sizeof(response))) {
         return false;
     }
     
@@ -437,24 +1306,11 @@ bool sdr_set_gain(sdr_protocol_t* proto, int gain_db)
 {
     if (!sdr_is_connected(proto)) return false;
     
-    /* Validate range */
-    if (gain_db < GAIN_MIN || gain_db > GAIN_MAX) {
-        proto->last_error = ERR_RANGE;
-        snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
-                 "Gain out of range: %d (must be %d-%d)", gain_db, GAIN_MIN, GAIN_MAX);
+    if (!gain_in_range(proto, gain_db)) {
         return false;
     }
     
-    char cmd[MAX_CMD_LENGTH];
-    snprintf(cmd, sizeof(cmd), "SET_GAIN %d", gain_db);
-    
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, cmd, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
-        return false;
-    }
-    
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    if (!run_command(proto, SDR_VERB_SET_GAIN, gain_db, "SET_GAIN %d", gain_db)) {
         return false;
     }
     
@@ -471,7 +1327,7 @@ bool sdr_get_gain(sdr_protocol_t* proto, int* gain_db)
     if (!sdr_is_connected(proto) || !gain_db) return false;
     
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "GET_GAIN", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, "GET_GAIN", response, sizeof(response))) {
         return false;
     }
     
@@ -498,24 +1354,11 @@ bool sdr_set_lna(sdr_protocol_t* proto, int lna_state)
 {
     if (!sdr_is_connected(proto)) return false;
     
-    /* Validate range */
-    if (lna_state < LNA_MIN || lna_state > LNA_MAX) {
-        proto->last_error = ERR_RANGE;
-        snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
-                 "LNA state out of range: %d (must be %d-%d)", lna_state, LNA_MIN, LNA_MAX);
-        return false;
-    }
-    
-    char cmd[MAX_CMD_LENGTH];
-    snprintf(cmd, sizeof(cmd), "SET_LNA %d", lna_state);
-    
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, cmd, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!lna_in_range(proto, lna_state)) {
         return false;
     }
     
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    if (!run_command(proto, SDR_VERB_SET_LNA, lna_state, "SET_LNA %d", lna_state)) {
         return false;
     }
     
@@ -532,7 +1375,7 @@ bool sdr_get_lna(sdr_protocol_t* proto, int* lna_state)
     if (!sdr_is_connected(proto) || !lna_state) return false;
     
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "GET_LNA", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, "GET_LNA", response, sizeof(response))) {
         return false;
     }
     
@@ -553,22 +1396,97 @@ bool sdr_get_lna(sdr_protocol_t* proto, int* lna_state)
 }
 
 /*
- * SET_AGC - Set AGC mode
+ * SET_GAIN + SET_LNA as one pipelined pair (both sent before either reply
+ * is read). Values equal to the current status are not sent.
  */
-bool sdr_set_agc(sdr_protocol_t* proto, agc_mode_t mode)
+bool sdr_set_gain_lna(sdr_protocol_t* proto, int gain_db, int lna_state)
 {
     if (!sdr_is_connected(proto)) return false;
     
-    char cmd[MAX_CMD_LENGTH];
-    snprintf(cmd, sizeof(cmd), "SET_AGC %s", agc_mode_to_string(mode));
-    
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, cmd, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!gain_in_range(proto, gain_db) || !lna_in_range(proto, lna_state)) {
         return false;
     }
     
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    bool send_gain = (gain_db != proto->status.gain);
+    bool send_lna = (lna_state != proto->status.lna);
+    if (!send_gain || !send_lna) {
+        if (send_gain) return sdr_set_gain(proto, gain_db);
+        if (send_lna) return sdr_set_lna(proto, lna_state);
+        return true;
+    }
+    
+    uint64_t start = SDL_GetPerformanceCounter();
+    bool gain_ok, lna_ok;
+    
+    if (proto->binary) {
+        uint8_t frames[2 * SDR_BIN_REQUEST_SIZE];
+        uint16_t seq_gain = ++proto->binary_seq;
+        uint16_t seq_lna = ++proto->binary_seq;
+        sdr_bin_encode_request(frames, SDR_BIN_OP_SET_GAIN, seq_gain, gain_db);
+        sdr_bin_encode_request(frames + SDR_BIN_REQUEST_SIZE, SDR_BIN_OP_SET_LNA, seq_lna, lna_state);
+        if (!tcp_client_send_bytes(proto->client, frames, sizeof(frames))) {
+            return false;
+        }
+        gain_ok = binary_await(proto, SDR_VERB_SET_GAIN, seq_gain, start, NULL, NULL);
+        lna_ok = binary_await(proto, SDR_VERB_SET_LNA, seq_lna, start, NULL, NULL);
+    } else {
+        char cmd_gain[MAX_CMD_LENGTH], cmd_lna[MAX_CMD_LENGTH];
+        snprintf(cmd_gain, sizeof(cmd_gain), "SET_GAIN %d", gain_db);
+        snprintf(cmd_lna, sizeof(cmd_lna), "SET_LNA %d", lna_state);
+        const char* lines[2] = { cmd_gain, cmd_lna };
+        if (!tcp_client_send_lines(proto->client, lines, 2)) {
+            return false;
+        }
+        
+        /* Responses come back in command order; notifications may interleave */
+        bool ok[2] = { false, false };
+        sdr_verb_t verbs[2] = { SDR_VERB_SET_GAIN, SDR_VERB_SET_LNA };
+        for (int i = 0; i < 2; i++) {
+            char response[RESPONSE_BUF_SIZE];
+            do {
+                if (!tcp_client_receive(proto->client, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+                    latency_hist_record_error(&proto->latency[verbs[i]]);
+                    if (ok[0]) proto->status.gain = gain_db;
+                    pipeline_abort(proto, "SET_GAIN/SET_LNA", 2 - i);
+                    return false;
+                }
+                if (response[0] == '!') {
+                    handle_notification(proto, response);
+                }
+            } while (response[0] == '!');
+            
+            uint64_t us = (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency();
+            latency_hist_record(&proto->latency[verbs[i]], us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+            tcp_client_record_rtt(proto->client, lines[i], start);
+            
+            ok[i] = is_response_ok(response);
+            if (!ok[i]) {
+                set_error_from_response(proto, response);
+            }
+        }
+        gain_ok = ok[0];
+        lna_ok = ok[1];
+        if (gain_ok || lna_ok) {
+            proto->status_seq++;
+        }
+    }
+    
+    if (gain_ok) proto->status.gain = gain_db;
+    if (lna_ok) proto->status.lna = lna_state;
+    if (gain_ok && lna_ok) {
+        proto->last_error = ERR_NONE;
+    }
+    return gain_ok && lna_ok;
+}
+
+/*
+ * SET_AGC - Set AGC mode
+ */
+bool sdr_set_agc(sdr_protocol_t* proto, agc_mode_t mode)
+{
+    if (!sdr_is_connected(proto)) return false;
+    
+    if (!run_command(proto, SDR_VERB_SET_AGC, mode, "SET_AGC %s", agc_mode_to_string(mode))) {
         return false;
     }
     
@@ -585,7 +1503,7 @@ bool sdr_get_agc(sdr_protocol_t* proto, agc_mode_t* mode)
     if (!sdr_is_connected(proto) || !mode) return false;
     
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "GET_AGC", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, "GET_AGC", response, sizeof(response))) {
         return false;
     }
     
@@ -613,23 +1531,14 @@ bool sdr_set_srate(sdr_protocol_t* proto, int srate_hz)
     if (!sdr_is_connected(proto)) return false;
     
     /* Validate range */
-    if (srate_hz < SRATE_MIN || srate_hz > SRATE_MAX) {
+    if (srate_hz < proto->caps.srate_min || srate_hz > proto->caps.srate_max) {
         proto->last_error = ERR_RANGE;
         snprintf(proto->last_error_msg, sizeof(proto->last_error_msg),
                  "Sample rate out of range: %d", srate_hz);
         return false;
     }
     
-    char cmd[MAX_CMD_LENGTH];
-    snprintf(cmd, sizeof(cmd), "SET_SRATE %d", srate_hz);
-    
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, cmd, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
-        return false;
-    }
-    
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    if (!run_command(proto, SDR_VERB_SET_SRATE, srate_hz, "SET_SRATE %d", srate_hz)) {
         return false;
     }
     
@@ -646,7 +1555,7 @@ bool sdr_get_srate(sdr_protocol_t* proto, int* srate_hz)
     if (!sdr_is_connected(proto) || !srate_hz) return false;
     
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "GET_SRATE", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, "GET_SRATE", response, sizeof(response))) {
         return false;
     }
     
@@ -672,16 +1581,7 @@ bool sdr_set_bw(sdr_protocol_t* proto, int bw_khz)
 {
     if (!sdr_is_connected(proto)) return false;
     
-    char cmd[MAX_CMD_LENGTH];
-    snprintf(cmd, sizeof(cmd), "SET_BW %d", bw_khz);
-    
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, cmd, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
-        return false;
-    }
-    
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    if (!run_command(proto, SDR_VERB_SET_BW, bw_khz, "SET_BW %d", bw_khz)) {
         return false;
     }
     
@@ -698,7 +1598,7 @@ bool sdr_get_bw(sdr_protocol_t* proto, int* bw_khz)
     if (!sdr_is_connected(proto) || !bw_khz) return false;
     
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "GET_BW", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, "GET_BW", response, sizeof(response))) {
         return false;
     }
     
@@ -724,16 +1624,7 @@ bool sdr_set_antenna(sdr_protocol_t* proto, antenna_port_t port)
 {
     if (!sdr_is_connected(proto)) return false;
     
-    char cmd[MAX_CMD_LENGTH];
-    snprintf(cmd, sizeof(cmd), "SET_ANTENNA %s", antenna_to_string(port));
-    
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, cmd, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
-        return false;
-    }
-    
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    if (!run_command(proto, SDR_VERB_SET_ANTENNA, port, "SET_ANTENNA %s", antenna_to_string(port))) {
         return false;
     }
     
@@ -750,7 +1641,7 @@ bool sdr_get_antenna(sdr_protocol_t* proto, antenna_port_t* port)
     if (!sdr_is_connected(proto) || !port) return false;
     
     char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "GET_ANTENNA", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+    if (!send_command(proto, "GET_ANTENNA", response, sizeof(response))) {
         return false;
     }
     
@@ -776,20 +1667,9 @@ bool sdr_set_biast(sdr_protocol_t* proto, bool enable)
 {
     if (!sdr_is_connected(proto)) return false;
     
-    char cmd[MAX_CMD_LENGTH];
-    if (enable) {
-        snprintf(cmd, sizeof(cmd), "SET_BIAST ON CONFIRM");
-    } else {
-        snprintf(cmd, sizeof(cmd), "SET_BIAST OFF");
-    }
-    
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, cmd, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
-        return false;
-    }
-    
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    /* Enabling requires CONFIRM (binary: arg 1 is the confirmed enable) */
+    if (!run_command(proto, SDR_VERB_SET_BIAST, enable,
+                     enable ? "SET_BIAST ON CONFIRM" : "SET_BIAST OFF")) {
         return false;
     }
     
@@ -805,16 +1685,7 @@ bool sdr_set_notch(sdr_protocol_t* proto, bool enable)
 {
     if (!sdr_is_connected(proto)) return false;
     
-    char cmd[MAX_CMD_LENGTH];
-    snprintf(cmd, sizeof(cmd), "SET_NOTCH %s", enable ? "ON" : "OFF");
-    
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, cmd, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
-        return false;
-    }
-    
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    if (!run_command(proto, SDR_VERB_SET_NOTCH, enable, "SET_NOTCH %s", enable ? "ON" : "OFF")) {
         return false;
     }
     
@@ -823,6 +1694,75 @@ bool sdr_set_notch(sdr_protocol_t* proto, bool enable)
     return true;
 }
 
+/*
+ * Replay desired state as one pipelined batch (used after reconnect)
+ */
+bool sdr_replay_state(sdr_protocol_t* proto, const sdr_status_t* desired)
+{
+    if (!sdr_is_connected(proto) || !desired) return false;
+    
+    enum { R_FREQ, R_GAIN, R_LNA, R_AGC, R_ANTENNA, R_NOTCH, R_COUNT };
+    char cmds[R_COUNT][MAX_CMD_LENGTH];
+    snprintf(cmds[R_FREQ], MAX_CMD_LENGTH, "SET_FREQ %lld", (long long)desired->frequency);
+    snprintf(cmds[R_GAIN], MAX_CMD_LENGTH, "SET_GAIN %d", desired->gain);
+    snprintf(cmds[R_LNA], MAX_CMD_LENGTH, "SET_LNA %d", desired->lna);
+    snprintf(cmds[R_AGC], MAX_CMD_LENGTH, "SET_AGC %s", agc_mode_to_string(desired->agc));
+    snprintf(cmds[R_ANTENNA], MAX_CMD_LENGTH, "SET_ANTENNA %s", antenna_to_string(desired->antenna));
+    snprintf(cmds[R_NOTCH], MAX_CMD_LENGTH, "SET_NOTCH %s", desired->notch ? "ON" : "OFF");
+    
+    const char* lines[R_COUNT];
+    for (int i = 0; i < R_COUNT; i++) {
+        lines[i] = cmds[i];
+    }
+    uint64_t start = SDL_GetPerformanceCounter();
+    if (!tcp_client_send_lines(proto->client, lines, R_COUNT)) {
+        return false;
+    }
+    
+    /* Responses come back in command order; notifications may interleave */
+    int failed = 0;
+    for (int i = 0; i < R_COUNT; i++) {
+        sdr_verb_t verb = command_verb(cmds[i]);
+        char response[RESPONSE_BUF_SIZE];
+        do {
+            if (!tcp_client_receive(proto->client, response, sizeof(response), SOCKET_TIMEOUT_MS)) {
+                latency_hist_record_error(&proto->latency[verb]);
+                pipeline_abort(proto, "State replay", R_COUNT - i);
+                return false;
+            }
+            if (response[0] == '!') {
+                LOG_DEBUG("Async notification during replay: %s", response);
+            }
+        } while (response[0] == '!');
+        
+        uint64_t us = (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency();
+        latency_hist_record(&proto->latency[verb], us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+        tcp_client_record_rtt(proto->client, cmds[i], start);
+        
+        if (!is_response_ok(response)) {
+            set_error_from_response(proto, response);
+            LOG_WARN("Replay '%s' rejected: %s", cmds[i], response);
+            failed++;
+            continue;
+        }
+        
+        switch (i) {
+            case R_FREQ:    proto->status.frequency = desired->frequency; break;
+            case R_GAIN:    proto->status.gain = desired->gain; break;
+            case R_LNA:     proto->status.lna = desired->lna; break;
+            case R_AGC:     proto->status.agc = desired->agc; break;
+            case R_ANTENNA: proto->status.antenna = desired->antenna; break;
+            case R_NOTCH:   proto->status.notch = desired->notch; break;
+        }
+    }
+    
+    LOG_INFO("Replayed radio state: %d command(s), %d rejected", R_COUNT, failed);
+    if (failed == 0) {
+        proto->last_error = ERR_NONE;
+    }
+    return failed == 0;
+}
+
 /*
  * START - Start streaming
  */
@@ -830,13 +1770,7 @@ bool sdr_start(sdr_protocol_t* proto)
 {
     if (!sdr_is_connected(proto)) return false;
     
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "START", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
-        return false;
-    }
-    
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    if (!run_command(proto, SDR_VERB_START, 0, "START")) {
         return false;
     }
     
@@ -852,13 +1786,7 @@ bool sdr_stop(sdr_protocol_t* proto)
 {
     if (!sdr_is_connected(proto)) return false;
     
-    char response[RESPONSE_BUF_SIZE];
-    if (!tcp_client_send_receive(proto->client, "STOP", response, sizeof(response), SOCKET_TIMEOUT_MS)) {
-        return false;
-    }
-    
-    if (!is_response_ok(response)) {
-        set_error_from_response(proto, response);
+    if (!run_command(proto, SDR_VERB_STOP, 0, "STOP")) {
         return false;
     }
     
@@ -881,42 +1809,75 @@ bool sdr_process_async(sdr_protocol_t* proto)
     while (tcp_client_check_async(proto->client, buffer, sizeof(buffer))) {
         /* Check if it's a notification (starts with '!') */
         if (buffer[0] == '!') {
-            LOG_DEBUG("Async notification: %s", buffer);
-            
-            /* Parse notification */
-            if (strstr(buffer, "OVERLOAD DETECTED")) {
-                proto->status.overload = true;
-                LOG_WARN("ADC Overload detected!");
-            } else if (strstr(buffer, "OVERLOAD CLEARED")) {
-                proto->status.overload = false;
-                LOG_INFO("ADC Overload cleared");
-            } else if (strstr(buffer, "GAIN_CHANGE")) {
-                /* Parse: ! GAIN_CHANGE GR_ACTUAL=x LNA_GR=y 
-                 * Note: These are actual hardware values (informational only).
-                 * We do NOT update status.gain or status.lna - those reflect what was SET.
-                 * The server now reports SET values in STATUS, not hardware readback.
-                 */
-                int gr_actual, lna_gr;
-                bool got_gr = parse_status_int(buffer, "GR_ACTUAL", &gr_actual);
-                bool got_lna = parse_status_int(buffer, "LNA_GR", &lna_gr);
-                
-                if (got_gr && got_lna) {
-                    LOG_INFO("AGC hardware: GR_ACTUAL=%d dB, LNA_GR=%d dB", gr_actual, lna_gr);
-                } else if (got_gr) {
-                    LOG_INFO("AGC hardware: GR_ACTUAL=%d dB", gr_actual);
-                } else {
-                    LOG_INFO("AGC notification: %s", buffer);
-                }
-            } else if (strstr(buffer, "DISCONNECT")) {
-                LOG_WARN("Server disconnect notification: %s", buffer);
-                /* Connection will be closed by server */
-            }
+            handle_notification(proto, buffer);
         }
     }
     
     return true;
 }
 
+/*
+ * Ask the server to push changed STATUS fields
+ */
+bool sdr_subscribe_status(sdr_protocol_t* proto)
+{
+    if (!sdr_is_connected(proto)) return false;
+    
+    proto->status_subscribed = false;
+    proto->poll_interval_ms = STATUS_POLL_MIN_MS;
+    proto->poll_seq = proto->status_seq;
+    
+    char response[RESPONSE_BUF_SIZE];
+    if (!send_command(proto, "SUBSCRIBE STATUS", response, sizeof(response))) {
+        return false;
+    }
+    
+    if (!is_response_ok(response)) {
+        set_error_from_response(proto, response);
+        LOG_INFO("Server has no STATUS push (%s), using adaptive polling", response);
+        return false;
+    }
+    
+    proto->status_subscribed = true;
+    proto->last_error = ERR_NONE;
+    LOG_INFO("Subscribed to STATUS pushes");
+    return true;
+}
+
+/*
+ * Keep status current: pushes when subscribed, adaptive STATUS polling otherwise
+ */
+bool sdr_poll_status(sdr_protocol_t* proto, uint32_t now_ms)
+{
+    if (!sdr_is_connected(proto)) return false;
+    
+    /* Anything changed since the last poll: back to fast polling */
+    if (proto->status_seq != proto->poll_seq) {
+        proto->poll_interval_ms = STATUS_POLL_MIN_MS;
+    } else if (proto->poll_interval_ms < STATUS_POLL_MIN_MS) {
+        proto->poll_interval_ms = STATUS_POLL_MIN_MS;
+    }
+    
+    uint32_t interval = proto->status_subscribed ? STATUS_SUBSCRIBED_POLL_MS : proto->poll_interval_ms;
+    if (now_ms - proto->last_poll_ms >= interval) {
+        proto->last_poll_ms = now_ms;
+        uint32_t seq_before = proto->status_seq;
+        
+        if (sdr_get_status(proto) && proto->status_seq == seq_before &&
+            proto->poll_seq == seq_before && !proto->status_subscribed) {
+            /* Nothing new: poll less often */
+            proto->poll_interval_ms *= 2;
+            if (proto->poll_interval_ms > STATUS_POLL_MAX_MS) {
+                proto->poll_interval_ms = STATUS_POLL_MAX_MS;
+            }
+        }
+    }
+    
+    bool changed = (proto->status_seq != proto->poll_seq);
+    proto->poll_seq = proto->status_seq;
+    return changed;
+}
+
 /*
  * Get last error code
  */
@@ -934,3 +1895,62 @@ const char* sdr_get_error_msg(sdr_protocol_t* proto)
     if (!proto) return "NULL protocol";
     return proto->last_error_msg;
 }
+
+/*
+ * Get verb name
+ */
+const char* sdr_verb_name(sdr_verb_t verb)
+{
+    if (verb < 0 || verb >= SDR_VERB_COUNT) return "?";
+    return verb_names[verb];
+}
+
+/*
+ * Get round-trip histogram for a verb
+ */
+const latency_hist_t* sdr_get_latency(const sdr_protocol_t* proto, sdr_verb_t verb)
+{
+    if (!proto || verb < 0 || verb >= SDR_VERB_COUNT) return NULL;
+    return &proto->latency[verb];
+}
+
+/*
+ * Write round-trip summary (ms) for every verb used
+ */
+bool sdr_dump_latency(const sdr_protocol_t* proto, const char* filename)
+{
+    if (!proto || !filename) return false;
+    
+    FILE* f = fopen(filename, "w");
+    if (!f) {
+        LOG_ERROR("Failed to open %s for writing", filename);
+        return false;
+    }
+    
+    time_t now = time(NULL);
+    char when[32];
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    
+    fprintf(f, "# Phoenix SDR command round-trip latency (ms), written %s\n", when);
+    fprintf(f, "# Server %s:%d, percentiles are bucket upper edges (~12.5%%)\n",
+            proto->client ? proto->client->host : "", proto->client ? proto->client->port : 0);
+    fprintf(f, "%-12s %8s %6s %9s %9s %9s %9s\n",
+            "verb", "count", "errors", "p50", "p90", "p99", "max");
+    
+    for (int v = 0; v < SDR_VERB_COUNT; v++) {
+        const latency_hist_t* hist = &proto->latency[v];
+        uint32_t count = latency_hist_count(hist);
+        int errors = SDL_AtomicGet((SDL_atomic_t*)&hist->errors);
+        if (count == 0 && errors == 0) continue;
+        
+        fprintf(f, "%-12s %8u %6d %9.2f %9.2f %9.2f %9.2f\n", verb_names[v], count, errors,
+                latency_hist_percentile(hist, 50.0) / 1000.0,
+                latency_hist_percentile(hist, 90.0) / 1000.0,
+                latency_hist_percentile(hist, 99.0) / 1000.0,
+                latency_hist_max(hist) / 1000.0);
+    }
+    
+    fclose(f);
+    LOG_INFO("Saved command latency to %s", filename);
+    return true;
+}
@@ -0,0 +1,81 @@
+/**
+ * Phoenix SDR Controller - Snapshot Publishing
+ */
+
+#include "snapshot.h"
+#include "common.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool snapshot_init(snapshot_t* snap, size_t size)
+{
+    if (!snap || size == 0) return false;
+    
+    snap->copies = (uint8_t*)calloc(3, size);
+    if (!snap->copies) {
+        LOG_ERROR("Failed to allocate snapshot (%zu bytes)", 3 * size);
+        return false;
+    }
+    snap->size = size;
+    SDL_AtomicSet(&snap->seq, 0);
+    return true;
+}
+
+void snapshot_free(snapshot_t* snap)
+{
+    if (!snap) return;
+    free(snap->copies);
+    snap->copies = NULL;
+    snap->size = 0;
+}
+
+void snapshot_publish(snapshot_t* snap, const void* src)
+{
+    if (!snap || !snap->copies || !src) return;
+    
+    /* Odd: readers move to copy 1 while copy 0 is rewritten */
+    SDL_AtomicIncRef(&snap->seq);
+    SDL_MemoryBarrierRelease();
+    memcpy(snap->copies, src, snap->size);
+    
+    /* Even: readers back on copy 0 while copy 1 catches up */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicIncRef(&snap->seq);
+    SDL_MemoryBarrierRelease();
+    memcpy(snap->copies + snap->size, src, snap->size);
+}
+
+bool snapshot_read(const snapshot_t* snap, void* dst, uint32_t* version)
+{
+    if (!snap || !snap->copies || !dst) return false;
+    
+    SDL_atomic_t* seq = (SDL_atomic_t*)&snap->seq;
+    uint8_t* scratch = snap->copies + 2 * snap->size;
+    for (int i = 0; i < SNAPSHOT_READ_RETRIES; i++) {
+        uint32_t s = (uint32_t)SDL_AtomicGet(seq);
+        
+        /* Complete versions so far (odd: the next one is half written) */
+        uint32_t latest = s >> 1;
+        if (latest == 0) return false;
+        if (version && *version == latest) return true;
+        
+        SDL_MemoryBarrierAcquire();
+        memcpy(scratch, snap->copies + (s & 1) * snap->size, snap->size);
+        SDL_MemoryBarrierAcquire();
+        
+        /* Any step since means the producer may have reached our copy */
+        if ((uint32_t)SDL_AtomicGet(seq) == s) {
+            memcpy(dst, scratch, snap->size);
+            if (version) *version = latest;
+            return true;
+        }
+    }
+    
+    LOG_WARN("Snapshot read retries exhausted");
+    return false;
+}
+
+uint32_t snapshot_version(const snapshot_t* snap)
+{
+    return snap ? (uint32_t)SDL_AtomicGet((SDL_atomic_t*)&snap->seq) >> 1 : 0;
+}
@@ -5,16 +5,20 @@
  */
 
 #include "tcp_client.h"
+#include "sdr_binary.h"
 #include <stdio.h>
 #include <string.h>
+#include <SDL.h>
 
 #ifdef _WIN32
     #include <winsock2.h>
     #include <ws2tcpip.h>
+    #include <mstcpip.h>
 #else
     #include <sys/select.h>
     #include <fcntl.h>
     #include <netdb.h>
+    #include <netinet/tcp.h>
 #endif
 
 /* Static flag for Winsock initialization */
@@ -54,6 +58,289 @@ void tcp_client_cleanup(void)
 #endif
 }
 
+/*============================================================================
+ * Socket Options
+ *============================================================================*/
+
+static void options_set_defaults(tcp_options_t* opt)
+{
+    opt->nodelay = true;
+    opt->keepalive = true;
+    opt->keepalive_idle_s = 30;
+    opt->keepalive_interval_s = 10;
+    opt->keepalive_count = 3;
+    opt->user_timeout_ms = 20000;
+    opt->rcvbuf = 0;
+    opt->sndbuf = 0;
+    opt->measure_rtt = false;
+    opt->binary = true;
+}
+
+static bool set_int_option(socket_t s, int level, int name, int value, const char* what)
+{
+    if (setsockopt(s, level, name, (const char*)&value, sizeof(value)) != 0) {
+        LOG_WARN("setsockopt(%s=%d) failed: %d", what, value, SOCKET_ERROR_CODE);
+        return false;
+    }
+    return true;
+}
+
+/* Buffer sizes must be set before connect() to affect window scaling */
+static void apply_buffer_options(tcp_client_t* client, socket_t s)
+{
+    if (client->options.rcvbuf > 0) {
+        set_int_option(s, SOL_SOCKET, SO_RCVBUF, client->options.rcvbuf, "SO_RCVBUF");
+    }
+    if (client->options.sndbuf > 0) {
+        set_int_option(s, SOL_SOCKET, SO_SNDBUF, client->options.sndbuf, "SO_SNDBUF");
+    }
+}
+
+static void apply_keepalive(tcp_client_t* client, socket_t s)
+{
+    const tcp_options_t* opt = &client->options;
+    
+    if (!set_int_option(s, SOL_SOCKET, SO_KEEPALIVE, opt->keepalive ? 1 : 0, "SO_KEEPALIVE") ||
+        !opt->keepalive) {
+        return;
+    }
+    
+#if defined(TCP_KEEPIDLE)
+    set_int_option(s, IPPROTO_TCP, TCP_KEEPIDLE, opt->keepalive_idle_s, "TCP_KEEPIDLE");
+#elif defined(TCP_KEEPALIVE)
+    set_int_option(s, IPPROTO_TCP, TCP_KEEPALIVE, opt->keepalive_idle_s, "TCP_KEEPALIVE");
+#elif defined(_WIN32)
+    /* Older Windows SDKs: idle and interval only, count fixed by the OS */
+    struct tcp_keepalive ka;
+    DWORD bytes = 0;
+    ka.onoff = 1;
+    ka.keepalivetime = (ULONG)opt->keepalive_idle_s * 1000;
+    ka.keepaliveinterval = (ULONG)opt->keepalive_interval_s * 1000;
+    if (WSAIoctl(s, SIO_KEEPALIVE_VALS, &ka, sizeof(ka), NULL, 0, &bytes, NULL, NULL) != 0) {
+        LOG_WARN("SIO_KEEPALIVE_VALS failed: %d", SOCKET_ERROR_CODE);
+    }
+#endif
+#if defined(TCP_KEEPINTVL)
+    set_int_option(s, IPPROTO_TCP, TCP_KEEPINTVL, opt->keepalive_interval_s, "TCP_KEEPINTVL");
+#endif
+#if defined(TCP_KEEPCNT)
+    set_int_option(s, IPPROTO_TCP, TCP_KEEPCNT, opt->keepalive_count, "TCP_KEEPCNT");
+#endif
+}
+
+/* Options applied to the connected socket */
+static void apply_socket_options(tcp_client_t* client, socket_t s)
+{
+    const tcp_options_t* opt = &client->options;
+    
+    set_int_option(s, IPPROTO_TCP, TCP_NODELAY, opt->nodelay ? 1 : 0, "TCP_NODELAY");
+    apply_keepalive(client, s);
+    
+    if (opt->user_timeout_ms > 0) {
+#if defined(TCP_USER_TIMEOUT)
+        set_int_option(s, IPPROTO_TCP, TCP_USER_TIMEOUT, opt->user_timeout_ms, "TCP_USER_TIMEOUT");
+#elif defined(TCP_MAXRT)
+        /* Windows: seconds, rounded up */
+        set_int_option(s, IPPROTO_TCP, TCP_MAXRT, (opt->user_timeout_ms + 999) / 1000, "TCP_MAXRT");
+#endif
+    }
+    
+    /* Log what the OS actually granted */
+    int nodelay = 0, rcvbuf = 0, sndbuf = 0;
+    socklen_t len = sizeof(int);
+    getsockopt(s, IPPROTO_TCP, TCP_NODELAY, (char*)&nodelay, &len);
+    len = sizeof(int);
+    getsockopt(s, SOL_SOCKET, SO_RCVBUF, (char*)&rcvbuf, &len);
+    len = sizeof(int);
+    getsockopt(s, SOL_SOCKET, SO_SNDBUF, (char*)&sndbuf, &len);
+    LOG_INFO("Socket options: nodelay=%d keepalive=%s rcvbuf=%d sndbuf=%d user_timeout=%d ms",
+             nodelay != 0, opt->keepalive ? "on" : "off", rcvbuf, sndbuf, opt->user_timeout_ms);
+}
+
+/* Record one command round trip (measure_rtt) */
+static void record_rtt(tcp_client_t* client, const char* command, uint64_t start)
+{
+    double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 /
+                (double)SDL_GetPerformanceFrequency();
+    
+    tcp_rtt_stats_t* rtt = &client->rtt;
+    if (rtt->count == 0 || ms < rtt->min_ms) rtt->min_ms = ms;
+    if (rtt->count == 0 || ms > rtt->max_ms) rtt->max_ms = ms;
+    rtt->sum_ms += ms;
+    rtt->count++;
+    
+    int verb_len = (int)strcspn(command, " ");
+    LOG_INFO("RTT %.*s: %.2f ms (nodelay=%d)", verb_len, command, ms,
+             client->options.nodelay ? 1 : 0);
+}
+
+static void log_rtt_summary(tcp_client_t* client)
+{
+    tcp_rtt_stats_t* rtt = &client->rtt;
+    if (rtt->count > 0) {
+        LOG_INFO("RTT summary: %u commands, min %.2f / mean %.2f / max %.2f ms (nodelay=%d)",
+                 rtt->count, rtt->min_ms, rtt->sum_ms / rtt->count, rtt->max_ms,
+                 client->options.nodelay ? 1 : 0);
+    }
+    memset(rtt, 0, sizeof(*rtt));
+}
+
+/*
+ * Load [Network] options from INI file
+ */
+bool tcp_client_load_options(tcp_client_t* client, const char* filename)
+{
+    if (!client || !filename) return false;
+    
+    FILE* f = fopen(filename, "r");
+    if (!f) {
+        LOG_DEBUG("No config file found: %s", filename);
+        return false;
+    }
+    
+    tcp_options_t* opt = &client->options;
+    char line[256];
+    bool in_network_section = false;
+    
+    while (fgets(line, sizeof(line), f)) {
+        /* Trim newline */
+        char* nl = strchr(line, '\n');
+        if (nl) *nl = '\0';
+        nl = strchr(line, '\r');
+        if (nl) *nl = '\0';
+        
+        /* Skip empty lines and comments */
+        if (line[0] == '\0' || line[0] == ';' || line[0] == '#') continue;
+        
+        /* Section headers */
+        if (line[0] == '[') {
+            in_network_section = (strcmp(line, "[Network]") == 0);
+            continue;
+        }
+        
+        /* Key=value pairs in [Network] section */
+        if (in_network_section) {
+            char* eq = strchr(line, '=');
+            if (eq) {
+                *eq = '\0';
+                const char* key = line;
+                const char* value = eq + 1;
+                
+                if (strcmp(key, "nodelay") == 0) {
+                    opt->nodelay = (atoi(value) != 0);
+                } else if (strcmp(key, "keepalive") == 0) {
+                    opt->keepalive = (atoi(value) != 0);
+                } else if (strcmp(key, "keepalive_idle") == 0) {
+                    opt->keepalive_idle_s = CLAMP(atoi(value), 1, 7200);
+                } else if (strcmp(key, "keepalive_interval") == 0) {
+                    opt->keepalive_interval_s = CLAMP(atoi(value), 1, 600);
+                } else if (strcmp(key, "keepalive_count") == 0) {
+                    opt->keepalive_count = CLAMP(atoi(value), 1, 30);
+                } else if (strcmp(key, "user_timeout_ms") == 0) {
+                    opt->user_timeout_ms = CLAMP(atoi(value), 0, 600000);
+                } else if (strcmp(key, "rcvbuf") == 0) {
+                    opt->rcvbuf = CLAMP(atoi(value), 0, 16 * 1024 * 1024);
+                } else if (strcmp(key, "sndbuf") == 0) {
+                    opt->sndbuf = CLAMP(atoi(value), 0, 16 * 1024 * 1024);
+                } else if (strcmp(key, "measure_rtt") == 0) {
+                    opt->measure_rtt = (atoi(value) != 0);
+                } else if (strcmp(key, "binary") == 0) {
+                    opt->binary = (atoi(value) != 0);
+                }
+            }
+        }
+    }
+    
+    fclose(f);
+    LOG_INFO("Loaded network options from %s (nodelay=%d, measure_rtt=%d)",
+             filename, opt->nodelay, opt->measure_rtt);
+    return true;
+}
+
+/*
+ * Save [Network] options to INI file
+ */
+bool tcp_client_save_options(tcp_client_t* client, const char* filename)
+{
+    if (!client || !filename) return false;
+    
+    /* Read existing file content (without [Network] section) */
+    char* existing_content = NULL;
+    size_t existing_size = 0;
+    
+    FILE* f = fopen(filename, "r");
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        long file_size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        
+        if (file_size > 0) {
+            char* buffer = malloc(file_size + 1);
+            existing_content = malloc(file_size + 1);
+            if (buffer && existing_content) {
+                size_t got = fread(buffer, 1, file_size, f);
+                buffer[got] = '\0';
+                
+                /* Copy everything except [Network] section */
+                char* src = buffer;
+                char* dst = existing_content;
+                bool skip_section = false;
+                
+                while (*src) {
+                    char* eol = strchr(src, '\n');
+                    size_t line_len = eol ? (size_t)(eol - src + 1) : strlen(src);
+                    
+                    if (src[0] == '[') {
+                        skip_section = (strncmp(src, "[Network]", 9) == 0);
+                    }
+                    if (!skip_section) {
+                        memcpy(dst, src, line_len);
+                        dst += line_len;
+                    }
+                    src += line_len;
+                }
+                *dst = '\0';
+                existing_size = dst - existing_content;
+            }
+            free(buffer);
+        }
+        fclose(f);
+    }
+    
+    /* Write file with [Network] section at end */
+    f = fopen(filename, "w");
+    if (!f) {
+        LOG_ERROR("Failed to open %s for writing", filename);
+        free(existing_content);
+        return false;
+    }
+    
+    if (existing_content && existing_size > 0) {
+        fwrite(existing_content, 1, existing_size, f);
+        if (existing_content[existing_size - 1] != '\n') {
+            fprintf(f, "\n");
+        }
+    }
+    free(existing_content);
+    
+    const tcp_options_t* opt = &client->options;
+    fprintf(f, "\n[Network]\n");
+    fprintf(f, "nodelay=%d\n", opt->nodelay ? 1 : 0);
+    fprintf(f, "keepalive=%d\n", opt->keepalive ? 1 : 0);
+    fprintf(f, "keepalive_idle=%d\n", opt->keepalive_idle_s);
+    fprintf(f, "keepalive_interval=%d\n", opt->keepalive_interval_s);
+    fprintf(f, "keepalive_count=%d\n", opt->keepalive_count);
+    fprintf(f, "user_timeout_ms=%d\n", opt->user_timeout_ms);
+    fprintf(f, "rcvbuf=%d\n", opt->rcvbuf);
+    fprintf(f, "sndbuf=%d\n", opt->sndbuf);
+    fprintf(f, "measure_rtt=%d\n", opt->measure_rtt ? 1 : 0);
+    fprintf(f, "binary=%d\n", opt->binary ? 1 : 0);
+    
+    fclose(f);
+    LOG_INFO("Saved network options to %s", filename);
+    return true;
+}
+
 /*
  * Create a new TCP client context
  */
@@ -72,6 +359,8 @@ tcp_client_t* tcp_client_create(void)
     client->last_error[0] = '\0';
     client->last_activity_ms = 0;
     client->has_pending_data = false;
+    client->resolve_job = NULL;
+    options_set_defaults(&client->options);
     
     return client;
 }
@@ -88,55 +377,162 @@ void tcp_client_destroy(tcp_client_t* client)
 }
 
 /*
- * Connect to server
+ * Resolver job, shared with its worker thread.
+ * Freed by whichever of the two releases it last.
  */
-bool tcp_client_connect(tcp_client_t* client, const char* host, int port)
+typedef struct {
+    char host[256];
+    char port[16];
+    struct addrinfo* result;
+    int error;
+    SDL_atomic_t done;
+    SDL_atomic_t refs;
+} tcp_resolve_job_t;
+
+static void resolve_job_release(tcp_resolve_job_t* job)
 {
-    if (!client) {
-        return false;
-    }
-    
-    /* Disconnect if already connected */
-    if (client->socket != INVALID_SOCK) {
-        tcp_client_disconnect(client);
+    if (job && SDL_AtomicDecRef(&job->refs)) {
+        if (job->result) {
+            freeaddrinfo(job->result);
+        }
+        free(job);
     }
+}
+
+static int resolve_thread(void* data)
+{
+    tcp_resolve_job_t* job = (tcp_resolve_job_t*)data;
     
-    client->state = CONN_CONNECTING;
-    strncpy(client->host, host, sizeof(client->host) - 1);
-    client->host[sizeof(client->host) - 1] = '\0';
-    client->port = port;
-    
-    LOG_INFO("Connecting to %s:%d", host, port);
-    
-    /* Resolve host address */
     struct addrinfo hints = {0};
-    struct addrinfo* result = NULL;
-    hints.ai_family = AF_INET;
+    hints.ai_family = AF_UNSPEC;
     hints.ai_socktype = SOCK_STREAM;
     hints.ai_protocol = IPPROTO_TCP;
+    hints.ai_flags = AI_ADDRCONFIG;
     
-    char port_str[16];
-    snprintf(port_str, sizeof(port_str), "%d", port);
+    job->error = getaddrinfo(job->host, job->port, &hints, &job->result);
+    SDL_AtomicSet(&job->done, 1);
+    resolve_job_release(job);
+    return 0;
+}
+
+static bool set_nonblocking(socket_t s, bool nonblocking)
+{
+#ifdef _WIN32
+    u_long mode = nonblocking ? 1 : 0;
+    return ioctlsocket(s, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    if (flags < 0) return false;
+    flags = nonblocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return fcntl(s, F_SETFL, flags) == 0;
+#endif
+}
+
+static bool connect_in_progress(int err)
+{
+#ifdef _WIN32
+    return err == WSAEWOULDBLOCK;
+#else
+    return err == EINPROGRESS;
+#endif
+}
+
+/*
+ * Copy resolved addresses into candidates, alternating address families
+ * starting with the resolver's first preference
+ */
+static void build_candidates(tcp_client_t* client, const struct addrinfo* list)
+{
+    client->candidate_count = 0;
+    client->next_candidate = 0;
+    if (!list) return;
     
-    int res = getaddrinfo(host, port_str, &hints, &result);
-    if (res != 0) {
-        snprintf(client->last_error, sizeof(client->last_error), 
-                 "getaddrinfo failed: %d", res);
-        LOG_ERROR("%s", client->last_error);
-        client->state = CONN_ERROR;
+    int first_family = list->ai_family;
+    const struct addrinfo* same = list;
+    const struct addrinfo* other = list;
+    bool want_same = true;
+    
+    while (client->candidate_count < TCP_MAX_CANDIDATES) {
+        const struct addrinfo** cursor = want_same ? &same : &other;
+        while (*cursor && (((*cursor)->ai_family == first_family) != want_same ||
+                           (*cursor)->ai_addrlen > sizeof(struct sockaddr_storage))) {
+            *cursor = (*cursor)->ai_next;
+        }
+        if (*cursor) {
+            tcp_candidate_t* c = &client->candidates[client->candidate_count++];
+            memcpy(&c->addr, (*cursor)->ai_addr, (*cursor)->ai_addrlen);
+            c->addr_len = (int)(*cursor)->ai_addrlen;
+            c->socket = INVALID_SOCK;
+            *cursor = (*cursor)->ai_next;
+        } else if (!same && !other) {
+            break;
+        }
+        want_same = !want_same;
+    }
+}
+
+static void close_candidates(tcp_client_t* client)
+{
+    for (int i = 0; i < client->candidate_count; i++) {
+        if (client->candidates[i].socket != INVALID_SOCK) {
+            CLOSE_SOCKET(client->candidates[i].socket);
+            client->candidates[i].socket = INVALID_SOCK;
+        }
+    }
+    client->candidate_count = 0;
+    client->next_candidate = 0;
+}
+
+static void cancel_connect(tcp_client_t* client)
+{
+    resolve_job_release((tcp_resolve_job_t*)client->resolve_job);
+    client->resolve_job = NULL;
+    close_candidates(client);
+}
+
+static connection_state_t connect_failed(tcp_client_t* client)
+{
+    LOG_ERROR("%s", client->last_error);
+    cancel_connect(client);
+    client->state = CONN_ERROR;
+    return client->state;
+}
+
+/* Start the next candidate; returns false if it failed immediately */
+static bool start_candidate(tcp_client_t* client, tcp_candidate_t* c)
+{
+    struct sockaddr* sa = (struct sockaddr*)&c->addr;
+    
+    c->socket = socket(sa->sa_family, SOCK_STREAM, IPPROTO_TCP);
+    if (c->socket == INVALID_SOCK) {
+        client->last_connect_error = SOCKET_ERROR_CODE;
         return false;
     }
     
-    /* Create socket */
-    client->socket = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-    if (client->socket == INVALID_SOCK) {
-        snprintf(client->last_error, sizeof(client->last_error),
-                 "socket() failed: %d", SOCKET_ERROR_CODE);
-        LOG_ERROR("%s", client->last_error);
-        freeaddrinfo(result);
-        client->state = CONN_ERROR;
+    apply_buffer_options(client, c->socket);
+    if (!set_nonblocking(c->socket, true) ||
+        (connect(c->socket, sa, c->addr_len) != 0 &&
+         !connect_in_progress(SOCKET_ERROR_CODE))) {
+        client->last_connect_error = SOCKET_ERROR_CODE;
+        CLOSE_SOCKET(c->socket);
+        c->socket = INVALID_SOCK;
         return false;
     }
+    return true;
+}
+
+/* Candidate connected: make it the client socket, drop the rest */
+static void adopt_candidate(tcp_client_t* client, tcp_candidate_t* c)
+{
+    char addr_str[INET6_ADDRSTRLEN] = "?";
+    getnameinfo((struct sockaddr*)&c->addr, (socklen_t)c->addr_len,
+                addr_str, sizeof(addr_str), NULL, 0, NI_NUMERICHOST);
+    
+    client->socket = c->socket;
+    c->socket = INVALID_SOCK;
+    cancel_connect(client);
+    
+    set_nonblocking(client->socket, false);
     
     /* Set socket timeout for recv operations */
 #ifdef _WIN32
@@ -150,28 +546,179 @@ bool tcp_client_connect(tcp_client_t* client, const char* host, int port)
     setsockopt(client->socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
     setsockopt(client->socket, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
 #endif
+    apply_socket_options(client, client->socket);
+    memset(&client->rtt, 0, sizeof(client->rtt));
     
-    /* Connect to server */
-    res = connect(client->socket, result->ai_addr, (int)result->ai_addrlen);
-    freeaddrinfo(result);
+    client->state = CONN_CONNECTED;
+    client->last_activity_ms = 0; /* Will be set by caller with SDL_GetTicks() */
+    LOG_INFO("Connected to %s:%d (%s) in %u ms", client->host, client->port, addr_str,
+             SDL_GetTicks() - client->connect_start_ms);
+}
+
+/*
+ * Start a non-blocking connect
+ */
+bool tcp_client_connect_start(tcp_client_t* client, const char* host, int port)
+{
+    if (!client || !host) {
+        return false;
+    }
     
-    if (res != 0) {
-        snprintf(client->last_error, sizeof(client->last_error),
-                 "connect() failed: %d", SOCKET_ERROR_CODE);
-        LOG_ERROR("%s", client->last_error);
-        CLOSE_SOCKET(client->socket);
-        client->socket = INVALID_SOCK;
-        client->state = CONN_ERROR;
+    /* Disconnect if already connected (or connecting) */
+    tcp_client_disconnect(client);
+    
+    client->state = CONN_CONNECTING;
+    strncpy(client->host, host, sizeof(client->host) - 1);
+    client->host[sizeof(client->host) - 1] = '\0';
+    client->port = port;
+    client->last_error[0] = '\0';
+    client->last_connect_error = 0;
+    client->connect_start_ms = SDL_GetTicks();
+    
+    LOG_INFO("Connecting to %s:%d", host, port);
+    
+    /* Resolve host address off the render thread */
+    tcp_resolve_job_t* job = (tcp_resolve_job_t*)calloc(1, sizeof(tcp_resolve_job_t));
+    if (!job) {
+        snprintf(client->last_error, sizeof(client->last_error), "Out of memory");
+        connect_failed(client);
         return false;
     }
+    strncpy(job->host, client->host, sizeof(job->host) - 1);
+    snprintf(job->port, sizeof(job->port), "%d", port);
+    SDL_AtomicSet(&job->refs, 2);
     
-    client->state = CONN_CONNECTED;
-    client->last_activity_ms = 0; /* Will be set by caller with SDL_GetTicks() */
-    LOG_INFO("Connected to %s:%d", host, port);
+    SDL_Thread* thread = SDL_CreateThread(resolve_thread, "tcp_resolve", job);
+    if (!thread) {
+        free(job);
+        snprintf(client->last_error, sizeof(client->last_error),
+                 "Resolver thread failed: %s", SDL_GetError());
+        connect_failed(client);
+        return false;
+    }
+    SDL_DetachThread(thread);
+    client->resolve_job = job;
     
     return true;
 }
 
+/*
+ * Advance a connect in progress (never blocks)
+ */
+connection_state_t tcp_client_connect_poll(tcp_client_t* client)
+{
+    if (!client) {
+        return CONN_DISCONNECTED;
+    }
+    if (client->state != CONN_CONNECTING) {
+        return client->state;
+    }
+    
+    uint32_t now = SDL_GetTicks();
+    if (now - client->connect_start_ms >= TCP_CONNECT_TIMEOUT_MS) {
+        snprintf(client->last_error, sizeof(client->last_error), "Connection timed out");
+        return connect_failed(client);
+    }
+    
+    /* Wait for the resolver */
+    tcp_resolve_job_t* job = (tcp_resolve_job_t*)client->resolve_job;
+    if (job) {
+        if (!SDL_AtomicGet(&job->done)) {
+            return CONN_CONNECTING;
+        }
+        if (job->error != 0) {
+            snprintf(client->last_error, sizeof(client->last_error),
+                     "getaddrinfo failed: %d", job->error);
+            return connect_failed(client);
+        }
+        build_candidates(client, job->result);
+        resolve_job_release(job);
+        client->resolve_job = NULL;
+        client->next_attempt_ms = now;
+        LOG_DEBUG("%s resolved to %d address(es)", client->host, client->candidate_count);
+    }
+    
+    /* Start the next address when its turn comes, or at once if none is pending */
+    int in_flight = 0;
+    for (int i = 0; i < client->next_candidate; i++) {
+        if (client->candidates[i].socket != INVALID_SOCK) in_flight++;
+    }
+    while (client->next_candidate < client->candidate_count &&
+           (in_flight == 0 || (int32_t)(now - client->next_attempt_ms) >= 0)) {
+        tcp_candidate_t* c = &client->candidates[client->next_candidate++];
+        client->next_attempt_ms = now + TCP_CONNECT_STAGGER_MS;
+        if (start_candidate(client, c)) {
+            in_flight++;
+            break;
+        }
+    }
+    
+    if (in_flight == 0) {
+        snprintf(client->last_error, sizeof(client->last_error),
+                 "connect() failed: %d", client->last_connect_error);
+        return connect_failed(client);
+    }
+    
+    /* Check pending attempts (Windows reports failures in the except set) */
+    fd_set write_fds, except_fds;
+    struct timeval tv = {0, 0};
+    socket_t max_fd = 0;
+    
+    FD_ZERO(&write_fds);
+    FD_ZERO(&except_fds);
+    for (int i = 0; i < client->next_candidate; i++) {
+        socket_t s = client->candidates[i].socket;
+        if (s == INVALID_SOCK) continue;
+        FD_SET(s, &write_fds);
+        FD_SET(s, &except_fds);
+        if (s > max_fd) max_fd = s;
+    }
+    
+    if (select((int)max_fd + 1, NULL, &write_fds, &except_fds, &tv) <= 0) {
+        return CONN_CONNECTING;
+    }
+    
+    for (int i = 0; i < client->next_candidate; i++) {
+        tcp_candidate_t* c = &client->candidates[i];
+        if (c->socket == INVALID_SOCK) continue;
+        if (!FD_ISSET(c->socket, &write_fds) && !FD_ISSET(c->socket, &except_fds)) continue;
+        
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(c->socket, SOL_SOCKET, SO_ERROR, (char*)&err, &len) != 0) {
+            err = SOCKET_ERROR_CODE;
+        }
+        if (err == 0 && !FD_ISSET(c->socket, &except_fds)) {
+            adopt_candidate(client, c);
+            return client->state;
+        }
+        
+        LOG_DEBUG("Connect attempt %d to %s failed: %d", i, client->host, err);
+        client->last_connect_error = err;
+        CLOSE_SOCKET(c->socket);
+        c->socket = INVALID_SOCK;
+        client->next_attempt_ms = now;  /* Next address right away */
+    }
+    
+    return CONN_CONNECTING;
+}
+
+/*
+ * Connect to server (blocking wrapper around connect_start/connect_poll)
+ */
+bool tcp_client_connect(tcp_client_t* client, const char* host, int port)
+{
+    if (!tcp_client_connect_start(client, host, port)) {
+        return false;
+    }
+    
+    while (tcp_client_connect_poll(client) == CONN_CONNECTING) {
+        SDL_Delay(10);
+    }
+    
+    return client->state == CONN_CONNECTED;
+}
+
 /*
  * Disconnect from server
  */
@@ -181,6 +728,8 @@ void tcp_client_disconnect(tcp_client_t* client)
         return;
     }
     
+    cancel_connect(client);
+    
     if (client->socket != INVALID_SOCK) {
         /* Attempt graceful shutdown */
 #ifdef _WIN32
@@ -192,6 +741,7 @@ void tcp_client_disconnect(tcp_client_t* client)
         client->socket = INVALID_SOCK;
         LOG_INFO("Disconnected from %s:%d", client->host, client->port);
     }
+    log_rtt_summary(client);
     
     client->state = CONN_DISCONNECTED;
     client->has_pending_data = false;
@@ -243,6 +793,46 @@ bool tcp_client_send(tcp_client_t* client, const char* command)
     return true;
 }
 
+/*
+ * Send several commands in one write (adds newlines automatically)
+ */
+bool tcp_client_send_lines(tcp_client_t* client, const char* const* commands, int count)
+{
+    if (!tcp_client_is_connected(client)) {
+        if (client) snprintf(client->last_error, sizeof(client->last_error), "Not connected");
+        return false;
+    }
+    
+    /* Build batch */
+    char buffer[MAX_CMD_LENGTH * 8];
+    int len = 0;
+    for (int i = 0; i < count; i++) {
+        int n = snprintf(buffer + len, sizeof(buffer) - (size_t)len, "%s\n", commands[i]);
+        if (n <= 0 || n >= (int)sizeof(buffer) - len) {
+            snprintf(client->last_error, sizeof(client->last_error), "Batch too long");
+            return false;
+        }
+        len += n;
+    }
+    
+    /* Send data (may take several calls for a large batch) */
+    int total_sent = 0;
+    while (total_sent < len) {
+        int sent = send(client->socket, buffer + total_sent, len - total_sent, 0);
+        if (sent <= 0) {
+            snprintf(client->last_error, sizeof(client->last_error),
+                     "send() failed: %d", SOCKET_ERROR_CODE);
+            LOG_ERROR("%s", client->last_error);
+            client->state = CONN_ERROR;
+            return false;
+        }
+        total_sent += sent;
+    }
+    
+    LOG_DEBUG("Sent batch of %d command(s)", count);
+    return true;
+}
+
 /*
  * Receive response (blocking with timeout)
  */
@@ -299,12 +889,31 @@ bool tcp_client_receive(tcp_client_t* client, char* buffer, size_t buffer_size,
         if (received == 0) {
             snprintf(client->last_error, sizeof(client->last_error), "Connection closed");
             client->state = CONN_DISCONNECTED;
+            CLOSE_SOCKET(client->socket);
             client->socket = INVALID_SOCK;
             return false;
         }
         
         total_received++;
         
+        /* A binary frame where a line should start (a late reply to a binary
+         * request that timed out): skip it whole, then read the line */
+        if (total_received == 1 && (uint8_t)buffer[0] == SDR_BIN_MAGIC) {
+            uint8_t frame[SDR_BIN_HEADER_SIZE + SDR_BIN_MAX_PAYLOAD];
+            frame[0] = SDR_BIN_MAGIC;
+            if (!tcp_client_receive_bytes(client, frame + 1, SDR_BIN_HEADER_SIZE - 1, timeout_ms)) {
+                return false;
+            }
+            sdr_bin_header_t hdr;
+            sdr_bin_decode_header(frame, &hdr);
+            if (hdr.len > 0 &&
+                !tcp_client_receive_bytes(client, frame + SDR_BIN_HEADER_SIZE, hdr.len, timeout_ms)) {
+                return false;
+            }
+            LOG_WARN("Dropping stale binary reply (seq %u) outside a binary wait", hdr.seq);
+            return tcp_client_receive(client, buffer, buffer_size, timeout_ms);
+        }
+        
         /* Check for newline (end of response) */
         if (buffer[total_received - 1] == '\n') {
             break;
@@ -321,17 +930,110 @@ bool tcp_client_receive(tcp_client_t* client, char* buffer, size_t buffer_size,
     return true;
 }
 
+/*
+ * Send raw bytes
+ */
+bool tcp_client_send_bytes(tcp_client_t* client, const void* data, size_t len)
+{
+    if (!tcp_client_is_connected(client)) {
+        snprintf(client->last_error, sizeof(client->last_error), "Not connected");
+        return false;
+    }
+    
+    int sent = send(client->socket, (const char*)data, (int)len, 0);
+    if (sent != (int)len) {
+        snprintf(client->last_error, sizeof(client->last_error),
+                 "send() failed: %d", SOCKET_ERROR_CODE);
+        LOG_ERROR("%s", client->last_error);
+        client->state = CONN_ERROR;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Receive exactly len raw bytes
+ */
+bool tcp_client_receive_bytes(tcp_client_t* client, void* data, size_t len, int timeout_ms)
+{
+    if (!tcp_client_is_connected(client)) {
+        snprintf(client->last_error, sizeof(client->last_error), "Not connected");
+        return false;
+    }
+    
+    char* dst = (char*)data;
+    size_t total_received = 0;
+    
+    while (total_received < len) {
+        fd_set read_fds;
+        struct timeval tv;
+        
+        FD_ZERO(&read_fds);
+        FD_SET(client->socket, &read_fds);
+        
+        tv.tv_sec = timeout_ms / 1000;
+        tv.tv_usec = (timeout_ms % 1000) * 1000;
+        
+        int select_result = select((int)client->socket + 1, &read_fds, NULL, NULL, &tv);
+        if (select_result < 0) {
+            snprintf(client->last_error, sizeof(client->last_error),
+                     "select() failed: %d", SOCKET_ERROR_CODE);
+            LOG_ERROR("%s", client->last_error);
+            client->state = CONN_ERROR;
+            return false;
+        }
+        if (select_result == 0) {
+            snprintf(client->last_error, sizeof(client->last_error), "Timeout");
+            return false;
+        }
+        
+        int received = recv(client->socket, dst + total_received, (int)(len - total_received), 0);
+        if (received < 0) {
+            snprintf(client->last_error, sizeof(client->last_error),
+                     "recv() failed: %d", SOCKET_ERROR_CODE);
+            LOG_ERROR("%s", client->last_error);
+            client->state = CONN_ERROR;
+            return false;
+        }
+        if (received == 0) {
+            snprintf(client->last_error, sizeof(client->last_error), "Connection closed");
+            client->state = CONN_DISCONNECTED;
+            CLOSE_SOCKET(client->socket);
+            client->socket = INVALID_SOCK;
+            return false;
+        }
+        total_received += (size_t)received;
+    }
+    return true;
+}
+
 /*
  * Send command and receive response
  */
 bool tcp_client_send_receive(tcp_client_t* client, const char* command,
                              char* response, size_t response_size, int timeout_ms)
 {
+    uint64_t start = client && client->options.measure_rtt ? SDL_GetPerformanceCounter() : 0;
+    
     if (!tcp_client_send(client, command)) {
         return false;
     }
     
-    return tcp_client_receive(client, response, response_size, timeout_ms);
+    bool ok = tcp_client_receive(client, response, response_size, timeout_ms);
+    if (ok && client->options.measure_rtt) {
+        record_rtt(client, command, start);
+    }
+    return ok;
+}
+
+/*
+ * Record a round trip timed by the caller
+ */
+void tcp_client_record_rtt(tcp_client_t* client, const char* command, uint64_t start)
+{
+    if (client && client->options.measure_rtt) {
+        record_rtt(client, command, start);
+    }
 }
 
 /*
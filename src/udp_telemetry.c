@@ -76,6 +76,20 @@ static bcd_modem_sync_state_t parse_bcd_sync_state(const char* str)
     return BCD_MODEM_SYNC_SEARCHING;
 }
 
+/* Helper: Stamp a BCDS symbol report. SYM and CORR can both report the same
+ * pulse; a report for the same second within half a symbol is that pulse
+ * again. (Symbols are a second apart, so a modem stuck on one second still
+ * yields a new stamp per symbol.) */
+static void note_bcds_symbol(udp_telemetry_t* telem, int prev_second, uint32_t now)
+{
+    if (telem->bcds.last_symbol_second == prev_second &&
+        telem->bcds.last_symbol_update != 0 &&
+        now - telem->bcds.last_symbol_update < 500) {
+        return;
+    }
+    telem->bcds.last_symbol_update = now;
+}
+
 /*
  * Create telemetry receiver
  */
@@ -497,6 +511,7 @@ telemetry_type_t udp_telemetry_parse(udp_telemetry_t* telem, const char* packet)
         }
         else if (strcmp(token, "SYM") == 0) {
             /* SYM,symbol,second,duration_ms,confidence */
+            int prev_second = telem->bcds.last_symbol_second;
             /* symbol (0, 1, P, ?) */
             token = strtok(NULL, ",");
             if (!token) return TELEM_NONE;
@@ -520,6 +535,7 @@ telemetry_type_t udp_telemetry_parse(udp_telemetry_t* telem, const char* packet)
             
             telem->bcds.valid = true;
             telem->bcds.last_update = now;
+            note_bcds_symbol(telem, prev_second, now);
         }
         else if (strcmp(token, "TIME") == 0) {
             /* TIME,time,timestamp_ms,pulse_count,peak_energy,duration_ms,noise_floor,snr_db */
@@ -556,6 +572,7 @@ telemetry_type_t udp_telemetry_parse(udp_telemetry_t* telem, const char* packet)
         }
         else if (strcmp(token, "CORR") == 0) {
             /* CORR,time,timestamp_ms,symbol_count,second,symbol,source,duration_ms,confidence,... */
+            int prev_second = telem->bcds.last_symbol_second;
             /* Skip time field */
             token = strtok(NULL, ",");
             if (!token) return TELEM_NONE;
@@ -590,6 +607,7 @@ telemetry_type_t udp_telemetry_parse(udp_telemetry_t* telem, const char* packet)
             
             telem->bcds.valid = true;
             telem->bcds.last_update = now;
+            note_bcds_symbol(telem, prev_second, now);
         }
         
         return TELEM_BCDS;
@@ -22,32 +22,24 @@
 #define COMBO_HEIGHT 22
 #define LED_RADIUS 5
 
-/* Static combo box items */
-static const char* s_agc_items[] = {"OFF", "5HZ", "50HZ", "100HZ"};
-static const char* s_srate_items[] = {"2.0 MHz", "4.0 MHz", "6.0 MHz", "8.0 MHz", "10.0 MHz"};
-static const char* s_bw_items[] = {"200 kHz", "300 kHz", "600 kHz", "1536 kHz", "5000 kHz", "6000 kHz", "7000 kHz", "8000 kHz"};
-static const char* s_antenna_items[] = {"Antenna A", "Antenna B", "Hi-Z"};
+/* Antenna combo labels, indexed by antenna_port_t */
+static const char* s_antenna_labels[CAPS_ANTENNA_PORTS] = {"Antenna A", "Antenna B", "Hi-Z"};
 
-/* Sample rate values matching combo items */
-static const int s_srate_values[] = {2000000, 4000000, 6000000, 8000000, 10000000};
-static const int s_bw_values[] = {200, 300, 600, 1536, 5000, 6000, 7000, 8000};
-
-/* Helper: find combo index for sample rate */
-static int srate_to_index(int srate)
+/* Helper: find combo index for a value */
+static int value_to_index(const int* values, int count, int value)
 {
-    for (int i = 0; i < 5; i++) {
-        if (s_srate_values[i] == srate) return i;
+    for (int i = 0; i < count; i++) {
+        if (values[i] == value) return i;
     }
     return 0;
 }
 
-/* Helper: find combo index for bandwidth */
-static int bw_to_index(int bw)
+/* Helper: replace combo items, keeping the selection in range */
+static void combo_set_items(widget_combo_t* combo, const char** items, int count)
 {
-    for (int i = 0; i < 8; i++) {
-        if (s_bw_values[i] == bw) return i;
-    }
-    return 0;
+    combo->items = items;
+    combo->item_count = count;
+    if (combo->selected >= count) combo->selected = 0;
 }
 
 /*
@@ -86,7 +78,7 @@ ui_layout_t* ui_layout_create(ui_core_t* ui)
     widget_button_init(&layout->btn_freq_up, 0, 0, 50, BUTTON_HEIGHT, "UP");
     widget_button_init(&layout->btn_freq_down, 0, 0, 50, BUTTON_HEIGHT, "DOWN");
     
-    /* Gain sliders */
+    /* Gain sliders (ranges set by ui_layout_apply_caps) */
     widget_slider_init(&layout->slider_gain, 0, 0, SLIDER_WIDTH, SLIDER_HEIGHT,
                        GAIN_MIN, GAIN_MAX, true);
     layout->slider_gain.label = "IF Gain";
@@ -97,23 +89,24 @@ ui_layout_t* ui_layout_create(ui_core_t* ui)
     layout->slider_lna.label = "LNA";
     layout->slider_lna.value = 4;
     
-    /* Configuration combos */
-    widget_combo_init(&layout->combo_agc, 0, 0, 120, COMBO_HEIGHT,
-                      s_agc_items, ARRAY_SIZE(s_agc_items));
+    /* Configuration combos (items set by ui_layout_apply_caps) */
+    widget_combo_init(&layout->combo_agc, 0, 0, 120, COMBO_HEIGHT, NULL, 0);
     layout->combo_agc.label = "AGC Mode";
     
-    widget_combo_init(&layout->combo_srate, 0, 0, 120, COMBO_HEIGHT,
-                      s_srate_items, ARRAY_SIZE(s_srate_items));
+    widget_combo_init(&layout->combo_srate, 0, 0, 120, COMBO_HEIGHT, NULL, 0);
     layout->combo_srate.label = "Sample Rate";
     
-    widget_combo_init(&layout->combo_bw, 0, 0, 120, COMBO_HEIGHT,
-                      s_bw_items, ARRAY_SIZE(s_bw_items));
+    widget_combo_init(&layout->combo_bw, 0, 0, 120, COMBO_HEIGHT, NULL, 0);
     layout->combo_bw.label = "Bandwidth";
     
-    widget_combo_init(&layout->combo_antenna, 0, 0, 120, COMBO_HEIGHT,
-                      s_antenna_items, ARRAY_SIZE(s_antenna_items));
+    widget_combo_init(&layout->combo_antenna, 0, 0, 120, COMBO_HEIGHT, NULL, 0);
     layout->combo_antenna.label = "Antenna";
     
+    /* RSP2 until the server reports its capabilities */
+    sdr_capabilities_t caps;
+    sdr_caps_defaults(&caps);
+    ui_layout_apply_caps(layout, &caps);
+    
     /* Toggles */
     widget_toggle_init(&layout->toggle_biast, 0, 0, "Bias-T");
     widget_toggle_init(&layout->toggle_notch, 0, 0, "FM Notch");
@@ -124,6 +117,11 @@ ui_layout_t* ui_layout_create(ui_core_t* ui)
     widget_button_init(&layout->btn_aff_interval_inc, 0, 0, 20, 22, "+");
     layout->aff_interval_value = AFF_INTERVAL_60S;
     
+    /* AFF estimator mode button (label set at draw time) */
+    widget_button_init(&layout->btn_aff_mode, 0, 0, 134, 22, "Est: Step");
+    layout->aff_mode_value = AFF_MODE_STEP;
+    widget_button_init(&layout->btn_aff_export, 0, 0, 36, 18, "CSV");
+    
     /* WWV frequency shortcut buttons */
     widget_button_init(&layout->btn_wwv_2_5, 0, 0, 50, 24, "2.5");
     widget_button_init(&layout->btn_wwv_5, 0, 0, 40, 24, "5");
@@ -434,6 +432,75 @@ void ui_layout_recalculate(ui_layout_t* layout)
     layout->btn_aff_interval_inc.y = layout->btn_aff_interval_dec.y;
     layout->btn_aff_interval_inc.w = 20;
     layout->btn_aff_interval_inc.h = 22;
+    
+    layout->btn_aff_mode.x = layout->btn_aff_interval_dec.x;
+    layout->btn_aff_mode.y = layout->btn_aff_interval_dec.y + 28;
+    layout->btn_aff_mode.w = 134;
+    layout->btn_aff_mode.h = 22;
+    
+    /* AFF drift history plot (below the AFF toggle) */
+    layout->aff_plot = (SDL_Rect){270, 346, 136, 100};
+    layout->btn_aff_export.x = layout->aff_plot.x + layout->aff_plot.w - 36;
+    layout->btn_aff_export.y = layout->aff_plot.y - 22;
+    layout->btn_aff_export.w = 36;
+    layout->btn_aff_export.h = 18;
+}
+
+/*
+ * Apply SDR capabilities to control ranges and combo items
+ */
+void ui_layout_apply_caps(ui_layout_t* layout, const sdr_capabilities_t* caps)
+{
+    if (!layout || !caps) return;
+    
+    layout->caps = *caps;
+    const sdr_capabilities_t* c = &layout->caps;
+    
+    /* AGC modes (only those the controller can select) */
+    int n = 0;
+    for (int i = 0; i < c->agc_mode_count && n < (int)ARRAY_SIZE(layout->agc_items); i++) {
+        agc_mode_t mode = string_to_agc_mode(c->agc_modes[i]);
+        if (strcmp(agc_mode_to_string(mode), c->agc_modes[i]) == 0) {
+            layout->agc_items[n] = c->agc_modes[i];
+            layout->agc_values[n++] = mode;
+        }
+    }
+    if (n == 0) {
+        layout->agc_items[n] = agc_mode_to_string(AGC_OFF);
+        layout->agc_values[n++] = AGC_OFF;
+    }
+    combo_set_items(&layout->combo_agc, layout->agc_items, n);
+    
+    /* Sample rates */
+    for (int i = 0; i < c->srate_count; i++) {
+        snprintf(layout->srate_labels[i], sizeof(layout->srate_labels[i]),
+                 "%.1f MHz", c->srates[i] / 1e6);
+        layout->srate_items[i] = layout->srate_labels[i];
+    }
+    combo_set_items(&layout->combo_srate, layout->srate_items, c->srate_count);
+    
+    /* Bandwidths */
+    for (int i = 0; i < c->bandwidth_count; i++) {
+        snprintf(layout->bw_labels[i], sizeof(layout->bw_labels[i]),
+                 "%d kHz", c->bandwidths[i]);
+        layout->bw_items[i] = layout->bw_labels[i];
+    }
+    combo_set_items(&layout->combo_bw, layout->bw_items, c->bandwidth_count);
+    
+    /* Antenna ports (only those the controller can select) */
+    n = 0;
+    for (int i = 0; i < c->antenna_count && n < (int)ARRAY_SIZE(layout->antenna_items); i++) {
+        antenna_port_t port = string_to_antenna(c->antennas[i]);
+        if (strcmp(antenna_to_string(port), c->antennas[i]) == 0) {
+            layout->antenna_items[n] = s_antenna_labels[port];
+            layout->antenna_values[n++] = port;
+        }
+    }
+    if (n == 0) {
+        layout->antenna_items[n] = s_antenna_labels[ANTENNA_A];
+        layout->antenna_values[n++] = ANTENNA_A;
+    }
+    combo_set_items(&layout->combo_antenna, layout->antenna_items, n);
 }
 
 /*
@@ -450,18 +517,24 @@ void ui_layout_sync_state(ui_layout_t* layout, const app_state_t* state)
     layout->slider_gain.value = state->gain;
     layout->slider_lna.value = state->lna;
     
-    /* Update LNA slider max based on antenna (Hi-Z has reduced LNA states) */
-    if (state->antenna == ANTENNA_HIZ) {
-        layout->slider_lna.max_val = LNA_MAX_HIZ;
-    } else {
-        layout->slider_lna.max_val = LNA_MAX;
-    }
+    /* Slider ranges for the selected antenna (Hi-Z has reduced LNA states) */
+    sdr_caps_gain_range(&layout->caps, state->antenna,
+                        &layout->slider_gain.min_val, &layout->slider_gain.max_val);
+    layout->slider_lna.max_val = sdr_caps_lna_max(&layout->caps, state->antenna);
     
     /* Config combos */
-    layout->combo_agc.selected = (int)state->agc;
-    layout->combo_srate.selected = srate_to_index(state->sample_rate);
-    layout->combo_bw.selected = bw_to_index(state->bandwidth);
-    layout->combo_antenna.selected = (int)state->antenna;
+    layout->combo_agc.selected = 0;
+    for (int i = 0; i < layout->combo_agc.item_count; i++) {
+        if (layout->agc_values[i] == state->agc) layout->combo_agc.selected = i;
+    }
+    layout->combo_srate.selected = value_to_index(layout->caps.srates, layout->caps.srate_count,
+                                                  state->sample_rate);
+    layout->combo_bw.selected = value_to_index(layout->caps.bandwidths, layout->caps.bandwidth_count,
+                                               state->bandwidth);
+    layout->combo_antenna.selected = 0;
+    for (int i = 0; i < layout->combo_antenna.item_count; i++) {
+        if (layout->antenna_values[i] == state->antenna) layout->combo_antenna.selected = i;
+    }
     
     /* Toggles */
     layout->toggle_biast.value = state->bias_t;
@@ -489,7 +562,8 @@ void ui_layout_sync_state(ui_layout_t* layout, const app_state_t* state)
     layout->toggle_notch.enabled = true;
     
     /* Update connect button label */
-    layout->btn_connect.label = connected ? "Disconnect" : "Connect";
+    layout->btn_connect.label = connected ? "Disconnect" :
+                                (state->conn_state == CONN_CONNECTING) ? "Cancel" : "Connect";
 }
 
 /*
@@ -602,22 +676,22 @@ void ui_layout_update(ui_layout_t* layout, const mouse_state_t* mouse,
     /* Update combos */
     if (widget_combo_update(&layout->combo_agc, mouse)) {
         actions->agc_changed = true;
-        actions->new_agc = (agc_mode_t)layout->combo_agc.selected;
+        actions->new_agc = layout->agc_values[layout->combo_agc.selected];
     }
     
     if (widget_combo_update(&layout->combo_srate, mouse)) {
         actions->srate_changed = true;
-        actions->new_srate = s_srate_values[layout->combo_srate.selected];
+        actions->new_srate = layout->caps.srates[layout->combo_srate.selected];
     }
     
     if (widget_combo_update(&layout->combo_bw, mouse)) {
         actions->bw_changed = true;
-        actions->new_bw = s_bw_values[layout->combo_bw.selected];
+        actions->new_bw = layout->caps.bandwidths[layout->combo_bw.selected];
     }
     
     if (widget_combo_update(&layout->combo_antenna, mouse)) {
         actions->antenna_changed = true;
-        actions->new_antenna = (antenna_port_t)layout->combo_antenna.selected;
+        actions->new_antenna = layout->antenna_values[layout->combo_antenna.selected];
     }
     
     /* Update toggles */
@@ -644,6 +718,14 @@ void ui_layout_update(ui_layout_t* layout, const mouse_state_t* mouse,
         actions->aff_interval_inc = true;
     }
     
+    if (widget_button_update(&layout->btn_aff_mode, mouse)) {
+        actions->aff_mode_cycle = true;
+    }
+    
+    if (widget_button_update(&layout->btn_aff_export, mouse)) {
+        actions->aff_export = true;
+    }
+    
     /* Check for DC offset dot click */
     if (mouse->left_clicked) {
         if (mouse->x >= layout->offset_dot.x && 
@@ -850,6 +932,13 @@ void ui_layout_draw(ui_layout_t* layout, const app_state_t* state)
     widget_button_draw(&layout->btn_aff_interval_dec, layout->ui);
     widget_button_draw(&layout->btn_aff_interval_inc, layout->ui);
     
+    /* Draw AFF estimator mode button */
+    static const char* mode_labels[] = {"Est: Step", "Est: Kalman", "Est: Fast"};
+    int mode_idx = layout->aff_mode_value;
+    if (mode_idx < 0 || mode_idx >= AFF_MODE_COUNT) mode_idx = AFF_MODE_STEP;
+    layout->btn_aff_mode.label = mode_labels[mode_idx];
+    widget_button_draw(&layout->btn_aff_mode, layout->ui);
+    
     /* Draw telemetry panel (bottom left) */
     ui_layout_draw_telemetry_panel(layout);
     
@@ -915,12 +1004,13 @@ void ui_layout_draw_footer(ui_layout_t* layout, const app_state_t* state)
                     10, layout->regions.footer.y + 8, COLOR_TEXT);
         
         /* Draw connection info on right side */
-        if (state->conn_state == CONN_CONNECTED) {
+        if (state->conn_state == CONN_CONNECTED || state->conn_state == CONN_CONNECTING) {
             char conn_str[64];
             snprintf(conn_str, sizeof(conn_str), "%s:%d", state->server_host, state->server_port);
             ui_draw_text_right(layout->ui, layout->ui->font_small, conn_str,
                                0, layout->regions.footer.y + 8, 
-                               layout->regions.footer.w - 10, COLOR_GREEN);
+                               layout->regions.footer.w - 10,
+                               state->conn_state == CONN_CONNECTED ? COLOR_GREEN : COLOR_YELLOW);
         }
     }
 }
@@ -1209,6 +1299,18 @@ void ui_layout_draw_bcd_panel(ui_layout_t* layout, const bcd_decoder_t* bcd)
         } else {
             ui_draw_text(layout->ui, layout->ui->font_small, "Frame: [--/59]", x, y, COLOR_TEXT_DIM);
         }
+        
+        /* Phase search: offset of symbol-stream phase from modem's */
+        if (status.phase_search) {
+            if (!status.phase_locked) {
+                ui_draw_text(layout->ui, layout->ui->font_small, "Phase --", x + 180, y, COLOR_TEXT_DIM);
+            } else if (status.phase_offset != 0) {
+                snprintf(buf, sizeof(buf), "Phase %+ds", status.phase_offset);
+                ui_draw_text(layout->ui, layout->ui->font_small, buf, x + 180, y, COLOR_ORANGE);
+            } else {
+                ui_draw_text(layout->ui, layout->ui->font_small, "Phase OK", x + 180, y, COLOR_GREEN);
+            }
+        }
         y += line_h;
     }
     
@@ -1240,6 +1342,13 @@ void ui_layout_draw_bcd_panel(ui_layout_t* layout, const bcd_decoder_t* bcd)
             ui_draw_text(layout->ui, layout->ui->font_small, buf, x, y, COLOR_TEXT);
             y += line_h;
             
+            snprintf(buf, sizeof(buf), "Conf: %.0f%% (%d frame%s)",
+                     status.current_time.confidence * 100.0f,
+                     status.current_time.frames_integrated,
+                     status.current_time.frames_integrated == 1 ? "" : "s");
+            ui_draw_text(layout->ui, layout->ui->font_small, buf, x, y, COLOR_TEXT_DIM);
+            y += line_h;
+            
             if (status.current_time.dut1_sign != 0) {
                 snprintf(buf, sizeof(buf), "DUT1: %+.1f s", 
                          status.current_time.dut1_sign * status.current_time.dut1_value);
@@ -1261,10 +1370,40 @@ void ui_layout_draw_bcd_panel(ui_layout_t* layout, const bcd_decoder_t* bcd)
         ui_draw_text(layout->ui, layout->ui->font_small, buf, x, y, COLOR_TEXT_DIM);
         y += line_h;
         
-        snprintf(buf, sizeof(buf), "Symbols: %u", status.total_symbols);
+        const bcd_stats_summary_t *qs = &status.symbol_stats;
+        if (qs->symbols > 0) {
+            snprintf(buf, sizeof(buf), "Symbols: %u (err %.1f%%)", status.total_symbols,
+                     100.0f * qs->errors / qs->symbols);
+        } else {
+            snprintf(buf, sizeof(buf), "Symbols: %u", status.total_symbols);
+        }
         ui_draw_text(layout->ui, layout->ui->font_small, buf, x, y, COLOR_GREEN);
     }
     
+    /* === Per-position modem error heatmap (rows = tens of seconds) === */
+    {
+        const bcd_stats_summary_t *qs = &status.symbol_stats;
+        const int cell = 7;
+        int gx = layout->regions.bcd_panel.x + layout->regions.bcd_panel.w - 8 - 10 * (cell + 1);
+        int gy = layout->regions.bcd_panel.y + 22 + 2 * line_h;
+        
+        ui_draw_text(layout->ui, layout->ui->font_small, "Pos err", gx, gy, COLOR_TEXT_DIM);
+        gy += 14;
+        
+        for (int pos = 0; pos < BCD_STATS_POSITIONS; pos++) {
+            uint32_t color = COLOR_BG_DARK;     /* No decoded symbols here yet */
+            if (qs->position_symbols[pos] > 0) {
+                float rate = (float)qs->position_errors[pos] / qs->position_symbols[pos];
+                if (rate == 0.0f)      color = COLOR_GREEN;
+                else if (rate < 0.05f) color = COLOR_YELLOW;
+                else if (rate < 0.20f) color = COLOR_ORANGE;
+                else                   color = COLOR_RED;
+            }
+            ui_draw_rect(layout->ui, gx + (pos % 10) * (cell + 1), gy + (pos / 10) * (cell + 1),
+                         cell, cell, color);
+        }
+    }
+    
     /* Sync LED at bottom */
     layout->led_bcd_sync.on = (status.sync_state == BCD_SYNC_LOCKED);
     widget_led_draw(&layout->led_bcd_sync, layout->ui);
@@ -1656,6 +1795,101 @@ void ui_layout_draw_mark_panel(ui_layout_t* layout, const udp_telemetry_t* telem
     snprintf(buf, sizeof(buf), "Confidence: %s", mark->confidence);
     ui_draw_text(layout->ui, layout->ui->font_small, buf, x, y, conf_color);
 }
+
+/*
+ * Draw AFF drift history: oscillator offset relative to the starting
+ * tuning (corrections applied + residual drift), with a tick per
+ * correction (orange when it reverses the previous one)
+ */
+void ui_layout_draw_aff_panel(ui_layout_t* layout, aff_state_t* aff)
+{
+    if (!layout || !layout->ui) return;
+    
+    static aff_history_entry_t hist[AFF_HISTORY_SIZE];
+    SDL_Rect r = layout->aff_plot;
+    char buf[32];
+    
+    ui_draw_text(layout->ui, layout->ui->font_small, "AFF drift", r.x, r.y - 18, COLOR_TEXT);
+    widget_button_draw(&layout->btn_aff_export, layout->ui);
+    ui_draw_rect(layout->ui, r.x, r.y, r.w, r.h, COLOR_BG_DARK);
+    ui_draw_rect_outline(layout->ui, r.x, r.y, r.w, r.h, COLOR_BG_WIDGET);
+    
+    int n = aff ? aff_get_history(aff, hist, AFF_HISTORY_SIZE) : 0;
+    if (n < 2) {
+        ui_draw_text_centered(layout->ui, layout->ui->font_small, "No history",
+                              r.x, r.y + r.h / 2 - 6, r.w, COLOR_TEXT_DIM);
+        return;
+    }
+    
+    /* Vertical scale: data range, at least ±2 Hz */
+    float lo = 1e9f, hi = -1e9f;
+    for (int i = 0; i < n; i++) {
+        float v = hist[i].total_correction_hz + hist[i].drift_hz;
+        if (v < lo) lo = v;
+        if (v > hi) hi = v;
+    }
+    float center = 0.5f * (lo + hi);
+    float half = 0.5f * (hi - lo);
+    if (half < 2.0f) half = 2.0f;
+    half *= 1.1f;
+    lo = center - half;
+    hi = center + half;
+    
+    int plot_top = r.y + 2;
+    int plot_h = r.h - 12;              /* Bottom strip holds correction ticks */
+    int tick_y = r.y + r.h - 7;
+    int w = r.w - 2;
+    int last_marked = -1;
+    int prev_sign = 0;
+    
+    for (int c = 0; c < w; c++) {
+        int i0 = c * n / w;
+        int i1 = (c + 1) * n / w;
+        if (i1 <= i0) i1 = i0 + 1;
+    
+        float vmin = 1e9f, vmax = -1e9f;
+        bool unlocked = false;
+        int corr = 0;
+        bool reversed = false;
+        for (int i = i0; i < i1; i++) {
+            float v = hist[i].total_correction_hz + hist[i].drift_hz;
+            if (v < vmin) vmin = v;
+            if (v > vmax) vmax = v;
+            if (!hist[i].locked) unlocked = true;
+            if (i > last_marked && hist[i].correction_hz != 0) {
+                int sign = hist[i].correction_hz > 0 ? 1 : -1;
+                if (prev_sign != 0 && sign != prev_sign) reversed = true;
+                prev_sign = sign;
+                corr += hist[i].correction_hz;
+            }
+        }
+        if (i1 - 1 > last_marked) last_marked = i1 - 1;
+    
+        int px = r.x + 1 + c;
+        int y_top = plot_top + (int)((hi - vmax) / (hi - lo) * (plot_h - 1));
+        int y_bot = plot_top + (int)((hi - vmin) / (hi - lo) * (plot_h - 1));
+        ui_draw_line(layout->ui, px, y_top, px, y_bot, unlocked ? COLOR_TEXT_DIM : COLOR_ACCENT);
+    
+        if (corr != 0 || reversed) {
+            ui_draw_line(layout->ui, px, tick_y, px, tick_y + 5,
+                         reversed ? COLOR_ORANGE : COLOR_GREEN);
+        }
+    }
+    
+    /* Scale and span labels */
+    snprintf(buf, sizeof(buf), "%+.1f", hi);
+    ui_draw_text(layout->ui, layout->ui->font_small, buf, r.x + 3, r.y + 2, COLOR_TEXT_DIM);
+    snprintf(buf, sizeof(buf), "%+.1f", lo);
+    ui_draw_text(layout->ui, layout->ui->font_small, buf, r.x + 3, tick_y - 16, COLOR_TEXT_DIM);
+    
+    uint32_t span_s = (hist[n - 1].time_ms - hist[0].time_ms) / 1000;
+    if (span_s >= 3600) {
+        snprintf(buf, sizeof(buf), "%.1fh", span_s / 3600.0);
+    } else {
+        snprintf(buf, sizeof(buf), "%um", span_s / 60);
+    }
+    ui_draw_text_right(layout->ui, layout->ui->font_small, buf, r.x, tick_y - 16, r.w - 3, COLOR_TEXT_DIM);
+}
 /*
  * Draw Telemetry panel with tabs (bottom left)
  */
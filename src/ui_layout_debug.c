@@ -255,6 +255,68 @@ void ui_layout_draw_debug(ui_layout_t* layout)
         layout->led_overload.x + 10, layout->led_overload.y - 15, DEBUG_COLOR_LED);
 }
 
+/*
+ * Draw command round-trip table (debug mode only)
+ */
+void ui_layout_draw_latency(ui_layout_t* layout, const sdr_protocol_t* proto)
+{
+    if (!layout || !layout->ui || !layout->debug_mode || !proto) return;
+    
+    ui_core_t* ui = layout->ui;
+    static const char* headers[] = { "verb", "n", "p50", "p90", "p99", "max" };
+    static const int col_right[] = { 0, 100, 150, 200, 250, 300 };  /* Right edges (col 0 left) */
+    
+    /* Count verbs with samples to size the panel */
+    int rows = 0;
+    for (int v = 0; v < SDR_VERB_COUNT; v++) {
+        if (latency_hist_count(sdr_get_latency(proto, (sdr_verb_t)v)) > 0) rows++;
+    }
+    
+    int w = 316;
+    int h = 34 + (rows > 0 ? rows : 1) * 14;
+    int x = ui->window_width - w - 10;
+    int y = layout->regions.footer.y - h - 10;
+    
+    ui_draw_rect(ui, x, y, w, h, 0x000000DD);
+    ui_draw_rect_outline(ui, x, y, w, h, DEBUG_COLOR_REGION);
+    ui_draw_text(ui, ui->font_small, "Command RTT (ms)", x + 8, y + 4, COLOR_YELLOW);
+    
+    int row_y = y + 18;
+    for (int c = 0; c < (int)ARRAY_SIZE(headers); c++) {
+        if (c == 0) {
+            ui_draw_text(ui, ui->font_small, headers[c], x + 8, row_y, COLOR_TEXT_DIM);
+        } else {
+            ui_draw_text_right(ui, ui->font_small, headers[c], x, row_y,
+                               col_right[c] + 8, COLOR_TEXT_DIM);
+        }
+    }
+    
+    if (rows == 0) {
+        ui_draw_text(ui, ui->font_small, "no commands yet", x + 8, row_y + 14, COLOR_TEXT_DIM);
+        return;
+    }
+    
+    for (int v = 0; v < SDR_VERB_COUNT; v++) {
+        const latency_hist_t* hist = sdr_get_latency(proto, (sdr_verb_t)v);
+        uint32_t count = latency_hist_count(hist);
+        if (count == 0) continue;
+        row_y += 14;
+        
+        char cols[6][24];
+        snprintf(cols[0], sizeof(cols[0]), "%s", sdr_verb_name((sdr_verb_t)v));
+        snprintf(cols[1], sizeof(cols[1]), "%u", count);
+        snprintf(cols[2], sizeof(cols[2]), "%.1f", latency_hist_percentile(hist, 50.0) / 1000.0);
+        snprintf(cols[3], sizeof(cols[3]), "%.1f", latency_hist_percentile(hist, 90.0) / 1000.0);
+        snprintf(cols[4], sizeof(cols[4]), "%.1f", latency_hist_percentile(hist, 99.0) / 1000.0);
+        snprintf(cols[5], sizeof(cols[5]), "%.1f", latency_hist_max(hist) / 1000.0);
+        
+        ui_draw_text(ui, ui->font_small, cols[0], x + 8, row_y, COLOR_TEXT);
+        for (int c = 1; c < 6; c++) {
+            ui_draw_text_right(ui, ui->font_small, cols[c], x, row_y, col_right[c] + 8, COLOR_TEXT);
+        }
+    }
+}
+
 /*
  * Handle debug mode click - copy widget metadata to clipboard
  */
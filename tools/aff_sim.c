@@ -0,0 +1,410 @@
+/**
+ * Phoenix SDR Controller - AFF Closed-Loop Simulator
+ *
+ * Runs the real AFF module (src/aff.c) against a modelled receiver
+ * oscillator on a simulated clock, so estimator modes and intervals can be
+ * compared offline in seconds:
+ *   - oscillator: initial offset, linear drift, periodic temperature steps
+ *   - telemetry: SYNC delta_ms once per minute (mean oscillator offset over
+ *     the minute; the sample clock does not follow retunes) and CARR once per
+ *     second (mean offset left by the tuning), each with Gaussian noise
+ *   - the loop is driven the way src/main.c drives it (aff_update every
+ *     tick, aff_update_offset on each new packet, adjustments retune)
+ *
+ * For every mode x interval it reports the convergence time from the
+ * initial offset, RMS and maximum frequency error after convergence, the
+ * final error and the number of corrections applied. "Rpt" counts repeated
+ * corrections: a correction of the same size and sign as the one before it,
+ * applied while the true error was under half that size (the estimator
+ * corrected an offset it had already removed).
+ *
+ * --check runs a constant offset (no drift, no temperature steps, SYNC noise
+ * at most 0.0005 ms so one reading cannot cross the STEP threshold) in which
+ * every run must end within tolerance without a repeated correction, and
+ * exits with status 1 if any run fails, e.g.:
+ *   aff_sim --check --offset-hz 5
+ *   aff_sim --check --offset-hz 5 --mode fast --carr-valid 0   (SYNC fallback)
+ *
+ * Usage: aff_sim [options]
+ *   --mode M           step, kalman, fast or all (default all)
+ *   --interval N       Interval in seconds, or 0 for all (default 0)
+ *   --duration N       Simulated seconds (default 3600)
+ *   --offset-hz F      Initial offset in Hz (default 10.0)
+ *   --drift F          Drift in Hz per hour (default 2.0)
+ *   --temp-step F      Temperature step size in Hz (default 0.0)
+ *   --temp-period N    Seconds between steps, alternating sign (default 900)
+ *   --freq MHZ         Carrier frequency in MHz (default 10)
+ *   --snr DB           Reported SNR (default 10)
+ *   --sync-noise MS    SYNC delta_ms noise (default 1.0)
+ *   --carr-noise HZ    CARR offset noise (default 0.2)
+ *   --carr-valid P     Probability a CARR packet is valid (default 1.0)
+ *   --tol HZ           Convergence tolerance (default 1.0)
+ *   --tick MS          Main loop period (default 20)
+ *   --seed N           Random seed (default 1)
+ *   --csv FILE         Write the AFF drift history of the last run as CSV
+ *                      (combine with --mode and --interval)
+ *   --check            Constant-offset regression check (see above)
+ */
+
+#include "aff.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct {
+    int mode;                   /* aff_mode_t, or -1 for all */
+    int interval_sec;           /* 0 = all */
+    int duration;
+    double offset_hz;
+    double drift_hz_per_hour;
+    double temp_step_hz;
+    int temp_period_sec;
+    double freq_mhz;
+    double snr_db;
+    double sync_noise_ms;
+    double carr_noise_hz;
+    double carr_valid;
+    double tol_hz;
+    int tick_ms;
+    unsigned int seed;
+    const char* csv_file;
+    bool check;
+} sim_config_t;
+
+typedef struct {
+    double converge_sec;        /* < 0 if never within tolerance */
+    double rms_hz;              /* After convergence (whole run if never) */
+    double max_hz;
+    double final_hz;
+    int corrections;
+    int total_adjust_hz;
+    int repeats;                /* Same-size corrections of an offset already removed */
+} sim_result_t;
+
+static uint64_t s_rng_state = 1;
+
+/* xorshift64* - reproducible across platforms, unlike rand() */
+static double rng_uniform(void)
+{
+    s_rng_state ^= s_rng_state >> 12;
+    s_rng_state ^= s_rng_state << 25;
+    s_rng_state ^= s_rng_state >> 27;
+    return (double)((s_rng_state * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
+
+static double rng_gauss(void)
+{
+    double u1 = rng_uniform();
+    double u2 = rng_uniform();
+    if (u1 < 1e-12) u1 = 1e-12;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+/* Simulated clock handed to aff_set_clock() */
+static uint32_t sim_clock(void* userdata)
+{
+    return *(const uint32_t*)userdata;
+}
+
+/* True receiver offset (Hz, + = tune higher) at time t */
+static double oscillator_offset(const sim_config_t* cfg, double t)
+{
+    double off = cfg->offset_hz + cfg->drift_hz_per_hour * t / 3600.0;
+    if (cfg->temp_step_hz != 0.0 && cfg->temp_period_sec > 0) {
+        /* Alternating steps: +step, back to 0, +step, ... */
+        long steps = (long)(t / cfg->temp_period_sec);
+        if (steps & 1) off += cfg->temp_step_hz;
+    }
+    return off;
+}
+
+static void run_one(const sim_config_t* cfg, aff_mode_t mode, int interval_index,
+                    sim_result_t* res)
+{
+    memset(res, 0, sizeof(*res));
+    s_rng_state = 0x9E3779B97F4A7C15ULL ^ cfg->seed;
+
+    int64_t carrier_hz = (int64_t)(cfg->freq_mhz * 1e6 + 0.5);
+    uint32_t now_ms = 0;
+
+    aff_state_t* aff = aff_create();
+    if (!aff) {
+        res->converge_sec = -1.0;
+        return;
+    }
+    aff_set_clock(aff, sim_clock, &now_ms);
+    aff_set_mode(aff, mode);
+    aff_set_interval(aff, interval_index);
+    aff_set_enabled(aff, true);
+
+    double tuned_hz = 0.0;
+    double sec_sum = 0.0, min_sum = 0.0;
+    int sec_n = 0, min_n = 0;
+    int last_adjust_hz = 0;
+    float sync_delta_ms = 0.0f;
+    bool sync_valid = false;
+
+    /* Convergence bookkeeping (until the first temperature step) */
+    double settle_end = cfg->duration;
+    if (cfg->temp_step_hz != 0.0 && cfg->temp_period_sec > 0 &&
+        cfg->temp_period_sec < settle_end) {
+        settle_end = cfg->temp_period_sec;
+    }
+    double last_outside = 0.0;
+    bool ever_inside = false;
+
+    /* Error samples for RMS after convergence */
+    int total_ticks = (int)((double)cfg->duration * 1000.0 / cfg->tick_ms) + 1;
+    float* err_log = (float*)malloc(sizeof(float) * (size_t)total_ticks);
+    int err_n = 0;
+
+    for (int tick = 0; tick < total_ticks; tick++) {
+        now_ms = (uint32_t)tick * (uint32_t)cfg->tick_ms;
+        double t = now_ms / 1000.0;
+        double offset = oscillator_offset(cfg, t);
+        double err = offset - tuned_hz;
+
+        if (err_log) err_log[err_n++] = (float)err;
+        if (t < settle_end) {
+            if (fabs(err) >= cfg->tol_hz) {
+                last_outside = t;
+            } else {
+                ever_inside = true;
+            }
+        }
+
+        sec_sum += err;
+        sec_n++;
+        min_sum += offset;
+        min_n++;
+
+        /* Per-second CARR (mean offset over the second) */
+        if (now_ms % 1000 == 0 && now_ms > 0) {
+            double mean = sec_sum / sec_n;
+            sec_sum = 0.0;
+            sec_n = 0;
+            if (mode != AFF_MODE_STEP) {
+                if (rng_uniform() < cfg->carr_valid) {
+                    aff_update_offset(aff, AFF_SOURCE_CARRIER,
+                                      (float)(mean + rng_gauss() * cfg->carr_noise_hz),
+                                      (float)cfg->snr_db);
+                }
+            }
+        }
+
+        /* Per-minute SYNC: timing error of the sample clock over the minute */
+        if (now_ms % 60000 == 0 && now_ms > 0) {
+            double mean = min_sum / min_n;
+            min_sum = 0.0;
+            min_n = 0;
+            sync_delta_ms = (float)(mean / (double)carrier_hz * 60000.0 +
+                                    rng_gauss() * cfg->sync_noise_ms);
+            sync_valid = true;
+            if (mode != AFF_MODE_STEP) {
+                aff_update_offset(aff, AFF_SOURCE_SYNC, sync_delta_ms, (float)cfg->snr_db);
+            }
+        }
+
+        /* As in main.c: update every loop once SYNC is valid */
+        if (sync_valid || mode != AFF_MODE_STEP) {
+            aff_update(aff, sync_delta_ms, carrier_hz + (int64_t)tuned_hz, sync_valid);
+
+            int adjustment_hz = 0;
+            if (aff_get_adjustment(aff, &adjustment_hz)) {
+                if (adjustment_hz == last_adjust_hz &&
+                    fabs(err) < 0.5 * abs(adjustment_hz)) {
+                    res->repeats++;
+                }
+                last_adjust_hz = adjustment_hz;
+                tuned_hz += adjustment_hz;
+                res->corrections++;
+                res->total_adjust_hz += abs(adjustment_hz);
+            }
+        }
+    }
+
+    res->final_hz = oscillator_offset(cfg, cfg->duration) - tuned_hz;
+    res->converge_sec = ever_inside ? last_outside : -1.0;
+
+    /* RMS / max over the run after convergence */
+    int from = 0;
+    if (res->converge_sec >= 0.0) {
+        from = (int)(res->converge_sec * 1000.0 / cfg->tick_ms) + 1;
+    }
+    double sq = 0.0;
+    int n = 0;
+    for (int i = from; i < err_n; i++) {
+        double e = err_log[i];
+        sq += e * e;
+        if (fabs(e) > res->max_hz) res->max_hz = fabs(e);
+        n++;
+    }
+    res->rms_hz = n > 0 ? sqrt(sq / n) : 0.0;
+
+    free(err_log);
+    if (cfg->csv_file) {
+        aff_export_history_csv(aff, cfg->csv_file);
+    }
+    aff_destroy(aff);
+}
+
+static void print_usage(const char *prog)
+{
+    printf("Usage: %s [--mode step|kalman|fast|all] [--interval SEC] [--duration SEC]\n"
+           "          [--offset-hz F] [--drift HZ_PER_HOUR] [--temp-step HZ] [--temp-period SEC]\n"
+           "          [--freq MHZ] [--snr DB] [--sync-noise MS] [--carr-noise HZ]\n"
+           "          [--carr-valid P] [--tol HZ] [--tick MS] [--seed N] [--csv FILE]\n"
+           "          [--check]\n", prog);
+}
+
+static bool parse_args(int argc, char *argv[], sim_config_t *cfg)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            return false;
+        }
+        if (strcmp(arg, "--check") == 0) {
+            cfg->check = true;
+            continue;
+        }
+        if (!val) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        }
+        i++;
+
+        if (strcmp(arg, "--mode") == 0) {
+            if (strcmp(val, "all") == 0) {
+                cfg->mode = -1;
+            } else if (strcmp(val, "step") == 0) {
+                cfg->mode = AFF_MODE_STEP;
+            } else if (strcmp(val, "kalman") == 0) {
+                cfg->mode = AFF_MODE_KALMAN;
+            } else if (strcmp(val, "fast") == 0) {
+                cfg->mode = AFF_MODE_FAST;
+            } else {
+                fprintf(stderr, "Unknown mode: %s\n", val);
+                return false;
+            }
+        } else if (strcmp(arg, "--interval") == 0) {
+            cfg->interval_sec = atoi(val);
+        } else if (strcmp(arg, "--duration") == 0) {
+            cfg->duration = atoi(val);
+        } else if (strcmp(arg, "--offset-hz") == 0) {
+            cfg->offset_hz = atof(val);
+        } else if (strcmp(arg, "--drift") == 0) {
+            cfg->drift_hz_per_hour = atof(val);
+        } else if (strcmp(arg, "--temp-step") == 0) {
+            cfg->temp_step_hz = atof(val);
+        } else if (strcmp(arg, "--temp-period") == 0) {
+            cfg->temp_period_sec = atoi(val);
+        } else if (strcmp(arg, "--freq") == 0) {
+            cfg->freq_mhz = atof(val);
+        } else if (strcmp(arg, "--snr") == 0) {
+            cfg->snr_db = atof(val);
+        } else if (strcmp(arg, "--sync-noise") == 0) {
+            cfg->sync_noise_ms = atof(val);
+        } else if (strcmp(arg, "--carr-noise") == 0) {
+            cfg->carr_noise_hz = atof(val);
+        } else if (strcmp(arg, "--carr-valid") == 0) {
+            cfg->carr_valid = atof(val);
+        } else if (strcmp(arg, "--tol") == 0) {
+            cfg->tol_hz = atof(val);
+        } else if (strcmp(arg, "--tick") == 0) {
+            cfg->tick_ms = atoi(val);
+        } else if (strcmp(arg, "--seed") == 0) {
+            cfg->seed = (unsigned int)strtoul(val, NULL, 10);
+        } else if (strcmp(arg, "--csv") == 0) {
+            cfg->csv_file = val;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return false;
+        }
+    }
+
+    if (cfg->duration <= 0) cfg->duration = 3600;
+    if (cfg->freq_mhz <= 0.0) cfg->freq_mhz = 10.0;
+    if (cfg->tick_ms <= 0 || 1000 % cfg->tick_ms != 0) cfg->tick_ms = 20;
+    if (cfg->tol_hz <= 0.0) cfg->tol_hz = 1.0;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    sim_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.mode = -1;
+    cfg.duration = 3600;
+    cfg.offset_hz = 10.0;
+    cfg.drift_hz_per_hour = 2.0;
+    cfg.temp_period_sec = 900;
+    cfg.freq_mhz = 10.0;
+    cfg.snr_db = 10.0;
+    cfg.sync_noise_ms = 1.0;
+    cfg.carr_noise_hz = 0.2;
+    cfg.carr_valid = 1.0;
+    cfg.tol_hz = 1.0;
+    cfg.tick_ms = 20;
+    cfg.seed = 1;
+
+    if (!parse_args(argc, argv, &cfg)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (cfg.check) {
+        cfg.drift_hz_per_hour = 0.0;
+        cfg.temp_step_hz = 0.0;
+        if (cfg.sync_noise_ms > 0.0005) cfg.sync_noise_ms = 0.0005;
+    }
+
+    printf("AFF simulator: %.2f MHz, offset %+.2f Hz, drift %+.2f Hz/h, temp step %.2f Hz / %d s\n",
+           cfg.freq_mhz, cfg.offset_hz, cfg.drift_hz_per_hour, cfg.temp_step_hz, cfg.temp_period_sec);
+    printf("SYNC noise %.2f ms, CARR noise %.2f Hz (valid %.0f%%), SNR %.1f dB, %d s\n\n",
+           cfg.sync_noise_ms, cfg.carr_noise_hz, cfg.carr_valid * 100.0,
+           cfg.snr_db, cfg.duration);
+    printf("%-7s %-9s %10s %9s %9s %9s %6s %8s %4s\n",
+           "Mode", "Interval", "Converge", "RMS Hz", "Max Hz", "Final Hz", "Corr", "Sum |Hz|", "Rpt");
+
+    int failed = 0;
+
+    for (int m = 0; m < AFF_MODE_COUNT; m++) {
+        if (cfg.mode >= 0 && m != cfg.mode) continue;
+
+        for (int idx = 0; idx < AFF_INTERVAL_COUNT; idx++) {
+            if (cfg.interval_sec > 0 && aff_interval_seconds(idx) != cfg.interval_sec) continue;
+
+            sim_result_t res;
+            run_one(&cfg, (aff_mode_t)m, idx, &res);
+
+            char conv[16];
+            if (res.converge_sec >= 0.0) {
+                snprintf(conv, sizeof(conv), "%.0f s", res.converge_sec);
+            } else {
+                snprintf(conv, sizeof(conv), "never");
+            }
+            printf("%-7s %-9s %10s %9.3f %9.3f %+9.3f %6d %8d %4d\n",
+                   aff_mode_string((aff_mode_t)m), aff_interval_string(idx), conv,
+                   res.rms_hz, res.max_hz, res.final_hz, res.corrections, res.total_adjust_hz,
+                   res.repeats);
+
+            if (res.repeats > 0 || res.converge_sec < 0.0 || fabs(res.final_hz) >= cfg.tol_hz) {
+                failed++;
+            }
+        }
+    }
+
+    if (cfg.check) {
+        printf("\n%s (%d run%s failed)\n", failed ? "CHECK FAILED" : "CHECK PASSED",
+               failed, failed == 1 ? "" : "s");
+        return failed ? 1 : 0;
+    }
+    return 0;
+}
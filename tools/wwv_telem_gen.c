@@ -0,0 +1,576 @@
+/**
+ * Phoenix SDR Controller - Synthetic WWV Telemetry Generator
+ *
+ * Emits UDP telemetry in the format documented in docs/UDP_TELEMETRY_PROTO.md,
+ * driven by a modelled WWV minute:
+ *   - one BCD symbol per second, sent at the end of its pulse, with correct
+ *     time code frames per minute (same field layout bcd_decoder.c expects)
+ *   - TICK/CORR every second, MARK/SYNC at the minute marker
+ *   - CHAN/CARR/T500/T600/SUBC following the WWV tone schedule
+ *   - sinusoidal SNR fades, symbol errors and dropped symbols
+ *   - optional filler traffic to reach a target packet rate
+ *
+ * Used to load-test udp_telemetry_poll() (watch packets_received and
+ * parse_errors in the controller) and to soak-test the BCD decoder.
+ *
+ * Usage: wwv_telem_gen [options]
+ *   --host ADDR        Destination address (default 127.0.0.1)
+ *   --port N           Destination port (default 3005)
+ *   --rate N           Target packets per wall second incl. filler (default 0 = natural)
+ *   --speed X          Simulated seconds per wall second (default 1.0)
+ *   --duration N       Stop after N simulated seconds (default 0 = forever)
+ *   --snr DB           Mean SNR in dB (default 20)
+ *   --fade-depth DB    Peak-to-peak fade depth in dB (default 0)
+ *   --fade-period N    Fade period in seconds (default 300)
+ *   --sym-err P        Base symbol error probability (default 0.0)
+ *   --sym-drop P       Symbol drop probability (default 0.0)
+ *   --offset-hz F      Receiver carrier offset in Hz (default 0.0)
+ *   --freq MHZ         Tuned WWV frequency in MHz (default 10)
+ *   --start HH:MM      Simulated UTC start time (default current UTC)
+ *   --seed N           Random seed (default 1)
+ */
+
+#include "udp_telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Nominal pulse widths for WWV BCD symbols */
+#define SYM_WIDTH_ZERO_MS    200.0f
+#define SYM_WIDTH_ONE_MS     500.0f
+#define SYM_WIDTH_MARKER_MS  800.0f
+
+/* Pacing slices per simulated second */
+#define PACE_SLICES 20
+
+typedef struct {
+    char host[64];
+    int port;
+    int rate;
+    double speed;
+    int duration;
+    double snr_db;
+    double fade_depth_db;
+    double fade_period_sec;
+    double sym_err;
+    double sym_drop;
+    double offset_hz;
+    double freq_mhz;
+    int start_hour;
+    int start_minute;
+    unsigned int seed;
+} gen_config_t;
+
+typedef struct {
+    uint64_t sent;
+    uint64_t send_errors;
+    uint64_t filler;
+    uint64_t symbols;
+    uint64_t symbol_errors;
+    uint64_t symbols_dropped;
+    uint64_t frames;
+} gen_stats_t;
+
+static volatile sig_atomic_t s_running = 1;
+static uint64_t s_rng_state = 1;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    s_running = 0;
+}
+
+/* xorshift64* - reproducible across platforms, unlike rand() */
+static double rng_uniform(void)
+{
+    s_rng_state ^= s_rng_state >> 12;
+    s_rng_state ^= s_rng_state << 25;
+    s_rng_state ^= s_rng_state >> 27;
+    return (double)((s_rng_state * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
+
+static double rng_gauss(void)
+{
+    double u1 = rng_uniform();
+    double u2 = rng_uniform();
+    if (u1 < 1e-12) u1 = 1e-12;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+/* Helper: sleep for milliseconds */
+static void sleep_ms(uint32_t ms)
+{
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+#endif
+}
+
+/* Helper: monotonic wall clock in ms */
+static double wall_ms(void)
+{
+#ifdef _WIN32
+    return (double)GetTickCount();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+/*
+ * Build the 60-symbol BCD frame for a given UTC minute.
+ * Field layout matches decode_frame() in src/bdc/bcd_decoder.c.
+ */
+static void encode_bcd_field(char *frame, int start, const int *weights,
+                             int count, int value)
+{
+    for (int i = 0; i < count; i++) {
+        if (weights[i] != 0 && value >= weights[i]) {
+            frame[start + i] = '1';
+            value -= weights[i];
+        } else {
+            frame[start + i] = '0';
+        }
+    }
+}
+
+static void build_bcd_frame(char *frame, int minute, int hour, int doy, int year)
+{
+    static const int p_positions[] = {0, 9, 19, 29, 39, 49, 59};
+    static const int min_weights[] = {40, 20, 10, 0, 8, 4, 2, 1};
+    static const int hour_weights[] = {20, 10, 0, 8, 4, 2, 1};
+    static const int doy_ht_weights[] = {200, 100, 0, 80, 40, 20, 10};
+    static const int doy_u_weights[] = {8, 4, 2, 1};
+    static const int year_weights[] = {80, 40, 20, 10, 8, 4, 2, 1};
+
+    memset(frame, '0', 60);
+
+    encode_bcd_field(frame, 1, min_weights, 8, minute);
+    encode_bcd_field(frame, 12, hour_weights, 7, hour);
+    encode_bcd_field(frame, 22, doy_ht_weights, 7, doy - (doy % 10));
+    encode_bcd_field(frame, 30, doy_u_weights, 4, doy % 10);
+    encode_bcd_field(frame, 51, year_weights, 8, year % 100);
+
+    /* DUT1 +0.1 s */
+    frame[36] = '1';
+    frame[43] = '1';
+
+    for (int i = 0; i < (int)ARRAY_SIZE(p_positions); i++) {
+        frame[p_positions[i]] = 'P';
+    }
+}
+
+static float nominal_width(char sym)
+{
+    switch (sym) {
+        case '1': return SYM_WIDTH_ONE_MS;
+        case 'P': return SYM_WIDTH_MARKER_MS;
+        default:  return SYM_WIDTH_ZERO_MS;
+    }
+}
+
+static const char *quality_for_snr(double snr)
+{
+    if (snr > 15.0) return "GOOD";
+    if (snr > 8.0) return "FAIR";
+    if (snr > 3.0) return "POOR";
+    return "NONE";
+}
+
+/*
+ * Packet sink: destination socket plus counters
+ */
+typedef struct {
+    socket_t sock;
+    struct sockaddr_in dest;
+    gen_stats_t *stats;
+    char pending_sym[64];       /* BCDS,SYM held until the pulse ends */
+    int pending_slice;          /* Pacing slice to send it in, -1 = none */
+} gen_sink_t;
+
+static void gen_send(gen_sink_t *sink, const char *fmt, ...)
+{
+    char buf[TELEMETRY_MAX_PACKET];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(buf, sizeof(buf) - 1, fmt, args);
+    va_end(args);
+    if (len < 0) return;
+    if (len > (int)sizeof(buf) - 2) len = (int)sizeof(buf) - 2;
+    buf[len++] = '\n';
+
+    int rc = sendto(sink->sock, buf, len, 0,
+                    (struct sockaddr*)&sink->dest, sizeof(sink->dest));
+    if (rc < 0) {
+        sink->stats->send_errors++;
+    } else {
+        sink->stats->sent++;
+    }
+}
+
+/*
+ * Emit all packets for one simulated second
+ */
+static void emit_second(gen_sink_t *sink, const gen_config_t *cfg,
+                        const char *frame, long sim_sec, int second,
+                        int minute, int hour, double snr)
+{
+    char hms[16];
+    snprintf(hms, sizeof(hms), "%02d:%02d:%02d", hour, minute, second);
+    double ts_ms = sim_sec * 1000.0;
+    double carrier_hz = cfg->freq_mhz * 1e6;
+    double noise_db = -60.0 + rng_gauss() * 0.5;
+    double carrier_db = noise_db + snr;
+
+    /* Tick / correlation chain (no tick at seconds 29 and 59 on WWV) */
+    if (second != 29 && second != 59) {
+        double interval = 1000.0 + rng_gauss() * 0.3;
+        gen_send(sink, "TICK,%s,%.1f,%ld,%s,%.6f,%.1f,%.1f,%.1f,%.4f,%.1f,%.2f",
+                 hms, ts_ms, sim_sec, second == 0 ? "MARKER" : "TICK",
+                 0.045 * pow(10.0, (snr - 20.0) / 20.0), 5.0 + rng_gauss() * 0.2,
+                 interval, 1000.0, 0.0011, snr * 0.65, snr > 6.0 ? 0.9 : 0.4);
+        gen_send(sink, "CORR,%s,%.1f,%ld,%s,%.6f,%.1f,%.1f,%.1f,%.4f,%.1f,%.2f,%d,%d,%.0f,%.1f",
+                 hms, ts_ms, sim_sec, "TICK",
+                 0.042 * pow(10.0, (snr - 20.0) / 20.0), 5.1, interval, 1000.0,
+                 0.0012, snr * 0.65, snr > 6.0 ? 0.91 : 0.4,
+                 1, second + 1, ts_ms - second * 1000.0,
+                 cfg->offset_hz / carrier_hz * 1e6 * (second / 1000.0));
+    }
+
+    /* BCD symbol for this second: width jitter grows as SNR drops, and the
+     * modem labels by nearest nominal width with confidence from the
+     * distance to the decision boundary. --sym-err adds random mislabels. */
+    char sym = frame[second];
+    if (rng_uniform() < cfg->sym_drop) {
+        sink->stats->symbols_dropped++;
+    } else {
+        double sigma = 15.0 + 150.0 * pow(10.0, -snr / 20.0);
+        float width = nominal_width(sym) + (float)(rng_gauss() * sigma);
+        char label = (width < 350.0f) ? '0' : (width < 650.0f) ? '1' : 'P';
+        float dist = fabsf(width - 350.0f);
+        if (fabsf(width - 650.0f) < dist) dist = fabsf(width - 650.0f);
+        float conf = (float)CLAMP(0.5 + 0.5 * dist / 150.0, 0.05, 0.99);
+
+        if (rng_uniform() < cfg->sym_err) {
+            static const char alphabet[] = "01P";
+            char wrong = alphabet[(int)(rng_uniform() * 3.0) % 3];
+            if (wrong == label) wrong = (label == '0') ? '1' : '0';
+            label = wrong;
+            conf *= 0.5f;
+        }
+        if (label != sym) sink->stats->symbol_errors++;
+        sink->stats->symbols++;
+
+        /* The modem reports a symbol once its pulse has ended */
+        snprintf(sink->pending_sym, sizeof(sink->pending_sym),
+                 "BCDS,SYM,%c,%d,%.1f,%.2f", label, second, width, conf);
+        sink->pending_slice = (int)CLAMP(width / (1000.0f / PACE_SLICES), 0, PACE_SLICES - 1);
+    }
+    gen_send(sink, "BCDS,STATUS,%s,%.1f,DECODE,%d,0,%d,%lu",
+             hms, ts_ms, second, second == 0 ? 1 : 0,
+             (unsigned long)sink->stats->symbols);
+
+    /* Channel quality and frequency trackers */
+    wwv_tone_t tone = wwv_get_tone(minute);
+    double sub500 = (tone == TONE_500HZ) ? carrier_db - 8.0 : noise_db + 2.0;
+    double sub600 = (tone == TONE_600HZ) ? carrier_db - 8.0 : noise_db + 2.0;
+    gen_send(sink, "CHAN,%s,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%s",
+             hms, ts_ms, carrier_db, snr, sub500, sub600, carrier_db - 6.0,
+             noise_db, quality_for_snr(snr));
+
+    double jitter = 0.5 / pow(10.0, snr / 20.0);
+    double off = cfg->offset_hz + rng_gauss() * jitter;
+    gen_send(sink, "CARR,%s,%.1f,%.3f,%.3f,%.3f,%.1f,%s",
+             hms, ts_ms, off, off, off / carrier_hz * 1e6, snr + 15.0,
+             snr > 3.0 ? "YES" : "NO");
+    if (tone == TONE_500HZ) {
+        double t = cfg->offset_hz * 500.0 / carrier_hz + rng_gauss() * jitter;
+        gen_send(sink, "T500,%s,%.1f,%.3f,%.3f,%.2f,%.1f", hms, ts_ms,
+                 500.0 + t, t, t / 500.0 * 1e6, snr + 2.0);
+    } else if (tone == TONE_600HZ) {
+        double t = cfg->offset_hz * 600.0 / carrier_hz + rng_gauss() * jitter;
+        gen_send(sink, "T600,%s,%.1f,%.3f,%.3f,%.2f,%.1f", hms, ts_ms,
+                 600.0 + t, t, t / 600.0 * 1e6, snr + 2.0);
+    }
+
+    const char *expected = (tone == TONE_500HZ) ? "500Hz" :
+                           (tone == TONE_600HZ) ? "600Hz" : "NONE";
+    gen_send(sink, "SUBC,%s,%.1f,%d,%s,%.1f,%.1f,%.1f,%s,%s",
+             hms, ts_ms, minute, expected, sub500, sub600, sub500 - sub600,
+             expected, "YES");
+
+    /* Minute marker and sync confirmation */
+    if (second == 0) {
+        long marker_num = sim_sec / 60;
+        double delta_ms = cfg->offset_hz / carrier_hz * 60000.0 +
+                          rng_gauss() * 2.0;
+        const char *state = marker_num == 0 ? "ACQUIRING" :
+                            marker_num == 1 ? "TENTATIVE" : "LOCKED";
+        if (marker_num == 1) {
+            gen_send(sink, "STATE,ACQUIRING,TENTATIVE,0.60");
+        } else if (marker_num == 2) {
+            gen_send(sink, "STATE,TENTATIVE,LOCKED,0.95");
+        }
+        gen_send(sink, "MARK,%s,%.1f,%ld,%.1f,%.4f,%.1f,%s",
+                 hms, ts_ms, marker_num, SYM_WIDTH_MARKER_MS + rng_gauss() * 10.0,
+                 0.045, snr, snr > 15.0 ? "HIGH" : snr > 8.0 ? "MED" : "LOW");
+        gen_send(sink, "SYNC,%s,%.1f,%ld,%s,%ld,60.0,%.1f,5.1,%.1f,%.1f",
+                 hms, ts_ms, marker_num, state, marker_num,
+                 delta_ms, SYM_WIDTH_MARKER_MS, ts_ms);
+    }
+}
+
+static void print_usage(const char *prog)
+{
+    printf("Usage: %s [--host ADDR] [--port N] [--rate PPS] [--speed X]\n"
+           "          [--duration SEC] [--snr DB] [--fade-depth DB] [--fade-period SEC]\n"
+           "          [--sym-err P] [--sym-drop P] [--offset-hz F] [--freq MHZ]\n"
+           "          [--start HH:MM] [--seed N]\n"
+           "  PPS: packets per wall second incl. filler; X: simulated seconds per wall second\n", prog);
+}
+
+static bool parse_args(int argc, char *argv[], gen_config_t *cfg)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            return false;
+        }
+        if (!val) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        }
+        i++;
+
+        if (strcmp(arg, "--host") == 0) {
+            strncpy(cfg->host, val, sizeof(cfg->host) - 1);
+        } else if (strcmp(arg, "--port") == 0) {
+            cfg->port = atoi(val);
+        } else if (strcmp(arg, "--rate") == 0) {
+            cfg->rate = atoi(val);
+        } else if (strcmp(arg, "--speed") == 0) {
+            cfg->speed = atof(val);
+        } else if (strcmp(arg, "--duration") == 0) {
+            cfg->duration = atoi(val);
+        } else if (strcmp(arg, "--snr") == 0) {
+            cfg->snr_db = atof(val);
+        } else if (strcmp(arg, "--fade-depth") == 0) {
+            cfg->fade_depth_db = atof(val);
+        } else if (strcmp(arg, "--fade-period") == 0) {
+            cfg->fade_period_sec = atof(val);
+        } else if (strcmp(arg, "--sym-err") == 0) {
+            cfg->sym_err = atof(val);
+        } else if (strcmp(arg, "--sym-drop") == 0) {
+            cfg->sym_drop = atof(val);
+        } else if (strcmp(arg, "--offset-hz") == 0) {
+            cfg->offset_hz = atof(val);
+        } else if (strcmp(arg, "--freq") == 0) {
+            cfg->freq_mhz = atof(val);
+        } else if (strcmp(arg, "--start") == 0) {
+            if (sscanf(val, "%d:%d", &cfg->start_hour, &cfg->start_minute) != 2) {
+                fprintf(stderr, "Invalid --start value: %s\n", val);
+                return false;
+            }
+        } else if (strcmp(arg, "--seed") == 0) {
+            cfg->seed = (unsigned int)strtoul(val, NULL, 10);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return false;
+        }
+    }
+
+    if (cfg->speed <= 0.0) cfg->speed = 1.0;
+    if (cfg->fade_period_sec <= 0.0) cfg->fade_period_sec = 300.0;
+    if (cfg->freq_mhz <= 0.0) cfg->freq_mhz = 10.0;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    gen_config_t cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    strcpy(cfg.host, "127.0.0.1");
+    cfg.port = TELEMETRY_UDP_PORT;
+    cfg.speed = 1.0;
+    cfg.snr_db = 20.0;
+    cfg.fade_period_sec = 300.0;
+    cfg.freq_mhz = 10.0;
+    cfg.start_hour = -1;
+    cfg.seed = 1;
+
+    if (!parse_args(argc, argv, &cfg)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    s_rng_state = 0x9E3779B97F4A7C15ULL ^ cfg.seed;
+
+    /* Simulated UTC start, always at a minute boundary */
+    time_t now = time(NULL);
+    struct tm utc = *gmtime(&now);
+    if (cfg.start_hour >= 0) {
+        utc.tm_hour = cfg.start_hour;
+        utc.tm_min = cfg.start_minute;
+    }
+    int doy = utc.tm_yday + 1;
+    int year = utc.tm_year + 1900;
+    int hour = utc.tm_hour;
+    int minute = utc.tm_min;
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        fprintf(stderr, "WSAStartup failed\n");
+        return 1;
+    }
+#endif
+
+    gen_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+
+    gen_sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.stats = &stats;
+    sink.pending_slice = -1;
+    sink.sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sink.sock == INVALID_SOCK) {
+        fprintf(stderr, "Failed to create UDP socket: %d\n", SOCKET_ERROR_CODE);
+        return 1;
+    }
+    sink.dest.sin_family = AF_INET;
+    sink.dest.sin_port = htons((u_short)cfg.port);
+    if (inet_pton(AF_INET, cfg.host, &sink.dest.sin_addr) != 1) {
+        fprintf(stderr, "Invalid host address: %s\n", cfg.host);
+        CLOSE_SOCKET(sink.sock);
+        return 1;
+    }
+
+    signal(SIGINT, on_signal);
+
+    printf("WWV telemetry generator -> %s:%d, %.2f MHz, start %02d:%02d UTC day %d\n",
+           cfg.host, cfg.port, cfg.freq_mhz, hour, minute, doy);
+    printf("SNR %.1f dB (fade %.1f dB / %.0f s), sym-err %.3f, sym-drop %.3f, rate %d pps, speed %.1fx\n",
+           cfg.snr_db, cfg.fade_depth_db, cfg.fade_period_sec, cfg.sym_err,
+           cfg.sym_drop, cfg.rate, cfg.speed);
+
+    char frame[60];
+    build_bcd_frame(frame, minute, hour, doy, year);
+
+    double start_wall = wall_ms();
+    double sec_wall_ms = 1000.0 / cfg.speed;
+    double filler_credit = 0.0;
+    uint64_t last_report_sent = 0;
+    double last_report_wall = start_wall;
+
+    for (long sim_sec = 0; s_running; sim_sec++) {
+        if (cfg.duration > 0 && sim_sec >= cfg.duration) break;
+
+        int second = (int)(sim_sec % 60);
+        if (second == 0 && sim_sec > 0) {
+            /* Advance the modelled clock one minute, with rollover */
+            if (++minute >= 60) {
+                minute = 0;
+                if (++hour >= 24) {
+                    hour = 0;
+                    int days = ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0) ? 366 : 365;
+                    if (++doy > days) {
+                        doy = 1;
+                        year++;
+                    }
+                }
+            }
+            build_bcd_frame(frame, minute, hour, doy, year);
+            stats.frames++;
+        }
+
+        double fade = 0.5 - 0.5 * cos(2.0 * M_PI * sim_sec / cfg.fade_period_sec);
+        double snr = cfg.snr_db - cfg.fade_depth_db * fade + rng_gauss() * 0.7;
+
+        uint64_t sent_before = stats.sent + stats.send_errors;
+        emit_second(&sink, &cfg, frame, sim_sec, second, minute, hour, snr);
+        int natural = (int)(stats.sent + stats.send_errors - sent_before);
+
+        /* Spread filler CHAN packets across the second to reach --rate; a
+         * simulated second lasts 1/speed wall seconds, carry the fraction */
+        filler_credit += cfg.rate / cfg.speed - natural;
+        int filler = 0;
+        if (filler_credit >= 1.0) {
+            filler = (int)filler_credit;
+            filler_credit -= filler;
+        } else if (filler_credit < 0.0) {
+            filler_credit = 0.0;
+        }
+        double sec_start = start_wall + sim_sec * sec_wall_ms;
+        for (int slice = 0; slice < PACE_SLICES && s_running; slice++) {
+            int n = filler / PACE_SLICES + (slice < filler % PACE_SLICES ? 1 : 0);
+            for (int k = 0; k < n; k++) {
+                gen_send(&sink, "CHAN,%02d:%02d:%02d,%.1f,%.1f,%.1f,-70.0,-70.0,-66.0,-60.0,%s",
+                         hour, minute, second, sim_sec * 1000.0 + slice * (1000.0 / PACE_SLICES),
+                         -60.0 + snr, snr, quality_for_snr(snr));
+            }
+            stats.filler += n;
+
+            if (sink.pending_slice >= 0 && slice >= sink.pending_slice) {
+                gen_send(&sink, "%s", sink.pending_sym);
+                sink.pending_slice = -1;
+            }
+
+            double deadline = sec_start + (slice + 1) * (sec_wall_ms / PACE_SLICES);
+            double wait = deadline - wall_ms();
+            if (wait >= 1.0) sleep_ms((uint32_t)wait);
+        }
+
+        double now_wall = wall_ms();
+        if (now_wall - last_report_wall >= 10000.0) {
+            double pps = (stats.sent - last_report_sent) * 1000.0 / (now_wall - last_report_wall);
+            printf("[%02d:%02d:%02d] sent %llu (%.0f pps), errors %llu, symbols %llu (%llu wrong, %llu dropped)\n",
+                   hour, minute, second, (unsigned long long)stats.sent, pps,
+                   (unsigned long long)stats.send_errors,
+                   (unsigned long long)stats.symbols,
+                   (unsigned long long)stats.symbol_errors,
+                   (unsigned long long)stats.symbols_dropped);
+            fflush(stdout);
+            last_report_sent = stats.sent;
+            last_report_wall = now_wall;
+        }
+    }
+
+    double elapsed = (wall_ms() - start_wall) / 1000.0;
+    printf("Done: %llu packets in %.1f s (%.0f pps avg), %llu filler, %llu send errors\n",
+           (unsigned long long)stats.sent, elapsed,
+           elapsed > 0 ? stats.sent / elapsed : 0.0,
+           (unsigned long long)stats.filler, (unsigned long long)stats.send_errors);
+    printf("      %llu frames, %llu symbols, %llu wrong, %llu dropped\n",
+           (unsigned long long)stats.frames, (unsigned long long)stats.symbols,
+           (unsigned long long)stats.symbol_errors,
+           (unsigned long long)stats.symbols_dropped);
+
+    CLOSE_SOCKET(sink.sock);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+    return 0;
+}